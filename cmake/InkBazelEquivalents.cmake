@@ -60,3 +60,29 @@ function(ink_cc_test)
     add_test(NAME ${_NAME} COMMAND ${_NAME})
   endif()
 endfunction()
+
+function(ink_cc_benchmark)
+  if(INK_STROKE_MODELER_BUILD_TESTING AND INK_STROKE_MODELER_BUILD_BENCHMARKS)
+    cmake_parse_arguments(INK_CC_BENCHMARK
+      ""
+      "NAME"
+      "SRCS;DEPS"
+      ${ARGN}
+    )
+    set(_NAME "ink_stroke_modeler_${INK_CC_BENCHMARK_NAME}")
+    add_executable(${_NAME} ${INK_CC_BENCHMARK_SRCS})
+    target_link_libraries(${_NAME} ${INK_CC_BENCHMARK_DEPS})
+  endif()
+endfunction()
+
+function(ink_cc_binary)
+  cmake_parse_arguments(INK_CC_BINARY
+    ""
+    "NAME"
+    "SRCS;DEPS"
+    ${ARGN}
+  )
+  set(_NAME "ink_stroke_modeler_${INK_CC_BINARY_NAME}")
+  add_executable(${_NAME} ${INK_CC_BINARY_SRCS})
+  target_link_libraries(${_NAME} ${INK_CC_BINARY_DEPS})
+endfunction()
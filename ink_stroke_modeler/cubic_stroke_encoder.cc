@@ -0,0 +1,275 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/cubic_stroke_encoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/internal/utils.h"
+#include "ink_stroke_modeler/internal/validation.h"
+#include "ink_stroke_modeler/numbers.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+// Returns the signed difference from angle `start` to angle `end`, along the
+// shorter path, in the range [-π, π].
+float AngleDifference(float start, float end) {
+  float delta = std::fmod(end - start, 2 * kPi);
+  if (delta > kPi) {
+    delta -= 2 * kPi;
+  } else if (delta < -kPi) {
+    delta += 2 * kPi;
+  }
+  return delta;
+}
+
+// Normalizes `angle` to the range [0, 2π).
+float NormalizeAngle(float angle) {
+  angle = std::fmod(angle, 2 * kPi);
+  if (angle < 0) angle += 2 * kPi;
+  // Adding 2π to a tiny negative angle can round up to 2π.
+  return angle >= 2 * kPi ? 0 : angle;
+}
+
+// The cubic Hermite basis functions, and their first and second derivatives,
+// evaluated at a single parameter value.
+struct HermiteBasis {
+  explicit HermiteBasis(float s) {
+    float s2 = s * s;
+    float s3 = s2 * s;
+    h00 = 2 * s3 - 3 * s2 + 1;
+    h10 = s3 - 2 * s2 + s;
+    h01 = -2 * s3 + 3 * s2;
+    h11 = s3 - s2;
+    d_h00 = 6 * s2 - 6 * s;
+    d_h10 = 3 * s2 - 4 * s + 1;
+    d_h01 = -6 * s2 + 6 * s;
+    d_h11 = 3 * s2 - 2 * s;
+    dd_h00 = 12 * s - 6;
+    dd_h10 = 6 * s - 4;
+    dd_h01 = -12 * s + 6;
+    dd_h11 = 6 * s - 2;
+  }
+
+  // Evaluates the curve with endpoint values `p0` and `p1`, and endpoint
+  // tangents `m0` and `m1` (with respect to the parameter, not time).
+  template <typename T>
+  T Value(T p0, T m0, T p1, T m1) const {
+    return h00 * p0 + h10 * m0 + h01 * p1 + h11 * m1;
+  }
+  template <typename T>
+  T Derivative(T p0, T m0, T p1, T m1) const {
+    return d_h00 * p0 + d_h10 * m0 + d_h01 * p1 + d_h11 * m1;
+  }
+  template <typename T>
+  T SecondDerivative(T p0, T m0, T p1, T m1) const {
+    return dd_h00 * p0 + dd_h10 * m0 + dd_h01 * p1 + dd_h11 * m1;
+  }
+
+  float h00, h10, h01, h11;
+  float d_h00, d_h10, d_h01, d_h11;
+  float dd_h00, dd_h10, dd_h01, dd_h11;
+};
+
+// Constructs the knot for `result`, estimating the rates of change of its
+// attributes from the preceding Result.
+StrokeKnot MakeKnot(const Result &previous, const Result &result) {
+  StrokeKnot knot{.result = result};
+  float dt = (result.time - previous.time).Value();
+  if (dt <= 0) return knot;
+
+  if (previous.pressure >= 0 && result.pressure >= 0) {
+    knot.pressure_rate = (result.pressure - previous.pressure) / dt;
+  }
+  if (previous.tilt >= 0 && result.tilt >= 0) {
+    knot.tilt_rate = (result.tilt - previous.tilt) / dt;
+  }
+  if (previous.orientation >= 0 && result.orientation >= 0) {
+    knot.orientation_rate =
+        AngleDifference(previous.orientation, result.orientation) / dt;
+  }
+  return knot;
+}
+
+// Returns true if the attribute values `a` and `b` are both unknown, or are
+// both known and within `tolerance` of each other.
+bool AttributeWithinTolerance(float a, float b, float tolerance) {
+  if (a < 0 || b < 0) return a < 0 && b < 0;
+  return std::abs(a - b) <= tolerance;
+}
+
+}  // namespace
+
+bool operator==(const StrokeKnot &lhs, const StrokeKnot &rhs) {
+  return lhs.result == rhs.result && lhs.pressure_rate == rhs.pressure_rate &&
+         lhs.tilt_rate == rhs.tilt_rate &&
+         lhs.orientation_rate == rhs.orientation_rate;
+}
+
+bool operator!=(const StrokeKnot &lhs, const StrokeKnot &rhs) {
+  return !(lhs == rhs);
+}
+
+Result EvaluateCubicStroke(const StrokeKnot &start, const StrokeKnot &end,
+                           Time time) {
+  const Result &r0 = start.result;
+  const Result &r1 = end.result;
+  float dt = (r1.time - r0.time).Value();
+  if (dt <= 0 || time <= r0.time) return r0;
+  if (time >= r1.time) return r1;
+
+  HermiteBasis basis((time - r0.time).Value() / dt);
+  Vec2 m0 = r0.velocity * dt;
+  Vec2 m1 = r1.velocity * dt;
+
+  Result result{
+      .position = basis.Value(r0.position, m0, r1.position, m1),
+      .velocity = basis.Derivative(r0.position, m0, r1.position, m1) / dt,
+      .acceleration = basis.SecondDerivative(r0.position, m0, r1.position, m1) /
+                      (dt * dt),
+      .time = time,
+  };
+
+  if (r0.pressure >= 0 && r1.pressure >= 0) {
+    // Hermite interpolation may overshoot the endpoint values, so we clamp to
+    // keep the pressure in its valid range.
+    result.pressure =
+        std::clamp(basis.Value(r0.pressure, start.pressure_rate * dt,
+                               r1.pressure, end.pressure_rate * dt),
+                   0.f, 1.f);
+  }
+  if (r0.tilt >= 0 && r1.tilt >= 0) {
+    result.tilt = std::clamp(basis.Value(r0.tilt, start.tilt_rate * dt, r1.tilt,
+                                         end.tilt_rate * dt),
+                             0.f, static_cast<float>(kPi / 2));
+  }
+  if (r0.orientation >= 0 && r1.orientation >= 0) {
+    // The orientation curve is evaluated relative to the start, so that it
+    // travels around the shorter path.
+    result.orientation = NormalizeAngle(
+        r0.orientation +
+        basis.Value(0.f, start.orientation_rate * dt,
+                    AngleDifference(r0.orientation, r1.orientation),
+                    end.orientation_rate * dt));
+  }
+  return result;
+}
+
+absl::Status CubicStrokeEncoder::Reset(const CubicStrokeEncoderParams &params) {
+  if (absl::Status status = ValidateGreaterThanZero(
+          params.position_tolerance,
+          "CubicStrokeEncoderParams::position_tolerance");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = ValidateGreaterThanZero(
+          params.attribute_tolerance,
+          "CubicStrokeEncoderParams::attribute_tolerance");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = ValidateGreaterThanZero(
+          params.max_results_per_segment,
+          "CubicStrokeEncoderParams::max_results_per_segment");
+      !status.ok()) {
+    return status;
+  }
+
+  params_ = params;
+  Reset();
+  return absl::OkStatus();
+}
+
+void CubicStrokeEncoder::Reset() {
+  last_knot_.reset();
+  pending_knots_.clear();
+}
+
+void CubicStrokeEncoder::Encode(absl::Span<const Result> results,
+                                std::vector<StrokeKnot> &knots) {
+  for (const Result &result : results) {
+    if (!last_knot_.has_value()) {
+      last_knot_ = StrokeKnot{.result = result};
+      knots.push_back(*last_knot_);
+      continue;
+    }
+
+    const Result &previous = pending_knots_.empty()
+                                 ? last_knot_->result
+                                 : pending_knots_.back().result;
+    StrokeKnot knot = MakeKnot(previous, result);
+    if (static_cast<int>(pending_knots_.size()) <
+            params_.max_results_per_segment &&
+        Fits(*last_knot_, knot)) {
+      pending_knots_.push_back(knot);
+      continue;
+    }
+
+    // The curves can't be extended to the new Result, so we finalize the
+    // previous one as a knot, and start a new segment from it. Because the
+    // segment from a knot to the Result immediately following it covers no
+    // other Results, it always fits.
+    last_knot_ = pending_knots_.back();
+    knots.push_back(*last_knot_);
+    pending_knots_.clear();
+    pending_knots_.push_back(knot);
+  }
+}
+
+void CubicStrokeEncoder::Finish(std::vector<StrokeKnot> &knots) {
+  if (!pending_knots_.empty()) knots.push_back(pending_knots_.back());
+  Reset();
+}
+
+std::optional<StrokeKnot> CubicStrokeEncoder::PendingKnot() const {
+  if (pending_knots_.empty()) return std::nullopt;
+  return pending_knots_.back();
+}
+
+bool CubicStrokeEncoder::Fits(const StrokeKnot &start,
+                              const StrokeKnot &end) const {
+  for (const StrokeKnot &knot : pending_knots_) {
+    const Result &expected = knot.result;
+    Result actual = EvaluateCubicStroke(start, end, expected.time);
+    if (Distance(expected.position, actual.position) >
+            params_.position_tolerance ||
+        !AttributeWithinTolerance(expected.pressure, actual.pressure,
+                                  params_.attribute_tolerance) ||
+        !AttributeWithinTolerance(expected.tilt, actual.tilt,
+                                  params_.attribute_tolerance)) {
+      return false;
+    }
+    if (expected.orientation >= 0 && actual.orientation >= 0) {
+      if (std::abs(AngleDifference(expected.orientation,
+                                   actual.orientation)) >
+          params_.attribute_tolerance) {
+        return false;
+      }
+    } else if (expected.orientation >= 0 || actual.orientation >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace stroke_model
+}  // namespace ink
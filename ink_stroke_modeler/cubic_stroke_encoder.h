@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_CUBIC_STROKE_ENCODER_H_
+#define INK_STROKE_MODELER_CUBIC_STROKE_ENCODER_H_
+
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// A knot of a piecewise-cubic stroke. Between two consecutive knots, the stroke
+// is described by cubic Hermite curves: the position curve matches the
+// positions and velocities of the knots' Results, and the pressure, tilt, and
+// orientation curves match their values and the rates of change given here.
+struct StrokeKnot {
+  Result result;
+
+  // The rates of change of the pressure, tilt, and orientation at the knot,
+  // with respect to time. These are zero if the corresponding value is
+  // unknown.
+  float pressure_rate = 0;
+  float tilt_rate = 0;
+  float orientation_rate = 0;
+};
+
+bool operator==(const StrokeKnot &lhs, const StrokeKnot &rhs);
+bool operator!=(const StrokeKnot &lhs, const StrokeKnot &rhs);
+
+// Evaluates the piecewise-cubic stroke between knots `start` and `end` at
+// `time`, which is clamped to the time range between them. The acceleration is
+// taken from the second derivative of the position curve.
+//
+// As with the Results from StrokeModeler, the pressure, tilt, and orientation
+// are -1 if they are unknown (i.e. < 0) on either knot, and the orientation
+// travels around the shorter path and is normalized to [0, 2π).
+Result EvaluateCubicStroke(const StrokeKnot &start, const StrokeKnot &end,
+                           Time time);
+
+struct CubicStrokeEncoderParams {
+  // The maximum distance between a Result passed to the encoder and the
+  // position of the piecewise-cubic stroke at the same time. Increasing this
+  // reduces the number of knots.
+  float position_tolerance = -1;
+
+  // The maximum difference between the pressure, tilt, or orientation of a
+  // Result passed to the encoder and the piecewise-cubic stroke at the same
+  // time.
+  float attribute_tolerance = -1;
+
+  // The maximum number of Results covered by the curves between two knots.
+  // This bounds the cost of fitting each Result, which is linear in this
+  // number.
+  int max_results_per_segment = 32;
+};
+
+// This class converts the dense Results produced by StrokeModeler into a
+// piecewise-cubic stroke, described by a sequence of knots (see StrokeKnot).
+// Each Result is either kept as a knot, or is within the given tolerances of
+// the curves between the surrounding knots, so that consumers can store and
+// transmit far fewer knots than Results, and evaluate the stroke at any
+// resolution with EvaluateCubicStroke().
+//
+// Example usage:
+//   modeler.Update(input, results);
+//   encoder.Encode(results, knots);
+//   results.clear();
+//   ...
+//   // At the end of the stroke:
+//   encoder.Finish(knots);
+class CubicStrokeEncoder {
+ public:
+  // Clears any in-progress stroke, and initializes (or re-initializes) the
+  // encoder with the given parameters. Returns an error if the parameters are
+  // invalid.
+  absl::Status Reset(const CubicStrokeEncoderParams &params);
+
+  // Clears any in-progress stroke, keeping the same parameters.
+  void Reset();
+
+  // Encodes the given Results, which continue the stroke, and appends any
+  // knots that have been finalized to `knots`. The Results must be in the
+  // order generated by StrokeModeler, i.e. with non-decreasing time.
+  //
+  // The first Result of each stroke always becomes a knot. Subsequent knots
+  // are only finalized once a later Result can't be fit without them, so the
+  // end of the stroke so far is held back; see PendingKnot().
+  void Encode(absl::Span<const Result> results, std::vector<StrokeKnot> &knots);
+
+  // Appends the last knot of the stroke to `knots`, if there is one that has
+  // not yet been finalized, and clears the stroke.
+  void Finish(std::vector<StrokeKnot> &knots);
+
+  // Returns the knot at the end of the stroke so far, if it has not yet been
+  // finalized. This may be used to render an in-progress stroke; it will be
+  // replaced by later Results.
+  std::optional<StrokeKnot> PendingKnot() const;
+
+ private:
+  // Returns true if the curves between `start` and `end` are within tolerance
+  // of all of `pending_knots_`.
+  bool Fits(const StrokeKnot &start, const StrokeKnot &end) const;
+
+  CubicStrokeEncoderParams params_;
+
+  // The last finalized knot, or std::nullopt if no Results have been encoded
+  // since the start of the stroke.
+  std::optional<StrokeKnot> last_knot_;
+
+  // The knots for the Results after `last_knot_`. Only the last one may become
+  // a knot; the rest are covered by the curves from `last_knot_` to it.
+  std::vector<StrokeKnot> pending_knots_;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_CUBIC_STROKE_ENCODER_H_
@@ -0,0 +1,292 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/cubic_stroke_encoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "ink_stroke_modeler/internal/type_matchers.h"
+#include "ink_stroke_modeler/numbers.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::IsEmpty;
+
+constexpr float kTol = 1e-4;
+
+const CubicStrokeEncoderParams kDefaultEncoderParams{
+    .position_tolerance = .001, .attribute_tolerance = .01};
+
+// Returns a Result moving at a constant velocity of (2, 1), starting at the
+// origin at time zero.
+Result LinearResult(double time) {
+  return {.position = {2.f * static_cast<float>(time),
+                       static_cast<float>(time)},
+          .velocity = {2, 1},
+          .time = Time(time)};
+}
+
+TEST(CubicStrokeEncoderTest, RejectsInvalidParams) {
+  CubicStrokeEncoder encoder;
+  EXPECT_EQ(encoder.Reset(CubicStrokeEncoderParams{}).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  CubicStrokeEncoderParams params = kDefaultEncoderParams;
+  params.position_tolerance = 0;
+  EXPECT_EQ(encoder.Reset(params).code(), absl::StatusCode::kInvalidArgument);
+
+  params = kDefaultEncoderParams;
+  params.attribute_tolerance = std::nanf("");
+  EXPECT_EQ(encoder.Reset(params).code(), absl::StatusCode::kInvalidArgument);
+
+  params = kDefaultEncoderParams;
+  params.max_results_per_segment = 0;
+  EXPECT_EQ(encoder.Reset(params).code(), absl::StatusCode::kInvalidArgument);
+
+  EXPECT_TRUE(encoder.Reset(kDefaultEncoderParams).ok());
+}
+
+TEST(EvaluateCubicStrokeTest, ReproducesConstantVelocity) {
+  StrokeKnot start{.result = LinearResult(0)};
+  StrokeKnot end{.result = LinearResult(1)};
+
+  EXPECT_THAT(EvaluateCubicStroke(start, end, Time(.25)),
+              ResultNear(LinearResult(.25), kTol, kTol));
+  EXPECT_THAT(EvaluateCubicStroke(start, end, Time(.7)),
+              ResultNear(LinearResult(.7), kTol, kTol));
+
+  // The time is clamped to the segment.
+  EXPECT_EQ(EvaluateCubicStroke(start, end, Time(-1)), start.result);
+  EXPECT_EQ(EvaluateCubicStroke(start, end, Time(2)), end.result);
+}
+
+TEST(EvaluateCubicStrokeTest, MatchesKnotVelocitiesAndAttributeRates) {
+  StrokeKnot start{.result = {.position = {0, 0},
+                              .velocity = {1, 0},
+                              .time = Time(0),
+                              .pressure = .2,
+                              .tilt = .5,
+                              .orientation = 1},
+                   .pressure_rate = 1,
+                   .tilt_rate = 0,
+                   .orientation_rate = -1};
+  StrokeKnot end{.result = {.position = {1, 1},
+                            .velocity = {0, 1},
+                            .time = Time(1),
+                            .pressure = .6,
+                            .tilt = .5,
+                            .orientation = .5},
+                 .pressure_rate = 0,
+                 .tilt_rate = 0,
+                 .orientation_rate = 0};
+
+  // Near the endpoints, the curves follow the tangents.
+  constexpr double kEpsilon = 1e-3;
+  Result near_start = EvaluateCubicStroke(start, end, Time(kEpsilon));
+  EXPECT_THAT(near_start.velocity, Vec2Near({1, 0}, .01));
+  EXPECT_THAT(near_start.pressure, FloatNear(.2 + kEpsilon, 1e-5));
+  EXPECT_THAT(near_start.orientation, FloatNear(1 - kEpsilon, 1e-5));
+  Result near_end = EvaluateCubicStroke(start, end, Time(1 - kEpsilon));
+  EXPECT_THAT(near_end.velocity, Vec2Near({0, 1}, .01));
+  EXPECT_THAT(near_end.pressure, FloatNear(.6, 1e-5));
+
+  Result middle = EvaluateCubicStroke(start, end, Time(.5));
+  EXPECT_THAT(middle.tilt, FloatNear(.5, 1e-6));
+  EXPECT_THAT(middle.time, TimeNear(Time(.5), 1e-6));
+}
+
+TEST(EvaluateCubicStrokeTest, UnknownAttributesStayUnknown) {
+  StrokeKnot start{.result = LinearResult(0)};
+  StrokeKnot end{.result = LinearResult(1)};
+  start.result.pressure = .5;
+  end.result.tilt = .5;
+  start.result.orientation = 1;
+  end.result.orientation = 2;
+
+  Result result = EvaluateCubicStroke(start, end, Time(.5));
+  EXPECT_EQ(result.pressure, -1);
+  EXPECT_EQ(result.tilt, -1);
+  EXPECT_THAT(result.orientation, FloatNear(1.5, 1e-5));
+}
+
+TEST(EvaluateCubicStrokeTest, OrientationTravelsAroundShorterPath) {
+  StrokeKnot start{.result = LinearResult(0)};
+  StrokeKnot end{.result = LinearResult(1)};
+  start.result.orientation = 2 * kPi - .2;
+  end.result.orientation = .4;
+  // With these rates, the orientation changes linearly.
+  start.orientation_rate = .6;
+  end.orientation_rate = .6;
+
+  EXPECT_THAT(EvaluateCubicStroke(start, end, Time(.25)).orientation,
+              FloatNear(2 * kPi - .05, 1e-5));
+  EXPECT_THAT(EvaluateCubicStroke(start, end, Time(.75)).orientation,
+              FloatNear(.25, 1e-5));
+}
+
+TEST(CubicStrokeEncoderTest, FirstResultIsAKnotAndLastIsPending) {
+  CubicStrokeEncoder encoder;
+  ASSERT_TRUE(encoder.Reset(kDefaultEncoderParams).ok());
+  EXPECT_EQ(encoder.PendingKnot(), std::nullopt);
+
+  std::vector<StrokeKnot> knots;
+  encoder.Encode({LinearResult(0)}, knots);
+  ASSERT_EQ(knots.size(), 1);
+  EXPECT_EQ(knots[0].result, LinearResult(0));
+  EXPECT_EQ(encoder.PendingKnot(), std::nullopt);
+
+  knots.clear();
+  encoder.Encode({LinearResult(.1), LinearResult(.2), LinearResult(.3)}, knots);
+  EXPECT_THAT(knots, IsEmpty());
+  ASSERT_TRUE(encoder.PendingKnot().has_value());
+  EXPECT_EQ(encoder.PendingKnot()->result, LinearResult(.3));
+
+  encoder.Finish(knots);
+  ASSERT_EQ(knots.size(), 1);
+  EXPECT_EQ(knots[0].result, LinearResult(.3));
+  EXPECT_EQ(encoder.PendingKnot(), std::nullopt);
+
+  // After finishing, the next Result starts a new stroke.
+  knots.clear();
+  encoder.Encode({LinearResult(5)}, knots);
+  ASSERT_EQ(knots.size(), 1);
+  EXPECT_EQ(knots[0].result, LinearResult(5));
+}
+
+TEST(CubicStrokeEncoderTest, MaxResultsPerSegment) {
+  CubicStrokeEncoderParams params = kDefaultEncoderParams;
+  params.max_results_per_segment = 4;
+  CubicStrokeEncoder encoder;
+  ASSERT_TRUE(encoder.Reset(params).ok());
+
+  std::vector<Result> results;
+  for (int i = 0; i <= 10; ++i) results.push_back(LinearResult(i));
+  std::vector<StrokeKnot> knots;
+  encoder.Encode(results, knots);
+  encoder.Finish(knots);
+
+  std::vector<Time> knot_times;
+  for (const StrokeKnot &knot : knots) knot_times.push_back(knot.result.time);
+  EXPECT_THAT(knot_times, ElementsAre(Time(0), Time(4), Time(8), Time(10)));
+}
+
+TEST(CubicStrokeEncoderTest, SplitsSegmentAtCorner) {
+  CubicStrokeEncoder encoder;
+  ASSERT_TRUE(encoder.Reset(kDefaultEncoderParams).ok());
+
+  std::vector<Result> results;
+  for (int i = 0; i <= 5; ++i) {
+    results.push_back({.position = {static_cast<float>(i), 0},
+                       .velocity = {1, 0},
+                       .time = Time(i)});
+  }
+  for (int i = 1; i <= 5; ++i) {
+    results.push_back({.position = {5, static_cast<float>(i)},
+                       .velocity = {0, 1},
+                       .time = Time(5 + i)});
+  }
+  std::vector<StrokeKnot> knots;
+  encoder.Encode(results, knots);
+  encoder.Finish(knots);
+
+  std::vector<Time> knot_times;
+  for (const StrokeKnot &knot : knots) knot_times.push_back(knot.result.time);
+  // Each straight section is covered by a single segment, with another for the
+  // turn between them.
+  EXPECT_THAT(knot_times, ElementsAre(Time(0), Time(5), Time(6), Time(10)));
+}
+
+// Runs a looping stroke with varying pressure, tilt, and orientation through
+// the StrokeModeler, and checks that the knots reproduce every Result within
+// tolerance, while being far fewer in number.
+TEST(CubicStrokeEncoderTest, EncodesModeledStrokeWithinTolerance) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(
+      modeler
+          .Reset({.wobble_smoother_params{.timeout = Duration(.04),
+                                          .speed_floor = 1.31,
+                                          .speed_ceiling = 1.44},
+                  .position_modeler_params{.spring_mass_constant = 11.f / 32400,
+                                           .drag_constant = 72.f},
+                  .sampling_params{.min_output_rate = 1000,
+                                   .end_of_stroke_stopping_distance = .001,
+                                   .end_of_stroke_max_iterations = 20},
+                  .stylus_state_modeler_params{.max_input_samples = 20},
+                  .prediction_params = StrokeEndPredictorParams()})
+          .ok());
+  CubicStrokeEncoder encoder;
+  ASSERT_TRUE(encoder.Reset(kDefaultEncoderParams).ok());
+
+  std::vector<Result> all_results;
+  std::vector<Result> results;
+  std::vector<StrokeKnot> knots;
+  constexpr int kNumInputs = 60;
+  for (int i = 0; i <= kNumInputs; ++i) {
+    float t = i / 120.f;
+    Input input{.event_type = i == 0            ? Input::EventType::kDown
+                              : i == kNumInputs ? Input::EventType::kUp
+                                                : Input::EventType::kMove,
+                .position = {3 * std::cos(4 * t) + t, 3 * std::sin(4 * t)},
+                .time = Time(t),
+                .pressure = .5f + .4f * std::sin(10 * t),
+                .tilt = .3f + .2f * t,
+                .orientation =
+                    static_cast<float>(std::fmod(6 + 3 * t, 2 * kPi))};
+    results.clear();
+    ASSERT_TRUE(modeler.Update(input, results).ok());
+    encoder.Encode(results, knots);
+    all_results.insert(all_results.end(), results.begin(), results.end());
+  }
+  encoder.Finish(knots);
+
+  ASSERT_GE(knots.size(), 2);
+  EXPECT_EQ(knots.front().result, all_results.front());
+  EXPECT_EQ(knots.back().result, all_results.back());
+  EXPECT_LT(knots.size() * 5, all_results.size());
+
+  // Allow a small amount of slack for floating-point error.
+  const float kPositionTol = kDefaultEncoderParams.position_tolerance * 1.01f;
+  const float kAttributeTol = kDefaultEncoderParams.attribute_tolerance * 1.01f;
+  for (const Result &expected : all_results) {
+    auto end = std::lower_bound(knots.begin(), knots.end(), expected.time,
+                                [](const StrokeKnot &knot, Time time) {
+                                  return knot.result.time < time;
+                                });
+    ASSERT_NE(end, knots.end());
+    auto start = end == knots.begin() ? end : end - 1;
+    Result actual = EvaluateCubicStroke(*start, *end, expected.time);
+    EXPECT_THAT(actual.position, Vec2Near(expected.position, kPositionTol));
+    EXPECT_THAT(actual.pressure, FloatNear(expected.pressure, kAttributeTol));
+    EXPECT_THAT(actual.tilt, FloatNear(expected.tilt, kAttributeTol));
+    EXPECT_THAT(actual.orientation,
+                FloatNear(expected.orientation, kAttributeTol));
+  }
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
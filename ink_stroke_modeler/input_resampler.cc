@@ -0,0 +1,145 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/input_resampler.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/substitute.h"
+#include "ink_stroke_modeler/internal/utils.h"
+#include "ink_stroke_modeler/internal/validation.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+// Returns the move input at `time`, interpolated between `start` and `end`,
+// where `start.time` < `time` <= `end.time`.
+Input InterpInput(const Input &start, const Input &end, Time time) {
+  float interp_amount =
+      (time - start.time).Value() / (end.time - start.time).Value();
+  return {
+      .event_type = Input::EventType::kMove,
+      .position = Interp(start.position, end.position, interp_amount),
+      .time = time,
+      .pressure = start.pressure < 0 || end.pressure < 0
+                      ? -1
+                      : Interp(start.pressure, end.pressure, interp_amount),
+      .tilt = start.tilt < 0 || end.tilt < 0
+                  ? -1
+                  : Interp(start.tilt, end.tilt, interp_amount),
+      .orientation =
+          start.orientation < 0 || end.orientation < 0
+              ? -1
+              : InterpAngle(start.orientation, end.orientation, interp_amount),
+  };
+}
+
+}  // namespace
+
+absl::Status InputResampler::Reset(const InputResamplerParams &params) {
+  if (absl::Status status = ValidateGreaterThanZero(
+          params.target_rate, "InputResamplerParams::target_rate");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = ValidateGreaterThanZero(
+          params.max_inputs_per_call,
+          "InputResamplerParams::max_inputs_per_call");
+      !status.ok()) {
+    return status;
+  }
+
+  params_ = params;
+  Reset();
+  return absl::OkStatus();
+}
+
+void InputResampler::Reset() {
+  last_input_.reset();
+  next_index_ = 1;
+}
+
+Time InputResampler::ResampledTime(int64_t index) const {
+  return start_time_ + Duration(index / params_.target_rate);
+}
+
+absl::Status InputResampler::Update(const Input &input,
+                                    std::vector<Input> &inputs) {
+  if (params_.target_rate <= 0) {
+    return absl::FailedPreconditionError(
+        "Input resampler has not yet been initialized");
+  }
+  if (absl::Status status = ValidateInput(input); !status.ok()) {
+    return status;
+  }
+
+  if (input.event_type == Input::EventType::kDown) {
+    if (last_input_.has_value()) {
+      return absl::FailedPreconditionError(
+          "Received down event while stroke is in-progress");
+    }
+    inputs.push_back(input);
+    last_input_ = input;
+    start_time_ = input.time;
+    next_index_ = 1;
+    return absl::OkStatus();
+  }
+
+  if (!last_input_.has_value()) {
+    return absl::FailedPreconditionError(
+        input.event_type == Input::EventType::kUp
+            ? "Received up event while no stroke is in-progress"
+            : "Received move event while no stroke is in-progress");
+  }
+  if (*last_input_ == input) {
+    return absl::InvalidArgumentError("Received duplicate input");
+  }
+  if (input.time < last_input_->time) {
+    return absl::InvalidArgumentError("Inputs travel backwards in time");
+  }
+
+  // A move input is generated at the time of a raw move input, but the up
+  // event takes the place of one at its time.
+  const bool is_up_event = input.event_type == Input::EventType::kUp;
+  int64_t end_index = next_index_;
+  while (ResampledTime(end_index) < input.time ||
+         (!is_up_event && ResampledTime(end_index) == input.time)) {
+    if (end_index - next_index_ == params_.max_inputs_per_call) {
+      return absl::InvalidArgumentError(absl::Substitute(
+          "Input events are too far apart; requested more than $0 inputs.",
+          params_.max_inputs_per_call));
+    }
+    ++end_index;
+  }
+
+  for (; next_index_ < end_index; ++next_index_) {
+    inputs.push_back(
+        InterpInput(*last_input_, input, ResampledTime(next_index_)));
+  }
+  if (is_up_event) {
+    inputs.push_back(input);
+    last_input_.reset();
+  } else {
+    last_input_ = input;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INPUT_RESAMPLER_H_
+#define INK_STROKE_MODELER_INPUT_RESAMPLER_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+struct InputResamplerParams {
+  // The rate of the resampled move inputs, in inputs per unit time. This must
+  // be greater than zero.
+  //
+  // A good starting point is the input rate for which the StrokeModelParams
+  // were tuned, e.g. 120 Hz.
+  double target_rate = -1;
+
+  // The maximum number of resampled inputs to generate per call to Update().
+  // This limit avoids generating an unbounded number of inputs if input events
+  // are received with too long of a time between, e.g. because a client was
+  // suspended and resumed. This must be greater than zero.
+  int max_inputs_per_call = 100000;
+};
+
+// This class resamples raw input to a fixed rate, so that it can be passed to
+// StrokeModeler at the rate for which its parameters were tuned, and the cost
+// of modeling is independent of the rate of the device. Input faster than the
+// target rate is decimated, and input slower than it is upsampled.
+//
+// The down and up events are passed through unchanged. In between, a move
+// input is generated at each multiple of the target interval after the down
+// event, by linearly interpolating the position, pressure, and tilt of the
+// raw inputs on either side of it; the orientation is interpolated around
+// the shorter path. As for Results, the pressure, tilt, or orientation is -1
+// if it's unknown (i.e. < 0) on either raw input. A move input is generated
+// once a raw input at or after its time has been received, so the resampled
+// input lags the raw input by less than the target interval.
+//
+// Example usage:
+//   resampler.Update(raw_input, inputs);
+//   for (const Input& input : inputs) modeler.Update(input, results);
+//   inputs.clear();
+class InputResampler {
+ public:
+  // Clears any in-progress stroke, and initializes (or re-initializes) the
+  // resampler with the given parameters. Returns an error if the parameters
+  // are invalid.
+  absl::Status Reset(const InputResamplerParams &params);
+
+  // Clears any in-progress stroke, keeping the same parameters.
+  void Reset();
+
+  // Resamples the given raw input, appending any resampled inputs to
+  // `inputs`. This may append no inputs, if the raw input is less than the
+  // target interval after the most recent resampled input.
+  //
+  // Returns an error if the resampler has not yet been initialized (via
+  // Reset), if the input is invalid or the input stream is malformed (e.g.
+  // decreasing time, Up event before Down event), or if it would generate
+  // more than InputResamplerParams::max_inputs_per_call inputs. In that case,
+  // `inputs` will be unmodified after the call.
+  absl::Status Update(const Input &input, std::vector<Input> &inputs);
+
+ private:
+  // Returns the time of the move input with the given index.
+  Time ResampledTime(int64_t index) const;
+
+  InputResamplerParams params_;
+
+  // The most recent raw input of the stroke in progress, or std::nullopt if
+  // there is none.
+  std::optional<Input> last_input_;
+
+  // The time of the down event of the stroke in progress, and the index of
+  // the next move input to generate. The move inputs are generated at
+  // multiples of the interval from the down event, instead of by accumulating
+  // intervals, so that their times don't drift.
+  Time start_time_{0};
+  int64_t next_index_ = 1;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INPUT_RESAMPLER_H_
@@ -0,0 +1,250 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/input_resampler.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/internal/type_matchers.h"
+#include "ink_stroke_modeler/numbers.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::IsEmpty;
+
+constexpr float kTol = 1e-5;
+
+TEST(InputResamplerTest, RejectsInvalidParams) {
+  InputResampler resampler;
+  EXPECT_EQ(resampler.Reset(InputResamplerParams{}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(
+      resampler.Reset({.target_rate = 120, .max_inputs_per_call = 0}).code(),
+      absl::StatusCode::kInvalidArgument);
+  EXPECT_TRUE(resampler.Reset({.target_rate = 120}).ok());
+}
+
+TEST(InputResamplerTest, UpdateBeforeResetFails) {
+  InputResampler resampler;
+  std::vector<Input> inputs;
+  EXPECT_EQ(resampler.Update({.event_type = Input::EventType::kDown}, inputs)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_THAT(inputs, IsEmpty());
+}
+
+TEST(InputResamplerTest, UpsamplesSlowInput) {
+  InputResampler resampler;
+  ASSERT_TRUE(resampler.Reset({.target_rate = 100}).ok());
+  const Input down{.event_type = Input::EventType::kDown,
+                   .position = {0, 0},
+                   .time = Time(0),
+                   .pressure = .2,
+                   .tilt = .4,
+                   .orientation = 6};
+  std::vector<Input> inputs;
+  ASSERT_TRUE(resampler.Update(down, inputs).ok());
+  EXPECT_THAT(inputs, ElementsAre(down));
+
+  inputs.clear();
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {4, 2},
+                           .time = Time(.04),
+                           .pressure = .6,
+                           .tilt = .8,
+                           .orientation = .5},
+                          inputs)
+                  .ok());
+  ASSERT_EQ(inputs.size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    float t = (i + 1) / 4.f;
+    EXPECT_EQ(inputs[i].event_type, Input::EventType::kMove);
+    EXPECT_THAT(inputs[i].time, TimeNear(Time(.01 * (i + 1)), kTol));
+    EXPECT_THAT(inputs[i].position, Vec2Near({4 * t, 2 * t}, kTol));
+    EXPECT_THAT(inputs[i].pressure, FloatNear(.2 + .4 * t, kTol));
+    EXPECT_THAT(inputs[i].tilt, FloatNear(.4 + .4 * t, kTol));
+  }
+  // The orientation is interpolated across 0, the shorter way around.
+  EXPECT_THAT(inputs[1].orientation,
+              FloatNear(6 + (.5 + 2 * kPi - 6) / 2 - 2 * kPi, kTol));
+}
+
+TEST(InputResamplerTest, PassesThroughDownAndUpEvents) {
+  InputResampler resampler;
+  ASSERT_TRUE(resampler.Reset({.target_rate = 100}).ok());
+  const Input down{.event_type = Input::EventType::kDown,
+                   .position = {1, 2},
+                   .time = Time(0)};
+  const Input up{.event_type = Input::EventType::kUp,
+                 .position = {3, 4},
+                 .time = Time(.02)};
+  std::vector<Input> inputs;
+  ASSERT_TRUE(resampler.Update(down, inputs).ok());
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {2, 3},
+                           .time = Time(.005)},
+                          inputs)
+                  .ok());
+  ASSERT_TRUE(resampler.Update(up, inputs).ok());
+
+  // The up event takes the place of the move input at .02.
+  ASSERT_EQ(inputs.size(), 3);
+  EXPECT_EQ(inputs[0], down);
+  EXPECT_EQ(inputs[1].event_type, Input::EventType::kMove);
+  EXPECT_THAT(inputs[1].time, TimeNear(Time(.01), kTol));
+  EXPECT_THAT(inputs[1].position, Vec2Near({2.333333, 3.333333}, kTol));
+  EXPECT_EQ(inputs[2], up);
+
+  // The next stroke is resampled from its own down event.
+  inputs.clear();
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .time = Time(.0234)},
+                          inputs)
+                  .ok());
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .time = Time(.04)},
+                          inputs)
+                  .ok());
+  ASSERT_EQ(inputs.size(), 2);
+  EXPECT_THAT(inputs[1].time, TimeNear(Time(.0334), kTol));
+}
+
+TEST(InputResamplerTest, UnknownAttributesStayUnknown) {
+  InputResampler resampler;
+  ASSERT_TRUE(resampler.Reset({.target_rate = 100}).ok());
+  std::vector<Input> inputs;
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .time = Time(0),
+                           .pressure = .5,
+                           .tilt = -1,
+                           .orientation = 1},
+                          inputs)
+                  .ok());
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {1, 0},
+                           .time = Time(.02),
+                           .pressure = -1,
+                           .tilt = .5,
+                           .orientation = 1},
+                          inputs)
+                  .ok());
+  ASSERT_EQ(inputs.size(), 3);
+  EXPECT_EQ(inputs[1].pressure, -1);
+  EXPECT_EQ(inputs[1].tilt, -1);
+  EXPECT_THAT(inputs[1].orientation, FloatNear(1, kTol));
+}
+
+TEST(InputResamplerTest, DecimatesHighRateInput) {
+  InputResampler resampler;
+  ASSERT_TRUE(resampler.Reset({.target_rate = 120}).ok());
+  std::vector<Input> raw_inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .duration = Duration(1),
+       .input_rate = 1000,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+  std::vector<Input> inputs;
+  for (const Input &input : raw_inputs) {
+    ASSERT_TRUE(resampler.Update(input, inputs).ok());
+  }
+
+  // One down event, 119 or 120 move inputs, and one up event.
+  ASSERT_GE(inputs.size(), 121);
+  ASSERT_LE(inputs.size(), 122);
+  EXPECT_EQ(inputs.front(), raw_inputs.front());
+  EXPECT_EQ(inputs.back(), raw_inputs.back());
+  for (int i = 1; i + 1 < static_cast<int>(inputs.size()); ++i) {
+    EXPECT_EQ(inputs[i].event_type, Input::EventType::kMove);
+    EXPECT_THAT(inputs[i].time,
+                TimeNear(raw_inputs.front().time + Duration(i / 120.), kTol));
+  }
+}
+
+TEST(InputResamplerTest, RejectsMalformedInput) {
+  InputResampler resampler;
+  ASSERT_TRUE(resampler.Reset({.target_rate = 100}).ok());
+  std::vector<Input> inputs;
+  EXPECT_EQ(resampler.Update({.event_type = Input::EventType::kMove}, inputs)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_EQ(
+      resampler.Update({.event_type = Input::EventType::kUp}, inputs).code(),
+      absl::StatusCode::kFailedPrecondition);
+
+  const Input down{.event_type = Input::EventType::kDown, .time = Time(1)};
+  ASSERT_TRUE(resampler.Update(down, inputs).ok());
+  inputs.clear();
+  EXPECT_EQ(resampler.Update(down, inputs).code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_EQ(resampler
+                .Update({.event_type = Input::EventType::kMove,
+                         .time = Time(.5)},
+                        inputs)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  const Input move{.event_type = Input::EventType::kMove,
+                   .position = {1, 1},
+                   .time = Time(1.001)};
+  ASSERT_TRUE(resampler.Update(move, inputs).ok());
+  EXPECT_EQ(resampler.Update(move, inputs).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(inputs, IsEmpty());
+}
+
+TEST(InputResamplerTest, RejectsInputsTooFarApart) {
+  InputResampler resampler;
+  ASSERT_TRUE(
+      resampler.Reset({.target_rate = 100, .max_inputs_per_call = 10}).ok());
+  std::vector<Input> inputs;
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .time = Time(0)},
+                          inputs)
+                  .ok());
+  inputs.clear();
+  EXPECT_EQ(resampler
+                .Update({.event_type = Input::EventType::kMove,
+                         .time = Time(.115)},
+                        inputs)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(inputs, IsEmpty());
+
+  // Exactly the maximum number of inputs is allowed.
+  ASSERT_TRUE(resampler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .time = Time(.105)},
+                          inputs)
+                  .ok());
+  EXPECT_EQ(inputs.size(), 10);
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
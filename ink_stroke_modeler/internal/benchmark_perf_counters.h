@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_BENCHMARK_PERF_COUNTERS_H_
+#define INK_STROKE_MODELER_INTERNAL_BENCHMARK_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/statusor.h"
+#include "ink_stroke_modeler/internal/perf_counters.h"
+
+namespace ink {
+namespace stroke_model {
+
+// Counts hardware events over the measured part of each benchmark iteration,
+// and reports them per modeled input and per output Result as benchmark
+// counters, e.g. "cycles_per_input" and "llc_misses_per_result".
+//
+// If no counters are available, the benchmark is labeled as such and runs as
+// usual, with only the wall-clock measurements.
+class BenchmarkPerfCounters {
+ public:
+  explicit BenchmarkPerfCounters(benchmark::State &state)
+      : state_(state), counters_(PerfCounters::Create()) {
+    if (!counters_.ok()) state_.SetLabel("perf counters unavailable");
+  }
+
+  void Start() {
+    if (counters_.ok()) counters_->Start();
+  }
+  void Stop() {
+    if (counters_.ok()) counters_->Stop();
+  }
+
+  // Reports the counts accumulated over all iterations, divided by the total
+  // number of inputs and of results over all iterations.
+  void Report(int64_t n_inputs, int64_t n_results) {
+    if (!counters_.ok()) return;
+    for (const auto &[name, value] : PerUnitCounts(*counters_, "input",
+                                                   n_inputs)) {
+      state_.counters[name] = value;
+    }
+    for (const auto &[name, value] : PerUnitCounts(*counters_, "result",
+                                                   n_results)) {
+      state_.counters[name] = value;
+    }
+  }
+
+ private:
+  benchmark::State &state_;
+  absl::StatusOr<PerfCounters> counters_;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_BENCHMARK_PERF_COUNTERS_H_
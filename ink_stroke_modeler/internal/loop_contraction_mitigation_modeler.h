@@ -1,8 +1,7 @@
 #ifndef INK_STROKE_MODELER_INTERNAL_LOOP_CONTRACTION_MITIGATION_MODELER_H_
 #define INK_STROKE_MODELER_INTERNAL_LOOP_CONTRACTION_MITIGATION_MODELER_H_
 
-#include <deque>
-
+#include "ink_stroke_modeler/internal/sliding_window_stats.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
 
@@ -21,7 +20,7 @@ class LoopContractionMitigationModeler {
 
   // Returns the interpolation value based on the current set of available
   // speeds and the LoopContractionMitigationParameters.
-  float GetInterpolationValue();
+  float GetInterpolationValue() const;
 
   // Saves the current state of the modeler. See comment on
   // StrokeModeler::Save() for more details.
@@ -31,18 +30,21 @@ class LoopContractionMitigationModeler {
   // StrokeModeler::Restore() for more details.
   void Restore();
 
+  // Copies the current state and parameters of `other`, but not its saved
+  // state. See comment on StrokeModeler::ModelHypothetical() for more details.
+  void CopyStateFrom(const LoopContractionMitigationModeler &other);
+
  private:
-  struct SpeedSample {
-    float speed;
-    Time time;
-  };
-  std::deque<SpeedSample> speed_samples_;
-
-  // Use a deque + bool instead of optional<deque> for performance. A
-  // std::deque, which has a non-trivial destructor that would deallocate its
-  // capacity. This setup avoids extra calls to the destructor that would be
-  // triggered by each call to std::optional::reset().
-  std::deque<SpeedSample> saved_speed_samples_;
+  // The speeds of the samples in the moving average window; this keeps a
+  // running sum, so the average does not need to be recomputed each time.
+  SlidingWindowStats<1> speed_samples_;
+
+  // Use a SlidingWindowStats + bool instead of optional<SlidingWindowStats> for
+  // performance. SlidingWindowStats contains a std::deque, which has a
+  // non-trivial destructor that would deallocate its capacity. This setup
+  // avoids extra calls to the destructor that would be triggered by each call
+  // to std::optional::reset().
+  SlidingWindowStats<1> saved_speed_samples_;
   bool save_active_ = false;
 
   PositionModelerParams::LoopContractionMitigationParameters params_;
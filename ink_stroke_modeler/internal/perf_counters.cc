@@ -0,0 +1,217 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/perf_counters.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+constexpr std::array<PerfCounter, kNumPerfCounters> kAllPerfCounters = {
+    PerfCounter::kCycles, PerfCounter::kInstructions,
+    PerfCounter::kBranchMisses, PerfCounter::kL1DataCacheMisses,
+    PerfCounter::kLastLevelCacheMisses};
+
+#ifdef __linux__
+
+// Returns the perf_event_attr type and config for the counter.
+std::pair<uint32_t, uint64_t> EventTypeAndConfig(PerfCounter counter) {
+  switch (counter) {
+    case PerfCounter::kCycles:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+    case PerfCounter::kInstructions:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+    case PerfCounter::kBranchMisses:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+    case PerfCounter::kL1DataCacheMisses:
+      return {PERF_TYPE_HW_CACHE,
+              PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    case PerfCounter::kLastLevelCacheMisses:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+  }
+  return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+}
+
+int OpenCounter(PerfCounter counter, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  std::tie(attr.type, attr.config) = EventTypeAndConfig(counter);
+  // Only the leader's disabled bit matters; members follow the leader.
+  attr.disabled = group_fd < 0;
+  // Counting the kernel requires a lower perf_event_paranoid, and the model
+  // doesn't make system calls anyway.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return syscall(SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+#endif  // __linux__
+
+}  // namespace
+
+absl::string_view PerfCounterName(PerfCounter counter) {
+  switch (counter) {
+    case PerfCounter::kCycles:
+      return "cycles";
+    case PerfCounter::kInstructions:
+      return "instructions";
+    case PerfCounter::kBranchMisses:
+      return "branch_misses";
+    case PerfCounter::kL1DataCacheMisses:
+      return "l1d_misses";
+    case PerfCounter::kLastLevelCacheMisses:
+      return "llc_misses";
+  }
+  return "unknown";
+}
+
+absl::StatusOr<PerfCounters> PerfCounters::Create() {
+#ifdef __linux__
+  PerfCounters counters;
+  int first_errno = 0;
+  for (PerfCounter counter : kAllPerfCounters) {
+    int fd = OpenCounter(counter, counters.leader_fd_);
+    if (fd < 0) {
+      if (first_errno == 0) first_errno = errno;
+      continue;
+    }
+    counters.fds_[static_cast<int>(counter)] = fd;
+    if (counters.leader_fd_ < 0) counters.leader_fd_ = fd;
+  }
+  if (counters.leader_fd_ < 0) {
+    return absl::UnavailableError(
+        absl::StrCat("perf_event_open failed: ", std::strerror(first_errno)));
+  }
+  return counters;
+#else
+  return absl::UnavailableError(
+      "Performance counters are only supported on Linux");
+#endif  // __linux__
+}
+
+PerfCounters::PerfCounters(PerfCounters &&other)
+    : fds_(other.fds_), leader_fd_(other.leader_fd_) {
+  other.fds_.fill(-1);
+  other.leader_fd_ = -1;
+}
+
+PerfCounters &PerfCounters::operator=(PerfCounters &&other) {
+  if (this != &other) {
+    Close();
+    fds_ = other.fds_;
+    leader_fd_ = other.leader_fd_;
+    other.fds_.fill(-1);
+    other.leader_fd_ = -1;
+  }
+  return *this;
+}
+
+PerfCounters::~PerfCounters() { Close(); }
+
+void PerfCounters::Close() {
+#ifdef __linux__
+  for (int &fd : fds_) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+  }
+#endif  // __linux__
+  leader_fd_ = -1;
+}
+
+void PerfCounters::Start() {
+#ifdef __linux__
+  if (leader_fd_ >= 0) {
+    ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif  // __linux__
+}
+
+void PerfCounters::Stop() {
+#ifdef __linux__
+  if (leader_fd_ >= 0) {
+    ioctl(leader_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif  // __linux__
+}
+
+void PerfCounters::Reset() {
+#ifdef __linux__
+  if (leader_fd_ >= 0) {
+    ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  }
+#endif  // __linux__
+}
+
+std::optional<int64_t> PerfCounters::Count(PerfCounter counter) const {
+#ifdef __linux__
+  int fd = fds_[static_cast<int>(counter)];
+  if (fd < 0) return std::nullopt;
+  // The value, followed by the time enabled and the time running.
+  uint64_t values[3];
+  if (read(fd, values, sizeof(values)) != sizeof(values)) return std::nullopt;
+  // A counter that never ran, e.g. because the kernel never scheduled it, has
+  // no count to scale.
+  if (values[2] == 0) return std::nullopt;
+  if (values[2] == values[1]) return static_cast<int64_t>(values[0]);
+  return static_cast<int64_t>(static_cast<double>(values[0]) * values[1] /
+                              values[2]);
+#else
+  return std::nullopt;
+#endif  // __linux__
+}
+
+std::vector<std::pair<std::string, double>> PerUnitCounts(
+    const PerfCounters &counters, absl::string_view unit, double n_units) {
+  std::vector<std::pair<std::string, double>> per_unit_counts;
+  if (n_units <= 0) return per_unit_counts;
+  for (PerfCounter counter : kAllPerfCounters) {
+    if (std::optional<int64_t> count = counters.Count(counter)) {
+      per_unit_counts.emplace_back(
+          absl::StrCat(PerfCounterName(counter), "_per_", unit),
+          *count / n_units);
+    }
+  }
+  return per_unit_counts;
+}
+
+}  // namespace stroke_model
+}  // namespace ink
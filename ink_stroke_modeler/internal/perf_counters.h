@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_PERF_COUNTERS_H_
+#define INK_STROKE_MODELER_INTERNAL_PERF_COUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace ink {
+namespace stroke_model {
+
+// The hardware events counted by PerfCounters.
+enum class PerfCounter {
+  kCycles,
+  kInstructions,
+  kBranchMisses,
+  kL1DataCacheMisses,
+  kLastLevelCacheMisses,
+};
+
+inline constexpr int kNumPerfCounters = 5;
+
+// Returns a short name for the counter, e.g. "branch_misses".
+absl::string_view PerfCounterName(PerfCounter counter);
+
+// Counts hardware events in user space for the calling thread, using
+// perf_event_open(2), so that benchmarks can tell whether code is bound by
+// compute, branches or memory.
+//
+// The counters are opened as a single group, so that they are all scheduled
+// on the PMU together, and are started and stopped with one system call each.
+// Counters that the CPU or kernel doesn't support are left out of the group.
+class PerfCounters {
+ public:
+  // Opens whichever counters are available. Returns an UnavailableError if
+  // none are, e.g. on platforms other than Linux, when
+  // /proc/sys/kernel/perf_event_paranoid forbids it, or in virtual machines
+  // without a virtual PMU.
+  static absl::StatusOr<PerfCounters> Create();
+
+  PerfCounters(PerfCounters &&other);
+  PerfCounters &operator=(PerfCounters &&other);
+  ~PerfCounters();
+
+  bool IsAvailable(PerfCounter counter) const {
+    return fds_[static_cast<int>(counter)] >= 0;
+  }
+
+  // Starts and stops counting. Counts accumulate over all Start()/Stop()
+  // intervals until Reset() is called. The counters are stopped initially.
+  void Start();
+  void Stop();
+  void Reset();
+
+  // Returns the count accumulated so far, or std::nullopt if the counter is
+  // unavailable, or has never run, e.g. before the first call to Start(). If
+  // the kernel had to multiplex the group with other events, the count is
+  // scaled up to estimate the count over the whole time it was enabled.
+  std::optional<int64_t> Count(PerfCounter counter) const;
+
+ private:
+  PerfCounters() { fds_.fill(-1); }
+
+  void Close();
+
+  // The file descriptors for each counter, or -1 if it is unavailable. The
+  // first available one leads the group.
+  std::array<int, kNumPerfCounters> fds_;
+  int leader_fd_ = -1;
+};
+
+// Returns each available count divided by `n_units`, paired with a name of
+// the form "<counter>_per_<unit>", e.g. {"cycles_per_input", 1234.5}, for
+// reporting as benchmark counters.
+std::vector<std::pair<std::string, double>> PerUnitCounts(
+    const PerfCounters &counters, absl::string_view unit, double n_units);
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_PERF_COUNTERS_H_
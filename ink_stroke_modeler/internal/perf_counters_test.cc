@@ -0,0 +1,108 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/perf_counters.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Pair;
+
+// Does some work that the compiler can't optimize away.
+int64_t Work() {
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) sum = sum + i;
+  return sum;
+}
+
+TEST(PerfCountersTest, CounterNames) {
+  EXPECT_EQ(PerfCounterName(PerfCounter::kCycles), "cycles");
+  EXPECT_EQ(PerfCounterName(PerfCounter::kInstructions), "instructions");
+  EXPECT_EQ(PerfCounterName(PerfCounter::kBranchMisses), "branch_misses");
+  EXPECT_EQ(PerfCounterName(PerfCounter::kL1DataCacheMisses), "l1d_misses");
+  EXPECT_EQ(PerfCounterName(PerfCounter::kLastLevelCacheMisses),
+            "llc_misses");
+}
+
+TEST(PerfCountersTest, CountsOnlyWhileStarted) {
+  absl::StatusOr<PerfCounters> counters = PerfCounters::Create();
+  if (!counters.ok()) {
+    // Counters are commonly unavailable in containers and virtual machines.
+    EXPECT_EQ(counters.status().code(), absl::StatusCode::kUnavailable);
+    GTEST_SKIP() << counters.status();
+  }
+
+  Work();
+  std::optional<PerfCounter> available;
+  for (PerfCounter counter :
+       {PerfCounter::kInstructions, PerfCounter::kCycles,
+        PerfCounter::kBranchMisses, PerfCounter::kL1DataCacheMisses,
+        PerfCounter::kLastLevelCacheMisses}) {
+    // None of the counters has run yet.
+    EXPECT_EQ(counters->Count(counter), std::nullopt);
+    if (counters->IsAvailable(counter) && !available) available = counter;
+  }
+  ASSERT_TRUE(available.has_value());
+
+  counters->Start();
+  Work();
+  counters->Stop();
+  std::optional<int64_t> count = counters->Count(*available);
+  ASSERT_TRUE(count.has_value());
+
+  Work();
+  EXPECT_EQ(counters->Count(*available), count);
+
+  // Moving the counters keeps them open.
+  PerfCounters moved = *std::move(counters);
+  EXPECT_EQ(moved.Count(*available), count);
+
+  // Resetting the counters zeroes the counts, but not the time they've run.
+  moved.Reset();
+  EXPECT_EQ(moved.Count(*available), 0);
+}
+
+TEST(PerfCountersTest, PerUnitCounts) {
+  absl::StatusOr<PerfCounters> counters = PerfCounters::Create();
+  if (!counters.ok()) GTEST_SKIP() << counters.status();
+  if (!counters->IsAvailable(PerfCounter::kInstructions)) {
+    GTEST_SKIP() << "Instructions are not counted";
+  }
+
+  counters->Start();
+  Work();
+  counters->Stop();
+  const double instructions = *counters->Count(PerfCounter::kInstructions);
+  EXPECT_GT(instructions, 100000);
+  EXPECT_THAT(PerUnitCounts(*counters, "input", 4),
+              Contains(Pair("instructions_per_input", instructions / 4)));
+  EXPECT_TRUE(PerUnitCounts(*counters, "input", 0).empty());
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,106 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/polyline_segment_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+// The tolerance used by the pruning tests, relative to the magnitude of the
+// coordinates involved. This is a couple of orders of magnitude larger than the
+// rounding error of the distance and projection computations in
+// `StylusStateModeler`, so that those errors can never cause a pruned segment
+// to be preferred.
+constexpr float kRelativeTolerance = 1e-5;
+
+float Tolerance(const BoundingBox &box, Vec2 point) {
+  return kRelativeTolerance *
+         (std::abs(point.x) + std::abs(point.y) +
+          std::max(std::abs(box.min.x), std::abs(box.max.x)) +
+          std::max(std::abs(box.min.y), std::abs(box.max.y)));
+}
+
+}  // namespace
+
+void PolylineSegmentIndex::Clear() {
+  point_count_ = 0;
+  first_node_offset_ = 0;
+  segment_boxes_.clear();
+  node_boxes_.clear();
+}
+
+void PolylineSegmentIndex::PushBack(Vec2 point) {
+  if (point_count_ > 0) {
+    BoundingBox box = BoundingBox::FromPoints(last_point_, point);
+    if ((first_node_offset_ + SegmentCount()) % kSegmentsPerNode == 0) {
+      node_boxes_.push_back(box);
+    } else {
+      node_boxes_.back().Add(box);
+    }
+    segment_boxes_.push_back(box);
+  }
+  last_point_ = point;
+  ++point_count_;
+}
+
+void PolylineSegmentIndex::PopFront() {
+  --point_count_;
+  if (segment_boxes_.empty()) return;
+
+  segment_boxes_.pop_front();
+  if (segment_boxes_.empty()) {
+    node_boxes_.clear();
+    first_node_offset_ = 0;
+  } else if (++first_node_offset_ == kSegmentsPerNode) {
+    node_boxes_.pop_front();
+    first_node_offset_ = 0;
+  }
+}
+
+bool PolylineSegmentIndex::CanContainPointWithin(const BoundingBox &box,
+                                                 Vec2 point,
+                                                 float max_distance) {
+  float dx = std::max({box.min.x - point.x, 0.f, point.x - box.max.x});
+  float dy = std::max({box.min.y - point.y, 0.f, point.y - box.max.y});
+  // Written so that a NaN anywhere results in the box being kept.
+  return !(std::hypot(dx, dy) - Tolerance(box, point) > max_distance);
+}
+
+bool PolylineSegmentIndex::CanIntersectLine(const BoundingBox &box, Vec2 point,
+                                            Vec2 direction) {
+  auto signed_distance = [point, direction](Vec2 corner) {
+    Vec2 v = corner - point;
+    return (v.x * direction.y - v.y * direction.x) / direction.Magnitude();
+  };
+  float d1 = signed_distance(box.min);
+  float d2 = signed_distance(box.max);
+  float d3 = signed_distance({box.min.x, box.max.y});
+  float d4 = signed_distance({box.max.x, box.min.y});
+  float tolerance = Tolerance(box, point);
+  // As above, a NaN anywhere results in the box being kept.
+  bool all_left = d1 > tolerance && d2 > tolerance && d3 > tolerance &&
+                  d4 > tolerance;
+  bool all_right = d1 < -tolerance && d2 < -tolerance && d3 < -tolerance &&
+                   d4 < -tolerance;
+  return !all_left && !all_right;
+}
+
+}  // namespace stroke_model
+}  // namespace ink
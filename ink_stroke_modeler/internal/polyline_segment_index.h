@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_POLYLINE_SEGMENT_INDEX_H_
+#define INK_STROKE_MODELER_INTERNAL_POLYLINE_SEGMENT_INDEX_H_
+
+#include <algorithm>
+#include <deque>
+
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// An axis-aligned bounding box.
+struct BoundingBox {
+  Vec2 min{0};
+  Vec2 max{0};
+
+  // Returns the smallest box containing both `a` and `b`.
+  static BoundingBox FromPoints(Vec2 a, Vec2 b) {
+    return {.min = {std::min(a.x, b.x), std::min(a.y, b.y)},
+            .max = {std::max(a.x, b.x), std::max(a.y, b.y)}};
+  }
+
+  // Grows the box to contain `other`.
+  void Add(const BoundingBox &other) {
+    min = {std::min(min.x, other.min.x), std::min(min.y, other.min.y)};
+    max = {std::max(max.x, other.max.x), std::max(max.y, other.max.y)};
+  }
+};
+
+// A bounding volume hierarchy over the segments of a polyline that grows at
+// the back and shrinks from the front, as the raw input polyline in
+// `StylusStateModeler` does. This is used to skip segments that cannot contain
+// the result of a projection, without changing which segment is chosen.
+//
+// The hierarchy has two levels: each segment has its own bounding box, and
+// each run of `kSegmentsPerNode` consecutive segments shares a node box. Node
+// boxes are only ever grown, so after segments are removed from the front the
+// first node's box may be larger than necessary; this is conservative, so it
+// never causes a segment to be skipped incorrectly.
+//
+// The pruning tests allow for a small tolerance relative to the magnitude of
+// the coordinates, so that floating-point error in the callers' distance and
+// projection computations can never make a pruned segment a better candidate
+// than one that was visited. As such, visiting segments through this index
+// yields exactly the same result as visiting every segment.
+class PolylineSegmentIndex {
+ public:
+  static constexpr int kSegmentsPerNode = 8;
+
+  // Removes all points from the polyline.
+  void Clear();
+
+  // Appends a point to the end of the polyline, adding a segment if this is
+  // not the first point.
+  void PushBack(Vec2 point);
+
+  // Removes the first point of the polyline, and the segment starting at it
+  // if there is one. The polyline must not be empty.
+  void PopFront();
+
+  // The number of segments in the polyline, i.e. one less than the number of
+  // points, or zero if it is empty.
+  int SegmentCount() const { return segment_boxes_.size(); }
+
+  // Calls `visit(i)` for each segment index `i`, in increasing order, whose
+  // segment may lie within `max_distance()` of `point`. `max_distance` is
+  // re-evaluated before each segment is tested, so that it may shrink as the
+  // caller finds closer segments; it may return infinity to disable pruning.
+  //
+  // Template parameter `MaxDistanceFn` is expected to be callable as
+  // `float()`, and `VisitFn` as `void(int)`.
+  template <typename MaxDistanceFn, typename VisitFn>
+  void VisitSegmentsNear(Vec2 point, MaxDistanceFn max_distance,
+                         VisitFn visit) const {
+    VisitSegments(
+        [point, &max_distance](const BoundingBox &box) {
+          return CanContainPointWithin(box, point, max_distance());
+        },
+        visit);
+  }
+
+  // Like `VisitSegmentsNear()`, but additionally skips segments that cannot
+  // intersect the (infinite) line through `point` in the direction of
+  // `direction`.
+  template <typename MaxDistanceFn, typename VisitFn>
+  void VisitSegmentsNearLine(Vec2 point, Vec2 direction,
+                             MaxDistanceFn max_distance, VisitFn visit) const {
+    VisitSegments(
+        [point, direction, &max_distance](const BoundingBox &box) {
+          return CanIntersectLine(box, point, direction) &&
+                 CanContainPointWithin(box, point, max_distance());
+        },
+        visit);
+  }
+
+ private:
+  // Returns false only if every point in `box` is, with some tolerance,
+  // further than `max_distance` from `point`.
+  static bool CanContainPointWithin(const BoundingBox &box, Vec2 point,
+                                    float max_distance);
+
+  // Returns false only if all of `box` lies, with some tolerance, strictly on
+  // one side of the line through `point` in the direction of `direction`.
+  static bool CanIntersectLine(const BoundingBox &box, Vec2 point,
+                               Vec2 direction);
+
+  template <typename BoxTestFn, typename VisitFn>
+  void VisitSegments(BoxTestFn box_test, VisitFn visit) const {
+    const int n_segments = SegmentCount();
+    int segment = 0;
+    // The first node is missing the `first_node_offset_` segments that have
+    // been removed from the front.
+    int node_end = kSegmentsPerNode - first_node_offset_;
+    for (const BoundingBox &node_box : node_boxes_) {
+      node_end = std::min(node_end, n_segments);
+      if (box_test(node_box)) {
+        for (; segment < node_end; ++segment) {
+          if (box_test(segment_boxes_[segment])) visit(segment);
+        }
+      }
+      segment = node_end;
+      node_end += kSegmentsPerNode;
+    }
+  }
+
+  int point_count_ = 0;
+  Vec2 last_point_{0};
+
+  // The number of segments that have been removed from the front of the first
+  // node, in the range [0, kSegmentsPerNode).
+  int first_node_offset_ = 0;
+
+  std::deque<BoundingBox> segment_boxes_;
+  std::deque<BoundingBox> node_boxes_;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_POLYLINE_SEGMENT_INDEX_H_
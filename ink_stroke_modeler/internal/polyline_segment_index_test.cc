@@ -0,0 +1,239 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/polyline_segment_index.h"
+
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink_stroke_modeler/internal/utils.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+std::vector<int> VisitAllNear(const PolylineSegmentIndex &index, Vec2 point,
+                              float max_distance) {
+  std::vector<int> visited;
+  index.VisitSegmentsNear(
+      point, [max_distance]() { return max_distance; },
+      [&visited](int i) { visited.push_back(i); });
+  return visited;
+}
+
+struct Projection {
+  int segment = -1;
+  float ratio = 0;
+
+  bool operator==(const Projection &other) const {
+    return segment == other.segment && ratio == other.ratio;
+  }
+};
+
+// These mirror the closest-point search in StylusStateModeler, with and
+// without the index.
+Projection BruteForceClosest(const std::deque<Vec2> &polyline, Vec2 point) {
+  Projection best;
+  float min_distance = kInfinity;
+  for (int i = 0; i + 1 < static_cast<int>(polyline.size()); ++i) {
+    float ratio = NearestPointOnSegment(polyline[i], polyline[i + 1], point);
+    float distance =
+        Distance(point, Interp(polyline[i], polyline[i + 1], ratio));
+    if (distance <= min_distance) {
+      best = {.segment = i, .ratio = ratio};
+      min_distance = distance;
+    }
+  }
+  return best;
+}
+
+Projection IndexedClosest(const std::deque<Vec2> &polyline,
+                          const PolylineSegmentIndex &index, Vec2 point) {
+  Projection best;
+  float min_distance = kInfinity;
+  index.VisitSegmentsNear(
+      point, [&min_distance]() { return min_distance; },
+      [&](int i) {
+        float ratio =
+            NearestPointOnSegment(polyline[i], polyline[i + 1], point);
+        float distance =
+            Distance(point, Interp(polyline[i], polyline[i + 1], ratio));
+        if (distance <= min_distance) {
+          best = {.segment = i, .ratio = ratio};
+          min_distance = distance;
+        }
+      });
+  return best;
+}
+
+// These mirror the search for the closest intersection with the stroke normal
+// in StylusStateModeler, ignoring the left/right distinction.
+Projection BruteForceAlongNormal(const std::deque<Vec2> &polyline, Vec2 point,
+                                 Vec2 normal) {
+  Projection best;
+  float min_distance = kInfinity;
+  for (int i = 0; i + 1 < static_cast<int>(polyline.size()); ++i) {
+    std::optional<float> ratio = ProjectToSegmentAlongNormal(
+        polyline[i], polyline[i + 1], point, normal);
+    if (!ratio.has_value()) continue;
+    float distance =
+        Distance(point, Interp(polyline[i], polyline[i + 1], *ratio));
+    if (distance < min_distance) {
+      best = {.segment = i, .ratio = *ratio};
+      min_distance = distance;
+    }
+  }
+  return best;
+}
+
+Projection IndexedAlongNormal(const std::deque<Vec2> &polyline,
+                              const PolylineSegmentIndex &index, Vec2 point,
+                              Vec2 normal) {
+  Projection best;
+  float min_distance = kInfinity;
+  index.VisitSegmentsNearLine(
+      point, normal, [&min_distance]() { return min_distance; },
+      [&](int i) {
+        std::optional<float> ratio = ProjectToSegmentAlongNormal(
+            polyline[i], polyline[i + 1], point, normal);
+        if (!ratio.has_value()) return;
+        float distance =
+            Distance(point, Interp(polyline[i], polyline[i + 1], *ratio));
+        if (distance < min_distance) {
+          best = {.segment = i, .ratio = *ratio};
+          min_distance = distance;
+        }
+      });
+  return best;
+}
+
+TEST(PolylineSegmentIndexTest, EmptyAndSinglePoint) {
+  PolylineSegmentIndex index;
+  EXPECT_EQ(index.SegmentCount(), 0);
+  EXPECT_THAT(VisitAllNear(index, {0, 0}, kInfinity), IsEmpty());
+
+  index.PushBack({1, 1});
+  EXPECT_EQ(index.SegmentCount(), 0);
+  EXPECT_THAT(VisitAllNear(index, {0, 0}, kInfinity), IsEmpty());
+
+  index.PopFront();
+  index.PushBack({2, 2});
+  EXPECT_EQ(index.SegmentCount(), 0);
+}
+
+TEST(PolylineSegmentIndexTest, PushAndPopSegments) {
+  PolylineSegmentIndex index;
+  for (int i = 0; i < 20; ++i) index.PushBack({static_cast<float>(i), 0});
+  EXPECT_EQ(index.SegmentCount(), 19);
+
+  index.PopFront();
+  index.PopFront();
+  index.PopFront();
+  EXPECT_EQ(index.SegmentCount(), 16);
+
+  // Segment i now runs from (i + 3, 0) to (i + 4, 0).
+  EXPECT_THAT(VisitAllNear(index, {10.5, .5}, .6), ElementsAre(7));
+  EXPECT_THAT(VisitAllNear(index, {10, -.5}, .6), ElementsAre(6, 7));
+  EXPECT_THAT(VisitAllNear(index, {100, 100}, 1), IsEmpty());
+  EXPECT_EQ(VisitAllNear(index, {100, 100}, kInfinity).size(), 16);
+
+  for (int i = 0; i < 16; ++i) index.PopFront();
+  EXPECT_EQ(index.SegmentCount(), 0);
+  index.PushBack({0, 5});
+  EXPECT_EQ(index.SegmentCount(), 1);
+  EXPECT_THAT(VisitAllNear(index, {18.5, 2.5}, .1), ElementsAre(0));
+}
+
+TEST(PolylineSegmentIndexTest, Clear) {
+  PolylineSegmentIndex index;
+  index.PushBack({0, 0});
+  index.PushBack({1, 0});
+  index.Clear();
+  EXPECT_EQ(index.SegmentCount(), 0);
+  index.PushBack({5, 5});
+  EXPECT_EQ(index.SegmentCount(), 0);
+  index.PushBack({6, 5});
+  EXPECT_THAT(VisitAllNear(index, {5.5, 5}, .1), ElementsAre(0));
+}
+
+TEST(PolylineSegmentIndexTest, VisitSegmentsNearLineSkipsSegmentsOffTheLine) {
+  PolylineSegmentIndex index;
+  index.PushBack({0, 0});
+  index.PushBack({1, 0});
+  index.PushBack({1, 1});
+  index.PushBack({3, 1});
+
+  std::vector<int> visited;
+  index.VisitSegmentsNearLine(
+      {.5, 3}, {0, 1}, []() { return kInfinity; },
+      [&visited](int i) { visited.push_back(i); });
+  EXPECT_THAT(visited, ElementsAre(0));
+}
+
+// Builds tight, overlapping loops with noise, adding and removing points as the
+// StylusStateModeler does, and checks that the indexed searches always find the
+// same segment and ratio as the brute force searches.
+TEST(PolylineSegmentIndexTest, MatchesBruteForceOnLoopingStroke) {
+  std::mt19937 rng(12345);
+  std::uniform_real_distribution<float> noise(-.05, .05);
+  std::uniform_real_distribution<float> query_offset(-2, 2);
+  std::uniform_real_distribution<float> angle(0, 6.3);
+
+  std::deque<Vec2> polyline;
+  PolylineSegmentIndex index;
+  constexpr int kMaxPoints = 60;
+  for (int step = 0; step < 2000; ++step) {
+    float t = step * .3f;
+    Vec2 point{1000 + std::cos(t) + .01f * t + noise(rng),
+               -500 + std::sin(t) + noise(rng)};
+    // Occasionally repeat a point, producing a degenerate segment.
+    if (step % 17 == 0 && !polyline.empty()) point = polyline.back();
+    polyline.push_back(point);
+    index.PushBack(point);
+    while (static_cast<int>(polyline.size()) > kMaxPoints) {
+      polyline.pop_front();
+      index.PopFront();
+    }
+    ASSERT_EQ(index.SegmentCount(), static_cast<int>(polyline.size()) - 1);
+
+    for (int q = 0; q < 5; ++q) {
+      Vec2 query = point + Vec2{query_offset(rng), query_offset(rng)};
+      // Occasionally query exactly on a vertex, to exercise ties.
+      if (q == 0) query = polyline[polyline.size() / 2];
+      EXPECT_EQ(IndexedClosest(polyline, index, query),
+                BruteForceClosest(polyline, query));
+
+      float a = angle(rng);
+      Vec2 normal{std::cos(a), std::sin(a)};
+      EXPECT_EQ(IndexedAlongNormal(polyline, index, query, normal),
+                BruteForceAlongNormal(polyline, query, normal));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
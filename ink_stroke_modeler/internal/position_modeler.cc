@@ -17,7 +17,7 @@ namespace stroke_model {
 absl::StatusOr<int> NumberOfStepsBetweenInputs(
     const TipState& tip_state, const Input& start, const Input& end,
     const SamplingParams& sampling_params,
-    const PositionModelerParams& position_modeler_params) {
+    const PositionModelerParams& position_modeler_params, int max_steps) {
   Duration delta_t = end.time - start.time;
   float float_delta = delta_t.Value();
   int n_steps =
@@ -44,15 +44,27 @@ absl::StatusOr<int> NumberOfStepsBetweenInputs(
       n_steps = steps_for_angle;
     }
   }
-  if (n_steps > sampling_params.max_outputs_per_call) {
+  if (n_steps > max_steps) {
     return absl::InvalidArgumentError(absl::Substitute(
         "Input events are too far apart; requested $0 > $1 samples.", n_steps,
-        sampling_params.max_outputs_per_call));
+        max_steps));
   }
   return n_steps;
 }
 
+absl::StatusOr<int> NumberOfStepsBetweenInputs(
+    const TipState& tip_state, const Input& start, const Input& end,
+    const SamplingParams& sampling_params,
+    const PositionModelerParams& position_modeler_params) {
+  return NumberOfStepsBetweenInputs(tip_state, start, end, sampling_params,
+                                    position_modeler_params,
+                                    sampling_params.max_outputs_per_call);
+}
+
 TipState PositionModeler::Update(Vec2 anchor_position, Time time) {
+  if (params_.integrator == PositionModelerParams::Integrator::kExact) {
+    return UpdateExact(anchor_position, anchor_position, time);
+  }
   Duration delta_time = time - state_.time;
   state_.acceleration =
       ((anchor_position - state_.position) / params_.spring_mass_constant -
@@ -64,5 +76,106 @@ TipState PositionModeler::Update(Vec2 anchor_position, Time time) {
   return state_;
 }
 
+TipState PositionModeler::UpdateExact(Vec2 start_anchor_position,
+                                      Vec2 end_anchor_position, Time time) {
+  state_ =
+      ExactSolution(state_, start_anchor_position, end_anchor_position, time);
+  return state_;
+}
+
+TipState PositionModeler::ExactSolution(const TipState& start,
+                                        Vec2 start_anchor_position,
+                                        Vec2 end_anchor_position,
+                                        Time time) const {
+  // Each axis follows x'' + d x' + x / k = a(t) / k, where k is the spring
+  // mass constant, d is the drag constant, and a(t) is the anchor position,
+  // which moves at a constant speed a'. The solution is the sum of the
+  // particular solution p(t) = a(t) - d k a', which trails the anchor at a
+  // fixed distance, and the solution e(t) of the homogeneous equation, which
+  // is a damped oscillation about p(t).
+  const double dt = (time - start.time).Value();
+  const double k = params_.spring_mass_constant;
+  const double d = params_.drag_constant;
+  const double half_drag = .5 * d;
+  const double natural_freq_sq = 1 / k;
+  const double damped_freq_sq = natural_freq_sq - half_drag * half_drag;
+
+  // For the homogeneous solution, with e0 = e(0) and e0' = e'(0):
+  //   e(dt)  = decay_cos * e0 + decay_sin * (half_drag * e0 + e0')
+  //   e'(dt) = decay_cos * e0' - decay_sin * (half_drag * e0' +
+  //                                           natural_freq_sq * e0)
+  // where decay_cos and decay_sin depend on whether the spring is under- or
+  // over-damped.
+  double decay_cos;
+  double decay_sin;
+  if (std::abs(damped_freq_sq) * dt * dt < 1e-6) {
+    // Close enough to critically damped that the Taylor series is accurate.
+    double decay = std::exp(-half_drag * dt);
+    decay_cos = decay * (1 - .5 * damped_freq_sq * dt * dt);
+    decay_sin = decay * dt * (1 - damped_freq_sq * dt * dt / 6);
+  } else if (damped_freq_sq > 0) {
+    double decay = std::exp(-half_drag * dt);
+    double freq = std::sqrt(damped_freq_sq);
+    decay_cos = decay * std::cos(freq * dt);
+    decay_sin = decay * std::sin(freq * dt) / freq;
+  } else {
+    // Expand cosh and sinh, as they may overflow for large time steps even
+    // though the product with the decay doesn't.
+    double rate = std::sqrt(-damped_freq_sq);
+    double slow = std::exp((rate - half_drag) * dt);
+    double fast = std::exp((-rate - half_drag) * dt);
+    decay_cos = .5 * (slow + fast);
+    decay_sin = .5 * (slow - fast) / rate;
+  }
+
+  auto solve_axis = [&](double start_anchor, double end_anchor,
+                        float& position, float& velocity) {
+    double anchor_velocity = dt > 0 ? (end_anchor - start_anchor) / dt : 0;
+    double trail = d * k * anchor_velocity;
+    double e0 = position - (start_anchor - trail);
+    double e0_prime = velocity - anchor_velocity;
+    double e = decay_cos * e0 + decay_sin * (half_drag * e0 + e0_prime);
+    double e_prime =
+        decay_cos * e0_prime -
+        decay_sin * (half_drag * e0_prime + natural_freq_sq * e0);
+    position = end_anchor - trail + e;
+    velocity = anchor_velocity + e_prime;
+  };
+  TipState state = start;
+  solve_axis(start_anchor_position.x, end_anchor_position.x, state.position.x,
+             state.velocity.x);
+  solve_axis(start_anchor_position.y, end_anchor_position.y, state.position.y,
+             state.velocity.y);
+  state.acceleration =
+      (end_anchor_position - state.position) / params_.spring_mass_constant -
+      params_.drag_constant * state.velocity;
+  state.time = time;
+  return state;
+}
+
+TipState PositionModeler::ExactClosestApproach(const TipState& start,
+                                               Vec2 anchor_position,
+                                               Duration lower_bound,
+                                               Duration upper_bound) const {
+  // The distance to the anchor is decreasing at `lower_bound` and increasing
+  // at `upper_bound`, so the closest approach lies between them. The rate of
+  // approach has no closed-form root, so we bisect until the bracket is
+  // negligible compared to the output interval.
+  const Duration tolerance = (upper_bound - lower_bound) * 1e-4;
+  while (upper_bound - lower_bound > tolerance) {
+    Duration mid = .5 * (lower_bound + upper_bound);
+    TipState state = ExactSolution(start, anchor_position, anchor_position,
+                                   start.time + mid);
+    if (Vec2::DotProduct(state.position - anchor_position, state.velocity) <
+        0) {
+      lower_bound = mid;
+    } else {
+      upper_bound = mid;
+    }
+  }
+  return ExactSolution(start, anchor_position, anchor_position,
+                       start.time + .5 * (lower_bound + upper_bound));
+}
+
 }  // namespace stroke_model
 }  // namespace ink
@@ -29,7 +29,13 @@ namespace ink {
 namespace stroke_model {
 
 // Returns the number of input steps to be interpolated (and therefore the
-// number of outputs to be modeled) between two inputs.
+// number of outputs to be modeled) between two inputs. Returns an error if
+// that's more than `max_steps`, which defaults to
+// `sampling_params.max_outputs_per_call`.
+absl::StatusOr<int> NumberOfStepsBetweenInputs(
+    const TipState& tip_state, const Input& start, const Input& end,
+    const SamplingParams& sampling_params,
+    const PositionModelerParams& position_modeler_params, int max_steps);
 absl::StatusOr<int> NumberOfStepsBetweenInputs(
     const TipState& tip_state, const Input& start, const Input& end,
     const SamplingParams& sampling_params,
@@ -47,7 +53,8 @@ class PositionModeler {
   }
 
   // Given the position of the anchor and the time, updates the model and
-  // returns the new state of the pen tip.
+  // returns the new state of the pen tip. The anchor is treated as having been
+  // at `anchor_position` since the last update.
   TipState Update(Vec2 anchor_position, Time time);
 
   const TipState& CurrentState() const { return state_; }
@@ -70,12 +77,34 @@ class PositionModeler {
   void UpdateAlongLinearPath(Vec2 start_anchor_position, Time start_time,
                              Vec2 end_anchor_position, Time end_time,
                              int n_samples, OutputIt output) {
-    for (int i = 1; i <= n_samples; ++i) {
+    UpdateAlongLinearPath(start_anchor_position, start_time,
+                          end_anchor_position, end_time, n_samples, 1,
+                          n_samples, output);
+  }
+
+  // Like the above, but only models samples `first_sample` through
+  // `last_sample` (inclusive) of the `n_samples`. This allows the path to be
+  // modeled over several calls; the result is the same as modeling it in one.
+  template <typename OutputIt>
+  void UpdateAlongLinearPath(Vec2 start_anchor_position, Time start_time,
+                             Vec2 end_anchor_position, Time end_time,
+                             int n_samples, int first_sample, int last_sample,
+                             OutputIt output) {
+    for (int i = first_sample; i <= last_sample; ++i) {
       float interp_value = static_cast<float>(i) / n_samples;
       Vec2 position =
           Interp(start_anchor_position, end_anchor_position, interp_value);
       Time time = Interp(start_time, end_time, interp_value);
-      *output++ = Update(position, time);
+      if (params_.integrator == PositionModelerParams::Integrator::kExact) {
+        // The exact integrator accounts for the anchor moving during the
+        // step, so the result doesn't depend on n_samples.
+        *output++ = UpdateExact(
+            Interp(start_anchor_position, end_anchor_position,
+                   static_cast<float>(i - 1) / n_samples),
+            position, time);
+      } else {
+        *output++ = Update(position, time);
+      }
     }
   }
 
@@ -91,12 +120,20 @@ class PositionModeler {
   // - The distance between the previous state and the current state is less
   //   than stop_distance
   //
+  // With the exact integrator, it instead solves for the closest point to the
+  // anchor; see ModelEndOfStrokeExact().
+  //
   // Template parameter OutputIt is expected to be an output iterator over
   // TipState.
   template <typename OutputIt>
   void ModelEndOfStroke(Vec2 anchor_position, Duration delta_time,
                         int max_iterations, float stop_distance,
                         OutputIt output) {
+    if (params_.integrator == PositionModelerParams::Integrator::kExact) {
+      ModelEndOfStrokeExact(anchor_position, delta_time, max_iterations,
+                            stop_distance, output);
+      return;
+    }
     for (int i = 0; i < max_iterations; ++i) {
       // The call to Update modifies the state, so we store a copy of the
       // previous state so we can retry with a smaller step if necessary.
@@ -137,7 +174,73 @@ class PositionModeler {
     if (saved_state_.has_value()) state_ = *saved_state_;
   }
 
+  // Copies the current state and parameters of `other`, but not its saved
+  // state. See comment on StrokeModeler::ModelHypothetical() for more details.
+  void CopyStateFrom(const PositionModeler& other) {
+    params_ = other.params_;
+    state_ = other.state_;
+  }
+
  private:
+  // Like ModelEndOfStroke(), but for the exact integrator. Rather than
+  // stepping past the anchor and retrying with smaller steps, this samples the
+  // closed-form trajectory every `delta_time` until it starts moving away from
+  // the anchor, and then solves for the point of closest approach. It outputs
+  // at most `max_iterations` states, and never discards any.
+  template <typename OutputIt>
+  void ModelEndOfStrokeExact(Vec2 anchor_position, Duration delta_time,
+                             int max_iterations, float stop_distance,
+                             OutputIt output) {
+    const TipState start = state_;
+    if (Vec2::DotProduct(start.position - anchor_position, start.velocity) >
+        0) {
+      // We're already moving away from the anchor.
+      return;
+    }
+    for (int i = 1; i <= max_iterations; ++i) {
+      TipState candidate = ExactSolution(start, anchor_position,
+                                         anchor_position,
+                                         start.time + delta_time * i);
+      bool passed_anchor =
+          Vec2::DotProduct(candidate.position - anchor_position,
+                           candidate.velocity) >= 0;
+      if (passed_anchor) {
+        candidate = ExactClosestApproach(start, anchor_position,
+                                         delta_time * (i - 1), delta_time * i);
+      }
+      if (Distance(state_.position, candidate.position) < stop_distance) {
+        // We're no longer making any significant progress.
+        return;
+      }
+      state_ = candidate;
+      *output++ = candidate;
+      if (passed_anchor ||
+          Distance(candidate.position, anchor_position) < stop_distance) {
+        return;
+      }
+    }
+  }
+
+  // Advances the model to `time` using the closed-form solution of the
+  // spring-damper, with the anchor moving linearly from
+  // `start_anchor_position` at the current time to `end_anchor_position` at
+  // `time`.
+  TipState UpdateExact(Vec2 start_anchor_position, Vec2 end_anchor_position,
+                       Time time);
+
+  // Returns the state that UpdateExact() would reach from `start`, without
+  // modifying the model.
+  TipState ExactSolution(const TipState& start, Vec2 start_anchor_position,
+                         Vec2 end_anchor_position, Time time) const;
+
+  // Returns the state at which the pen tip, starting from `start` and pulled
+  // toward the stationary `anchor_position`, is closest to the anchor, given
+  // that this happens between `lower_bound` and `upper_bound` after
+  // `start.time`.
+  TipState ExactClosestApproach(const TipState& start, Vec2 anchor_position,
+                                Duration lower_bound,
+                                Duration upper_bound) const;
+
   PositionModelerParams params_;
   TipState state_;
   std::optional<TipState> saved_state_;
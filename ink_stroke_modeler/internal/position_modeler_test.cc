@@ -17,6 +17,7 @@
 #include <cmath>
 #include <iterator>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -597,6 +598,128 @@ TEST(PositionModelerTest, SaveAndRestore) {
                            kTol));
 }
 
+TEST(PositionModelerTest, ExactIntegratorMatchesFineEulerSteps) {
+  PositionModelerParams euler_params;
+  PositionModelerParams exact_params{
+      .integrator = PositionModelerParams::Integrator::kExact};
+  for (float drag : {72.f, 2 * std::sqrt(32400.f / 11), 500.f}) {
+    // Under-, critically, and over-damped.
+    euler_params.drag_constant = drag;
+    exact_params.drag_constant = drag;
+    PositionModeler euler_modeler;
+    PositionModeler exact_modeler;
+    TipState start{.position = {1, 2}, .velocity = {30, -10}, .time = Time(0)};
+    euler_modeler.Reset(start, euler_params);
+    exact_modeler.Reset(start, exact_params);
+
+    std::vector<TipState> euler_result;
+    std::vector<TipState> exact_result;
+    euler_modeler.UpdateAlongLinearPath(
+        {1, 2}, Time(0), {4, 3}, Time(.05), 50000,
+        std::back_inserter(euler_result));
+    exact_modeler.UpdateAlongLinearPath({1, 2}, Time(0), {4, 3}, Time(.05), 1,
+                                        std::back_inserter(exact_result));
+    ASSERT_EQ(exact_result.size(), 1);
+    EXPECT_THAT(exact_result.back().position,
+                Vec2Near(euler_result.back().position, .001))
+        << "drag = " << drag;
+    EXPECT_THAT(exact_result.back().velocity,
+                Vec2Near(euler_result.back().velocity, .05))
+        << "drag = " << drag;
+  }
+}
+
+TEST(PositionModelerTest, ExactIntegratorDoesNotDependOnSampleCount) {
+  PositionModelerParams params{
+      .integrator = PositionModelerParams::Integrator::kExact};
+  PositionModeler coarse_modeler;
+  PositionModeler fine_modeler;
+  TipState start{.position = {5, 10}, .time = Time(3)};
+  coarse_modeler.Reset(start, params);
+  fine_modeler.Reset(start, params);
+
+  std::vector<TipState> coarse_result;
+  std::vector<TipState> fine_result;
+  coarse_modeler.UpdateAlongLinearPath({5, 10}, Time(3), {15, 10}, Time(3.05),
+                                       2, std::back_inserter(coarse_result));
+  fine_modeler.UpdateAlongLinearPath({5, 10}, Time(3), {15, 10}, Time(3.05),
+                                     10, std::back_inserter(fine_result));
+  ASSERT_EQ(coarse_result.size(), 2);
+  ASSERT_EQ(fine_result.size(), 10);
+  for (auto [coarse, fine] :
+       {std::pair(coarse_result[0], fine_result[4]),
+        std::pair(coarse_result[1], fine_result[9])}) {
+    EXPECT_THAT(coarse.position, Vec2Near(fine.position, kTol));
+    EXPECT_THAT(coarse.velocity, Vec2Near(fine.velocity, kTol));
+    EXPECT_THAT(coarse.time, TimeNear(fine.time, kTol));
+  }
+}
+
+TEST(PositionModelerTest, ExactIntegratorIsStableForLongSteps) {
+  PositionModeler modeler;
+  modeler.Reset({.position = {0, 0}, .time = Time(0)},
+                {.integrator = PositionModelerParams::Integrator::kExact});
+  // A single step this long would diverge with semi-implicit Euler; the exact
+  // solution settles at the anchor.
+  EXPECT_THAT(modeler.Update({3, 4}, Time(1)),
+              TipStateNear({.position = {3, 4}, .time = Time(1)}, kTol));
+}
+
+TEST(PositionModelerTest, ExactModelEndOfStrokeMatchesTrialStepping) {
+  struct TestCase {
+    TipState start;
+    Vec2 anchor;
+    Duration delta_time;
+  };
+  for (const TestCase& test_case :
+       {TestCase{{.position = {4, -2}}, {3, -1}, Duration(1. / 180)},
+        TestCase{{.position = {-1, 2}, .velocity = {40, 10}, .time = Time(1)},
+                 {7, 2},
+                 Duration(1. / 120)}}) {
+    PositionModeler euler_modeler;
+    PositionModeler exact_modeler;
+    euler_modeler.Reset(test_case.start, PositionModelerParams());
+    exact_modeler.Reset(
+        test_case.start,
+        {.integrator = PositionModelerParams::Integrator::kExact});
+
+    std::vector<TipState> euler_result;
+    std::vector<TipState> exact_result;
+    euler_modeler.ModelEndOfStroke(test_case.anchor, test_case.delta_time, 20,
+                                   .01, std::back_inserter(euler_result));
+    exact_modeler.ModelEndOfStroke(test_case.anchor, test_case.delta_time, 20,
+                                   .01, std::back_inserter(exact_result));
+    ASSERT_FALSE(euler_result.empty());
+    ASSERT_FALSE(exact_result.empty());
+    EXPECT_LE(exact_result.size(), 20);
+
+    // The intermediate states differ, because the Euler integrator isn't
+    // exact, but both stop at about the same place and time.
+    EXPECT_THAT(exact_result.back().position,
+                Vec2Near(euler_result.back().position, .05));
+    EXPECT_THAT(exact_result.back().time,
+                TimeNear(euler_result.back().time,
+                         test_case.delta_time.Value()));
+
+    // The exact result stops at the closest approach to the anchor, where the
+    // tip is either at the anchor or moving perpendicular to it.
+    const TipState& last = exact_result.back();
+    EXPECT_NEAR(
+        Vec2::DotProduct(last.position - test_case.anchor, last.velocity), 0,
+        1e-3);
+  }
+}
+
+TEST(PositionModelerTest, ExactModelEndOfStrokeMovingAway) {
+  PositionModeler modeler;
+  modeler.Reset({.position = {1, 0}, .velocity = {5, 0}},
+                {.integrator = PositionModelerParams::Integrator::kExact});
+  std::vector<TipState> result;
+  modeler.ModelEndOfStroke({0, 0}, Duration(1. / 180), 20, .01,
+                           std::back_inserter(result));
+  EXPECT_THAT(result, ::testing::IsEmpty());
+}
+
 TEST(NumberOfStepsBetweenInputsTest, ResolutionIsSufficient) {
   absl::StatusOr<int> n_steps = NumberOfStepsBetweenInputs(
       TipState{}, Input{.position = {0, 0}, .time = Time{0}},
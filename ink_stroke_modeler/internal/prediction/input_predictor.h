@@ -18,6 +18,7 @@
 #define INK_STROKE_MODELER_INTERNAL_PREDICTION_INPUT_PREDICTOR_H_
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "ink_stroke_modeler/internal/internal_types.h"
@@ -51,6 +52,25 @@ class InputPredictor {
   virtual void ConstructPrediction(const TipState& last_state,
                                    std::vector<TipState>& prediction) const = 0;
 
+  // Like the above, but overrides the extent and resolution of the prediction:
+  // no state in the prediction may be later than `horizon` after the given
+  // state, and the states should be spaced approximately `sample_spacing`
+  // apart, instead of conforming to SamplingParams::min_output_rate.
+  // `sample_spacing` must be greater than zero.
+  virtual void ConstructPrediction(const TipState& last_state, Duration horizon,
+                                   Duration sample_spacing,
+                                   std::vector<TipState>& prediction) const = 0;
+
+  // Returns the state of the prediction that ConstructPrediction() would
+  // construct for the given last_state, at the given time, without
+  // constructing the rest of the prediction. The time is clamped to the range
+  // of the prediction: if it's before the first predicted state, last_state is
+  // returned, and if it's after the last predicted state, the last predicted
+  // state is returned. Returns std::nullopt if ConstructPrediction() would
+  // construct an empty prediction.
+  virtual std::optional<TipState> PredictAt(const TipState& last_state,
+                                            Time time) const = 0;
+
   // Returns a copy of the predictor, including any dynamic state.
   virtual std::unique_ptr<InputPredictor> MakeCopy() const = 0;
 };
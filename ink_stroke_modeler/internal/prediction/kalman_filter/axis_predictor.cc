@@ -66,6 +66,10 @@ bool AxisPredictor::Stable() const { return kalman_filter_.Stable(); }
 
 void AxisPredictor::Reset() { kalman_filter_.Reset(); }
 
+void AxisPredictor::ResetKeepingErrorCovariance(int warm_stable_iteration) {
+  kalman_filter_.ResetKeepingErrorCovariance(warm_stable_iteration);
+}
+
 void AxisPredictor::Update(double observation) {
   kalman_filter_.Update(observation);
 }
@@ -39,6 +39,11 @@ class AxisPredictor {
   // Reset the underlying Kalman filter.
   void Reset();
 
+  // Reset the state of the underlying Kalman filter, keeping its error
+  // covariance if it has converged. See
+  // KalmanFilter::ResetKeepingErrorCovariance().
+  void ResetKeepingErrorCovariance(int warm_stable_iteration);
+
   // Update the predictor with a new observation.
   void Update(double observation);
 
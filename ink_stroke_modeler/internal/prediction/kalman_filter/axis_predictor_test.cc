@@ -61,6 +61,50 @@ TEST(AxisPredictorTest, ShouldStable) {
   EXPECT_TRUE(predictor.Stable());
 }
 
+// Test that the predictor becomes stable sooner if it keeps the error
+// covariance from a previous sequence of observations.
+TEST(AxisPredictorTest, ShouldStableSoonerWhenKeepingErrorCovariance) {
+  constexpr int kWarmStableIterNum = 2;
+  AxisPredictor predictor(kProcessNoise, kMeasurementNoise, kStableIterNum);
+
+  // There's no converged error covariance to keep yet.
+  predictor.ResetKeepingErrorCovariance(kWarmStableIterNum);
+  for (int i = 0; i < kStableIterNum; i++) {
+    EXPECT_FALSE(predictor.Stable());
+    predictor.Update(i);
+  }
+  EXPECT_TRUE(predictor.Stable());
+
+  predictor.ResetKeepingErrorCovariance(kWarmStableIterNum);
+  EXPECT_EQ(predictor.NumIterations(), 0);
+  EXPECT_EQ(predictor.GetPosition(), 0);
+  for (int i = 0; i < kWarmStableIterNum; i++) {
+    EXPECT_FALSE(predictor.Stable());
+    predictor.Update(10 + i);
+  }
+  EXPECT_TRUE(predictor.Stable());
+
+  // The converged error covariance is kept even if the previous sequence of
+  // observations was short.
+  predictor.ResetKeepingErrorCovariance(kWarmStableIterNum);
+  predictor.Update(1);
+  predictor.ResetKeepingErrorCovariance(kWarmStableIterNum);
+  for (int i = 0; i < kWarmStableIterNum; i++) {
+    EXPECT_FALSE(predictor.Stable());
+    predictor.Update(i);
+  }
+  EXPECT_TRUE(predictor.Stable());
+
+  // A full reset discards it.
+  predictor.Reset();
+  predictor.ResetKeepingErrorCovariance(kWarmStableIterNum);
+  for (int i = 0; i < kStableIterNum; i++) {
+    EXPECT_FALSE(predictor.Stable());
+    predictor.Update(i);
+  }
+  EXPECT_TRUE(predictor.Stable());
+}
+
 // Test the kalman filter behavior. The data set is generated by a "known to
 // work" kalman filter.
 TEST(AxisPredictorTest, PredictedValue) {
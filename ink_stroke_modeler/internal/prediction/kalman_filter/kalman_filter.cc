@@ -14,6 +14,8 @@
 
 #include "ink_stroke_modeler/internal/prediction/kalman_filter/kalman_filter.h"
 
+#include <algorithm>
+
 #include "ink_stroke_modeler/internal/prediction/kalman_filter/matrix.h"
 
 namespace ink {
@@ -29,6 +31,7 @@ KalmanFilter::KalmanFilter(const Matrix4& state_transition,
       measurement_vector_(measurement_vector),
       measurement_noise_variance_(measurement_noise_variance),
       min_stable_iteration_(min_stable_iteration),
+      stable_iteration_(min_stable_iteration),
       iter_num_(0) {}
 
 void KalmanFilter::Predict() {
@@ -72,6 +75,19 @@ void KalmanFilter::Update(double observation) {
 void KalmanFilter::Reset() {
   state_estimation_ = {0, 0, 0, 0};
   error_covariance_matrix_ = Matrix4();  // identity
+  stable_iteration_ = min_stable_iteration_;
+  has_converged_ = false;
+  iter_num_ = 0;
+}
+
+void KalmanFilter::ResetKeepingErrorCovariance(int warm_stable_iteration) {
+  if (Stable()) has_converged_ = true;
+  if (!has_converged_) {
+    Reset();
+    return;
+  }
+  state_estimation_ = {0, 0, 0, 0};
+  stable_iteration_ = std::min(min_stable_iteration_, warm_stable_iteration);
   iter_num_ = 0;
 }
 
@@ -36,13 +36,25 @@ class KalmanFilter {
 
   // Will return true only if the Kalman filter has seen enough data and is
   // considered as stable.
-  bool Stable() const { return iter_num_ >= min_stable_iteration_; }
+  bool Stable() const { return iter_num_ >= stable_iteration_; }
 
   // Update the observation of the system.
   void Update(double observation);
 
   void Reset();
 
+  // Resets the state estimation, but keeps the error covariance if the filter
+  // has become stable since the last call to Reset(). In that case, the filter
+  // is considered stable again after `warm_stable_iteration` iterations (or
+  // `min_stable_iteration`, if that is smaller). Otherwise, this is equivalent
+  // to Reset().
+  //
+  // The error covariance depends only on the model and the number of
+  // iterations, not on the observations, so once the filter is stable it is
+  // close to its converged value, and can be reused for a new sequence of
+  // observations.
+  void ResetKeepingErrorCovariance(int warm_stable_iteration);
+
   // Returns the number of times Update() has been called since the last time
   // the KalmanFilter was reset.
   int NumIterations() const { return iter_num_; }
@@ -86,6 +98,15 @@ class KalmanFilter {
   // to make a good estimate of the state.
   int min_stable_iteration_;
 
+  // The number of iterations after which the filter is currently considered
+  // stable. This is `min_stable_iteration_`, unless the error covariance was
+  // kept from a previous sequence of observations.
+  int stable_iteration_;
+
+  // Whether the error covariance has converged, i.e. whether the filter has
+  // become stable since the last call to Reset().
+  bool has_converged_ = false;
+
   // Tracks the number of update iterations that have occurred.
   int iter_num_;
 };
@@ -16,7 +16,6 @@
 
 #include <algorithm>
 #include <cmath>
-#include <cstddef>
 #include <limits>
 #include <optional>
 #include <vector>
@@ -48,22 +47,31 @@ KalmanPredictor::State EvaluateCubic(const KalmanPredictor::State &start_state,
   return end_state;
 }
 
+// When the error covariance is carried over from a previous stroke, the number
+// of inputs after which the predictor is considered stable. We need at least
+// two inputs to estimate the time between inputs and the velocity.
+constexpr int kWarmStartStableIteration = 2;
+
 }  // namespace
 
 void KalmanPredictor::Reset() {
-  x_predictor_.Reset();
-  y_predictor_.Reset();
-  sample_times_.clear();
+  if (predictor_params_.carry_over_error_covariance) {
+    x_predictor_.ResetKeepingErrorCovariance(kWarmStartStableIteration);
+    y_predictor_.ResetKeepingErrorCovariance(kWarmStartStableIteration);
+  } else {
+    x_predictor_.Reset();
+    y_predictor_.Reset();
+  }
+  sample_times_.Clear();
   last_position_received_ = std::nullopt;
 }
 
 void KalmanPredictor::Update(Vec2 position, Time time) {
   last_position_received_ = position;
-  sample_times_.push_back(time);
+  sample_times_.PushBack(time, {});
   if (predictor_params_.max_time_samples < 0 ||
-      sample_times_.size() >
-          static_cast<size_t>(predictor_params_.max_time_samples)) {
-    sample_times_.pop_front();
+      sample_times_.Size() > predictor_params_.max_time_samples) {
+    sample_times_.PopFront();
   }
 
   x_predictor_.Update(position.x);
@@ -72,7 +80,7 @@ void KalmanPredictor::Update(Vec2 position, Time time) {
 
 std::optional<KalmanPredictor::State> KalmanPredictor::GetEstimatedState()
     const {
-  if (!IsStable() || sample_times_.empty()) return std::nullopt;
+  if (!IsStable() || sample_times_.Empty()) return std::nullopt;
 
   State estimated_state;
   estimated_state.position = {static_cast<float>(x_predictor_.GetPosition()),
@@ -89,9 +97,8 @@ std::optional<KalmanPredictor::State> KalmanPredictor::GetEstimatedState()
   // between measurements is always 1. To correct for this, we divide the
   // velocity, acceleration, and jerk by the average observed time delta, raised
   // to the appropriate power.
-  auto dt = static_cast<float>(
-                (sample_times_.back() - sample_times_.front()).Value()) /
-            sample_times_.size();
+  auto dt = static_cast<float>(sample_times_.TimeSpan().Value()) /
+            sample_times_.Size();
   auto dt_squared = dt * dt;
   auto dt_cubed = dt_squared * dt;
   estimated_state.velocity /= dt;
@@ -115,14 +122,59 @@ void KalmanPredictor::ConstructPrediction(
     return;
   }
 
-  Duration sample_dt{1. / sampling_params_.min_output_rate};
   ConstructCubicConnector(last_state, *estimated_state, predictor_params_,
-                          sample_dt, &prediction);
+                          sample_dt_, &prediction);
   auto start_time =
       prediction.empty() ? last_state.time : prediction.back().time;
-  ConstructCubicPrediction(*estimated_state, predictor_params_, start_time,
-                           sample_dt, NumberOfPointsToPredict(*estimated_state),
-                           &prediction);
+  ConstructCubicPrediction(
+      *estimated_state, predictor_params_, start_time, sample_dt_,
+      NumberOfPointsToPredict(*estimated_state), &prediction);
+}
+
+void KalmanPredictor::ConstructPrediction(
+    const TipState &last_state, Duration horizon, Duration sample_spacing,
+    std::vector<TipState> &prediction) const {
+  prediction.clear();
+  auto estimated_state = GetEstimatedState();
+  if (!estimated_state || !last_position_received_) {
+    // We don't yet have enough data to construct a prediction.
+    return;
+  }
+
+  const Time end_time = last_state.time + horizon;
+  ConstructCubicConnector(last_state, *estimated_state, predictor_params_,
+                          sample_spacing, &prediction);
+  if (!prediction.empty() && prediction.back().time > end_time) {
+    // The horizon falls within the connector, so we discard the rest of it,
+    // and don't need the cubic prediction at all.
+    while (!prediction.empty() && prediction.back().time > end_time) {
+      prediction.pop_back();
+    }
+    return;
+  }
+
+  // In place of the prediction interval, the cubic prediction covers the rest
+  // of the horizon, subject to the same confidence heuristics.
+  auto start_time =
+      prediction.empty() ? last_state.time : prediction.back().time;
+  auto target_number =
+      static_cast<float>((end_time - start_time).Value() /
+                         sample_spacing.Value());
+  ConstructCubicPrediction(
+      *estimated_state, predictor_params_, start_time, sample_spacing,
+      NumberOfPointsToPredict(*estimated_state, target_number), &prediction);
+
+  if (!prediction.empty() && prediction.back().time > end_time) {
+    // The horizon need not be a multiple of the sample spacing, so the last
+    // point may overshoot it; we replace it with the point at the horizon.
+    State end_state = EvaluateCubic(*estimated_state, end_time - start_time);
+    prediction.back() = {
+        .position = end_state.position,
+        .velocity = end_state.velocity,
+        .acceleration = end_state.acceleration,
+        .time = end_time,
+    };
+  }
 }
 
 void KalmanPredictor::ConstructCubicPrediction(
@@ -148,6 +200,18 @@ void KalmanPredictor::ConstructCubicConnector(
     const TipState &last_tip_state, const State &estimated_state,
     const KalmanPredictorParams &params, Duration sample_dt,
     std::vector<TipState> *output) {
+  CubicConnector connector =
+      MakeCubicConnector(last_tip_state, estimated_state, params, sample_dt);
+  output->reserve(output->size() + connector.n_points);
+  for (int i = 1; i <= connector.n_points; ++i) {
+    output->push_back(EvaluateCubicConnector(
+        connector, static_cast<float>(i) / connector.n_points));
+  }
+}
+
+KalmanPredictor::CubicConnector KalmanPredictor::MakeCubicConnector(
+    const TipState &last_tip_state, const State &estimated_state,
+    const KalmanPredictorParams &params, Duration sample_dt) {
   // Estimate how long it will take for the tip to travel from its last position
   // to the estimated position, based on the start and end velocities. We define
   // a minimum "reasonable" velocity to avoid division by zero.
@@ -209,32 +273,79 @@ void KalmanPredictor::ConstructCubicConnector(
   Vec2 c = last_tip_state.velocity * float_duration;
   Vec2 d = last_tip_state.position;
 
-  output->reserve(output->size() + n_points);
-  for (int i = 1; i <= n_points; ++i) {
-    float t = static_cast<float>(i) / n_points;
-    float t_squared = t * t;
-    float t_cubed = t_squared * t;
-    Vec2 position = a * t_cubed + b * t_squared + c * t + d;
-    Vec2 velocity = 3.f * a * t_squared + 2.f * b * t + c;
-    Vec2 acceleration = 6.f * a * t + 2.f * b;
-    Time time = last_tip_state.time + duration * t;
-    output->push_back({
-        .position = position,
-        .velocity = velocity / float_duration,
-        .acceleration = acceleration / (float_duration * float_duration),
-        .time = time,
-    });
+  return {.a = a,
+          .b = b,
+          .c = c,
+          .d = d,
+          .start_time = last_tip_state.time,
+          .duration = duration,
+          .n_points = n_points};
+}
+
+TipState KalmanPredictor::EvaluateCubicConnector(
+    const CubicConnector &connector, float t) {
+  float t_squared = t * t;
+  float t_cubed = t_squared * t;
+  Vec2 position = connector.a * t_cubed + connector.b * t_squared +
+                  connector.c * t + connector.d;
+  Vec2 velocity = 3.f * connector.a * t_squared + 2.f * connector.b * t +
+                  connector.c;
+  Vec2 acceleration = 6.f * connector.a * t + 2.f * connector.b;
+  float float_duration = connector.duration.Value();
+  return {
+      .position = position,
+      .velocity = velocity / float_duration,
+      .acceleration = acceleration / (float_duration * float_duration),
+      .time = connector.start_time + connector.duration * t,
+  };
+}
+
+std::optional<TipState> KalmanPredictor::PredictAt(const TipState &last_state,
+                                                   Time time) const {
+  auto estimated_state = GetEstimatedState();
+  if (!estimated_state || !last_position_received_) {
+    // We don't yet have enough data to construct a prediction.
+    return std::nullopt;
+  }
+  if (time <= last_state.time) return last_state;
+
+  // This mirrors ConstructPrediction(), but evaluates only the part of the
+  // prediction containing `time`.
+  CubicConnector connector = MakeCubicConnector(
+      last_state, *estimated_state, predictor_params_, sample_dt_);
+  Time connector_end_time = connector.start_time + connector.duration;
+  if (time <= connector_end_time) {
+    TipState tip_state = EvaluateCubicConnector(
+        connector, static_cast<float>((time - connector.start_time).Value() /
+                                      connector.duration.Value()));
+    tip_state.time = time;
+    return tip_state;
   }
+
+  Time end_time = connector_end_time +
+                  NumberOfPointsToPredict(*estimated_state) * sample_dt_;
+  if (time > end_time) time = end_time;
+  State state = EvaluateCubic(*estimated_state, time - connector_end_time);
+  return TipState{
+      .position = state.position,
+      .velocity = state.velocity,
+      .acceleration = state.acceleration,
+      .time = time,
+  };
 }
 
 int KalmanPredictor::NumberOfPointsToPredict(
     const State &estimated_state) const {
-  const KalmanPredictorParams::ConfidenceParams &confidence_params =
-      predictor_params_.confidence_params;
-
   auto target_number =
       static_cast<float>(predictor_params_.prediction_interval.Value() *
                          sampling_params_.min_output_rate);
+  return NumberOfPointsToPredict(estimated_state, target_number);
+}
+
+int KalmanPredictor::NumberOfPointsToPredict(const State &estimated_state,
+                                             float target_number) const {
+  const KalmanPredictorParams::ConfidenceParams &confidence_params =
+      predictor_params_.confidence_params;
 
   // The more samples we've received, the less effect the noise from each
   // individual input affects the result.
@@ -17,7 +17,6 @@
 #ifndef INK_STROKE_MODELER_INTERNAL_PREDICTION_KALMAN_PREDICTOR_H_
 #define INK_STROKE_MODELER_INTERNAL_PREDICTION_KALMAN_PREDICTOR_H_
 
-#include <deque>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -25,6 +24,7 @@
 #include "ink_stroke_modeler/internal/internal_types.h"
 #include "ink_stroke_modeler/internal/prediction/input_predictor.h"
 #include "ink_stroke_modeler/internal/prediction/kalman_filter/axis_predictor.h"
+#include "ink_stroke_modeler/internal/sliding_window_stats.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
 
@@ -46,6 +46,7 @@ class KalmanPredictor : public InputPredictor {
                            const SamplingParams &sampling_params)
       : predictor_params_(predictor_params),
         sampling_params_(sampling_params),
+        sample_dt_(1. / sampling_params.min_output_rate),
         x_predictor_(predictor_params_.process_noise,
                      predictor_params_.measurement_noise,
                      predictor_params_.min_stable_iteration),
@@ -57,6 +58,11 @@ class KalmanPredictor : public InputPredictor {
   void Update(Vec2 position, Time time) override;
   void ConstructPrediction(const TipState &last_state,
                            std::vector<TipState> &prediction) const override;
+  void ConstructPrediction(const TipState &last_state, Duration horizon,
+                           Duration sample_spacing,
+                           std::vector<TipState> &prediction) const override;
+  std::optional<TipState> PredictAt(const TipState &last_state,
+                                    Time time) const override;
   std::unique_ptr<InputPredictor> MakeCopy() const override {
     return std::make_unique<KalmanPredictor>(*this);
   }
@@ -78,6 +84,27 @@ class KalmanPredictor : public InputPredictor {
     return x_predictor_.Stable() && y_predictor_.Stable();
   }
 
+  // The cubic curve connecting the last tip state to the estimated state; see
+  // MakeCubicConnector() for details.
+  struct CubicConnector {
+    Vec2 a{0};
+    Vec2 b{0};
+    Vec2 c{0};
+    Vec2 d{0};
+    Time start_time{0};
+    Duration duration{0};
+    int n_points = 0;
+  };
+
+  static CubicConnector MakeCubicConnector(const TipState &last_tip_state,
+                                           const State &estimated_state,
+                                           const KalmanPredictorParams &params,
+                                           Duration sample_dt);
+
+  // Evaluates the connector at `t`, the ratio along its duration.
+  static TipState EvaluateCubicConnector(const CubicConnector &connector,
+                                         float t);
+
   static void ConstructCubicConnector(const TipState &last_tip_state,
                                       const State &estimated_state,
                                       const KalmanPredictorParams &params,
@@ -90,14 +117,23 @@ class KalmanPredictor : public InputPredictor {
                                        int n_samples,
                                        std::vector<TipState> *output);
 
+  // Returns the number of points to predict beyond the estimated state, given
+  // the number of points that would be predicted with full confidence. If
+  // omitted, that number is determined from the prediction interval.
   int NumberOfPointsToPredict(const State &estimated_state) const;
+  int NumberOfPointsToPredict(const State &estimated_state,
+                              float target_number) const;
 
   KalmanPredictorParams predictor_params_;
   SamplingParams sampling_params_;
+  // The interval between samples at SamplingParams::min_output_rate.
+  Duration sample_dt_;
 
   std::optional<Vec2> last_position_received_;
 
-  std::deque<Time> sample_times_;
+  // The timestamps of the most recent inputs; no per-sample values are
+  // tracked, only the count and the time span.
+  SlidingWindowStats<0> sample_times_;
 
   AxisPredictor x_predictor_;
   AxisPredictor y_predictor_;
@@ -33,7 +33,9 @@ namespace stroke_model {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::Matcher;
+using ::testing::Not;
 using ::testing::Optional;
 
 constexpr float kTol = 1e-4;
@@ -166,6 +168,95 @@ TEST(KalmanPredictorTest, TypicalCase) {
                                        kTol)));
 }
 
+TEST(KalmanPredictorTest, HorizonAndSampleSpacing) {
+  KalmanPredictor predictor{kDefaultKalmanParams, kDefaultSamplingParams};
+  predictor.Update({0, 0}, Time{0});
+  predictor.Update({.1, 0}, Time{.01});
+  predictor.Update({.2, 0}, Time{.02});
+  predictor.Update({.3, 0}, Time{.03});
+  const TipState last_state = {
+      .position = {.2, 0}, .velocity = {10, 0}, .time = Time{.03}};
+  std::vector<TipState> prediction;
+
+  // With the usual spacing, this matches the prediction in TypicalCase, except
+  // that the last point is pulled back to the horizon.
+  predictor.ConstructPrediction(last_state, Duration(.015), Duration(1. / 180),
+                                prediction);
+  EXPECT_THAT(prediction,
+              ElementsAre(TipStateNear({.position = {.2454, 0},
+                                        .velocity = {7.7094, 0},
+                                        .acceleration = {322.5341, 0},
+                                        .time = Time{.0356}},
+                                       kTol),
+                          TipStateNear({.position = {.3008, 0},
+                                        .velocity = {13.5837, 0},
+                                        .acceleration = {1792.2293, 0},
+                                        .time = Time{.0411}},
+                                       kTol),
+                          TipStateNear({.position = {.3531, 0},
+                                        .velocity = {13.2983, 0},
+                                        .acceleration = {-79.9613, 0},
+                                        .time = Time{.045}},
+                                       kTol)));
+
+  // If the horizon falls within the connector, the rest of it is discarded.
+  predictor.ConstructPrediction(last_state, Duration(.008), Duration(1. / 180),
+                                prediction);
+  EXPECT_THAT(prediction,
+              ElementsAre(TipStateNear({.position = {.2454, 0},
+                                        .velocity = {7.7094, 0},
+                                        .acceleration = {322.5341, 0},
+                                        .time = Time{.0356}},
+                                       kTol)));
+
+  // With a coarser spacing, the points are further apart, and don't go past
+  // the horizon.
+  predictor.ConstructPrediction(last_state, Duration(.05), Duration(.01),
+                                prediction);
+  ASSERT_THAT(prediction, Not(IsEmpty()));
+  Time previous_time = last_state.time;
+  for (const TipState &tip_state : prediction) {
+    EXPECT_GT(tip_state.time, previous_time);
+    EXPECT_LE(tip_state.time - previous_time, Duration(.01 + kTol));
+    previous_time = tip_state.time;
+  }
+  EXPECT_LE(prediction.back().time, Time(.08));
+}
+
+TEST(KalmanPredictorTest, PredictAt) {
+  KalmanPredictor predictor{kDefaultKalmanParams, kDefaultSamplingParams};
+  const TipState last_state = {
+      .position = {.3, 0}, .velocity = {10, 0}, .time = Time{.04}};
+  EXPECT_EQ(predictor.PredictAt(last_state, Time{.05}), std::nullopt);
+
+  predictor.Update({0, 0}, Time{0});
+  predictor.Update({.1, 0}, Time{.01});
+  predictor.Update({.2, 0}, Time{.02});
+  predictor.Update({.3, 0}, Time{.03});
+  predictor.Update({.5, .1}, Time{.04});
+  std::vector<TipState> prediction;
+  predictor.ConstructPrediction(last_state, prediction);
+  ASSERT_EQ(prediction.size(), 3);
+
+  // The connector and the cubic prediction are evaluated at the given time.
+  for (const TipState &tip_state : prediction) {
+    EXPECT_THAT(predictor.PredictAt(last_state, tip_state.time),
+                Optional(TipStateNear(tip_state, kTol)));
+  }
+  std::optional<TipState> between =
+      predictor.PredictAt(last_state, Time{.048});
+  ASSERT_TRUE(between.has_value());
+  EXPECT_EQ(between->time, Time{.048});
+  EXPECT_GT(between->position.x, prediction[0].position.x);
+  EXPECT_LT(between->position.x, prediction[1].position.x);
+
+  // Times outside the prediction are clamped.
+  EXPECT_THAT(predictor.PredictAt(last_state, Time{.03}),
+              Optional(TipStateNear(last_state, kTol)));
+  EXPECT_THAT(predictor.PredictAt(last_state, Time{1}),
+              Optional(TipStateNear(prediction.back(), kTol)));
+}
+
 TEST(KalmanPredictorTest, AlternateParams) {
   auto kalman_params = kDefaultKalmanParams;
   auto sampling_params = kDefaultSamplingParams;
@@ -284,6 +375,79 @@ TEST(KalmanPredictorTest, Reset) {
   EXPECT_FALSE(prediction.empty());
 }
 
+// Feeds a stroke moving in a straight line at a constant rate to the predictor,
+// resetting it first, and returns the time of the first input after which a
+// prediction could be constructed, or std::nullopt if no prediction could be
+// constructed.
+std::optional<Time> TimeOfFirstPrediction(KalmanPredictor &predictor,
+                                          Vec2 start_position,
+                                          Time start_time) {
+  constexpr int kNumInputs = 10;
+  const Duration kInputInterval{1. / 120};
+  const Vec2 kInputOffset{.08, .03};
+
+  predictor.Reset();
+  std::vector<TipState> prediction;
+  for (int i = 0; i < kNumInputs; ++i) {
+    Vec2 position = start_position + i * kInputOffset;
+    Time time = start_time + i * kInputInterval;
+    predictor.Update(position, time);
+    predictor.ConstructPrediction(
+        {.position = position,
+         .velocity = kInputOffset / static_cast<float>(kInputInterval.Value()),
+         .time = time},
+        prediction);
+    if (!prediction.empty()) return time;
+  }
+  return std::nullopt;
+}
+
+TEST(KalmanPredictorTest, TimeToFirstPredictionWithoutCarryOver) {
+  KalmanPredictor predictor{kDefaultKalmanParams, kDefaultSamplingParams};
+
+  // Each stroke must wait for `min_stable_iteration` inputs, i.e. three input
+  // intervals.
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {0, 0}, Time{0}),
+              Optional(TimeNear(Time{3. / 120}, kTol)));
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {5, 2}, Time{1}),
+              Optional(TimeNear(Time{1 + 3. / 120}, kTol)));
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {-3, 7}, Time{2}),
+              Optional(TimeNear(Time{2 + 3. / 120}, kTol)));
+}
+
+TEST(KalmanPredictorTest, TimeToFirstPredictionWithCarryOver) {
+  KalmanPredictorParams params = kDefaultKalmanParams;
+  params.carry_over_error_covariance = true;
+  KalmanPredictor predictor{params, kDefaultSamplingParams};
+
+  // The first stroke has nothing to carry over, so it must wait for
+  // `min_stable_iteration` inputs, but subsequent strokes only need two inputs,
+  // i.e. one input interval.
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {0, 0}, Time{0}),
+              Optional(TimeNear(Time{3. / 120}, kTol)));
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {5, 2}, Time{1}),
+              Optional(TimeNear(Time{1 + 1. / 120}, kTol)));
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {-3, 7}, Time{2}),
+              Optional(TimeNear(Time{2 + 1. / 120}, kTol)));
+}
+
+TEST(KalmanPredictorTest, CarryOverRequiresAStableStroke) {
+  KalmanPredictorParams params = kDefaultKalmanParams;
+  params.carry_over_error_covariance = true;
+  KalmanPredictor predictor{params, kDefaultSamplingParams};
+
+  // This stroke is too short for the predictor to become stable, so there's
+  // nothing to carry over to the next one.
+  predictor.Update({0, 0}, Time{0});
+  predictor.Update({.1, 0}, Time{.01});
+  EXPECT_EQ(predictor.GetEstimatedState(), std::nullopt);
+
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {5, 2}, Time{1}),
+              Optional(TimeNear(Time{1 + 3. / 120}, kTol)));
+  EXPECT_THAT(TimeOfFirstPrediction(predictor, {-3, 7}, Time{2}),
+              Optional(TimeNear(Time{2 + 1. / 120}, kTol)));
+}
+
 TEST(KalmanPredictorTest, MakeCopy) {
   KalmanPredictor predictor{kDefaultKalmanParams, kDefaultSamplingParams};
 
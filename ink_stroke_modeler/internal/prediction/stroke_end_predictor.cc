@@ -24,6 +24,39 @@
 
 namespace ink {
 namespace stroke_model {
+namespace {
+
+constexpr double kRelativeSpacingTolerance = 1e-6;
+
+// An output iterator over TipState that, instead of storing the states, keeps
+// track of the latest one at or before a given time, and of whether there are
+// any after it.
+class LatestStateAtOrBefore {
+ public:
+  LatestStateAtOrBefore(Time time, std::optional<TipState> &latest,
+                        bool &has_later_state)
+      : time_(time), latest_(&latest), has_later_state_(&has_later_state) {}
+
+  LatestStateAtOrBefore &operator*() { return *this; }
+  LatestStateAtOrBefore &operator++() { return *this; }
+  LatestStateAtOrBefore &operator++(int) { return *this; }
+
+  LatestStateAtOrBefore &operator=(const TipState &state) {
+    if (state.time <= time_) {
+      *latest_ = state;
+    } else {
+      *has_later_state_ = true;
+    }
+    return *this;
+  }
+
+ private:
+  Time time_;
+  std::optional<TipState> *latest_;
+  bool *has_later_state_;
+};
+
+}  // namespace
 
 void StrokeEndPredictor::Update(Vec2 position, Time time) {
   last_position_ = position;
@@ -40,12 +73,77 @@ void StrokeEndPredictor::ConstructPrediction(
   prediction.reserve(sampling_params_.end_of_stroke_max_iterations);
   PositionModeler modeler;
   modeler.Reset(last_state, position_modeler_params_);
-  modeler.ModelEndOfStroke(*last_position_,
-                           Duration(1. / sampling_params_.min_output_rate),
+  modeler.ModelEndOfStroke(*last_position_, sample_dt_,
                            sampling_params_.end_of_stroke_max_iterations,
                            sampling_params_.end_of_stroke_stopping_distance,
                            std::back_inserter(prediction));
 }
 
+std::optional<TipState> StrokeEndPredictor::PredictAt(
+    const TipState &last_state, Time time) const {
+  if (!last_position_) {
+    // We don't yet have enough data to construct a prediction.
+    return std::nullopt;
+  }
+
+  // The end of the stroke is modeled by integration, so we can't jump straight
+  // to `time`. However, we only need to keep track of the states around it.
+  std::optional<TipState> latest;
+  bool has_later_state = false;
+  PositionModeler modeler;
+  modeler.Reset(last_state, position_modeler_params_);
+  modeler.ModelEndOfStroke(
+      *last_position_, sample_dt_,
+      sampling_params_.end_of_stroke_max_iterations,
+      sampling_params_.end_of_stroke_stopping_distance,
+      LatestStateAtOrBefore(time, latest, has_later_state));
+
+  if (!latest.has_value() && !has_later_state) {
+    // The prediction is empty.
+    return std::nullopt;
+  }
+  if (time <= last_state.time) return last_state;
+  if (!has_later_state) {
+    // `time` is after the end of the prediction.
+    return latest;
+  }
+  if (latest.has_value() && latest->time == time) return latest;
+
+  // `time` falls between two predicted states, so we take a partial step from
+  // the earlier one.
+  modeler.Reset(latest.has_value() ? *latest : last_state,
+                position_modeler_params_);
+  return modeler.Update(*last_position_, time);
+}
+
+void StrokeEndPredictor::ConstructPrediction(
+    const TipState &last_state, Duration horizon, Duration sample_spacing,
+    std::vector<TipState> &prediction) const {
+  // The position modeler is only stable when it's updated at the configured
+  // rate, so we construct the prediction as usual, and then discard the states
+  // beyond the horizon and thin out the rest to the requested spacing. We
+  // always keep the last state within the horizon, so that the prediction ends
+  // in the same place.
+  ConstructPrediction(last_state, prediction);
+
+  const Time end_time = last_state.time + horizon;
+  // The states are spaced at the configured rate, up to rounding error, so we
+  // allow for that when comparing against the requested spacing.
+  const Duration min_spacing = sample_spacing * (1 - kRelativeSpacingTolerance);
+  decltype(prediction.size()) n_kept = 0;
+  Time last_kept_time = last_state.time;
+  for (decltype(prediction.size()) i = 0;
+       i < prediction.size() && prediction[i].time <= end_time; ++i) {
+    bool is_last_within_horizon =
+        i + 1 == prediction.size() || prediction[i + 1].time > end_time;
+    if (is_last_within_horizon ||
+        prediction[i].time - last_kept_time >= min_spacing) {
+      last_kept_time = prediction[i].time;
+      prediction[n_kept++] = prediction[i];
+    }
+  }
+  prediction.resize(n_kept);
+}
+
 }  // namespace stroke_model
 }  // namespace ink
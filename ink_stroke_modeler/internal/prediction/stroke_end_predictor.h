@@ -39,12 +39,18 @@ class StrokeEndPredictor : public InputPredictor {
       const PositionModelerParams &position_modeler_params,
       const SamplingParams &sampling_params)
       : position_modeler_params_(position_modeler_params),
-        sampling_params_(sampling_params) {}
+        sampling_params_(sampling_params),
+        sample_dt_(1. / sampling_params.min_output_rate) {}
 
   void Reset() override { last_position_ = std::nullopt; }
   void Update(Vec2 position, Time time) override;
   void ConstructPrediction(const TipState &last_state,
                            std::vector<TipState> &prediction) const override;
+  void ConstructPrediction(const TipState &last_state, Duration horizon,
+                           Duration sample_spacing,
+                           std::vector<TipState> &prediction) const override;
+  std::optional<TipState> PredictAt(const TipState &last_state,
+                                    Time time) const override;
   std::unique_ptr<InputPredictor> MakeCopy() const override {
     return std::make_unique<StrokeEndPredictor>(*this);
   }
@@ -52,6 +58,8 @@ class StrokeEndPredictor : public InputPredictor {
  private:
   PositionModelerParams position_modeler_params_;
   SamplingParams sampling_params_;
+  // The interval between samples at SamplingParams::min_output_rate.
+  Duration sample_dt_;
 
   std::optional<Vec2> last_position_;
 };
@@ -15,6 +15,7 @@
 #include "ink_stroke_modeler/internal/prediction/stroke_end_predictor.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -32,6 +33,7 @@ namespace {
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 using ::testing::Not;
+using ::testing::Optional;
 
 constexpr float kTol = 1e-4;
 
@@ -184,6 +186,86 @@ TEST(StrokeEndPredictorTest, Reset) {
   EXPECT_THAT(prediction, IsEmpty());
 }
 
+TEST(StrokeEndPredictorTest, HorizonAndSampleSpacing) {
+  StrokeEndPredictor predictor{PositionModelerParams{}, kDefaultSamplingParams};
+  predictor.Update({-1, 1}, Time{1});
+  predictor.Update({-1, 1.2}, Time{1.02});
+  const TipState last_state = {
+      .position = {-1, 1.1}, .velocity = {0, 5}, .time = Time{1.02}};
+
+  std::vector<TipState> full_prediction;
+  predictor.ConstructPrediction(last_state, full_prediction);
+  ASSERT_EQ(full_prediction.size(), 7);
+
+  // With a long enough horizon and the usual spacing, nothing is discarded.
+  std::vector<TipState> prediction;
+  predictor.ConstructPrediction(last_state, Duration(1), Duration(1. / 180),
+                                prediction);
+  EXPECT_THAT(prediction,
+              ElementsAre(TipStateNear(full_prediction[0], kTol),
+                          TipStateNear(full_prediction[1], kTol),
+                          TipStateNear(full_prediction[2], kTol),
+                          TipStateNear(full_prediction[3], kTol),
+                          TipStateNear(full_prediction[4], kTol),
+                          TipStateNear(full_prediction[5], kTol),
+                          TipStateNear(full_prediction[6], kTol)));
+
+  // The states are thinned out to the requested spacing, but the prediction
+  // still ends in the same place.
+  predictor.ConstructPrediction(last_state, Duration(1), Duration(.01),
+                                prediction);
+  EXPECT_THAT(prediction,
+              ElementsAre(TipStateNear(full_prediction[1], kTol),
+                          TipStateNear(full_prediction[3], kTol),
+                          TipStateNear(full_prediction[5], kTol),
+                          TipStateNear(full_prediction[6], kTol)));
+
+  // The states beyond the horizon are discarded.
+  predictor.ConstructPrediction(last_state, Duration(.02), Duration(.01),
+                                prediction);
+  EXPECT_THAT(prediction,
+              ElementsAre(TipStateNear(full_prediction[1], kTol),
+                          TipStateNear(full_prediction[2], kTol)));
+  predictor.ConstructPrediction(last_state, Duration(0), Duration(.01),
+                                prediction);
+  EXPECT_THAT(prediction, IsEmpty());
+}
+
+TEST(StrokeEndPredictorTest, PredictAt) {
+  StrokeEndPredictor predictor{PositionModelerParams{}, kDefaultSamplingParams};
+  const TipState last_state = {
+      .position = {-1, 1.1}, .velocity = {0, 5}, .time = Time{1.02}};
+  EXPECT_EQ(predictor.PredictAt(last_state, Time{1.03}), std::nullopt);
+
+  predictor.Update({-1, 1}, Time{1});
+  predictor.Update({-1, 1.2}, Time{1.02});
+  std::vector<TipState> prediction;
+  predictor.ConstructPrediction(last_state, prediction);
+  ASSERT_EQ(prediction.size(), 7);
+
+  for (const TipState &tip_state : prediction) {
+    EXPECT_THAT(predictor.PredictAt(last_state, tip_state.time),
+                Optional(TipStateNear(tip_state, kTol)));
+  }
+  std::optional<TipState> between =
+      predictor.PredictAt(last_state, Time{1.028});
+  ASSERT_TRUE(between.has_value());
+  EXPECT_EQ(between->time, Time{1.028});
+  EXPECT_GT(between->position.y, prediction[0].position.y);
+  EXPECT_LT(between->position.y, prediction[1].position.y);
+
+  EXPECT_THAT(predictor.PredictAt(last_state, Time{1}),
+              Optional(TipStateNear(last_state, kTol)));
+  EXPECT_THAT(predictor.PredictAt(last_state, Time{2}),
+              Optional(TipStateNear(prediction.back(), kTol)));
+
+  // If the prediction would be empty, so is this.
+  EXPECT_EQ(predictor.PredictAt(
+                {.position = {-1, 1.2}, .velocity = {0, 0}, .time = Time{1.02}},
+                Time{1.03}),
+            std::nullopt);
+}
+
 TEST(StrokeEndPredictorTest, AlternateSamplingParams) {
   StrokeEndPredictor predictor{
       PositionModelerParams{},
@@ -248,6 +330,31 @@ TEST(StrokeEndPredictorTest, AlternateSamplingParams) {
                                        kTol)));
 }
 
+TEST(StrokeEndPredictorTest, ExactIntegrator) {
+  StrokeEndPredictor predictor{
+      PositionModelerParams{
+          .integrator = PositionModelerParams::Integrator::kExact},
+      SamplingParams{.min_output_rate = 200,
+                     .end_of_stroke_stopping_distance = .005}};
+  std::vector<TipState> prediction;
+
+  predictor.Update({4, -7}, Time{3});
+  predictor.Update({4.2, -6.8}, Time{3.01});
+  predictor.ConstructPrediction(
+      {.position = {4.1, -6.9}, .velocity = {2, 2}, .time = Time{3.01}},
+      prediction);
+  // This ends at about the same place and time as with the default
+  // integrator, in the AlternateSamplingParams test above, though without
+  // stepping back from overshooting the anchor.
+  ASSERT_THAT(prediction, Not(IsEmpty()));
+  EXPECT_LE(prediction.size(), 20);
+  EXPECT_THAT(prediction.back().position, Vec2Near({4.2, -6.8}, .005));
+  EXPECT_THAT(prediction.back().time, TimeNear(Time{3.055}, .005));
+  for (size_t i = 1; i < prediction.size(); ++i) {
+    EXPECT_GT(prediction[i].time, prediction[i - 1].time);
+  }
+}
+
 TEST(StrokeEndPredictorTest, MakeCopy) {
   StrokeEndPredictor predictor{PositionModelerParams{}, kDefaultSamplingParams};
 
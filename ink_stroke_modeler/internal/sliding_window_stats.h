@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_SLIDING_WINDOW_STATS_H_
+#define INK_STROKE_MODELER_INTERNAL_SLIDING_WINDOW_STATS_H_
+
+#include <array>
+#include <cmath>
+#include <deque>
+
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// A running sum that uses Neumaier's variant of Kahan summation to track the
+// rounding error of each addition. This allows values to be repeatedly added
+// to and subtracted from the sum without the result drifting away from the
+// exact sum of the remaining values.
+class CompensatedSum {
+ public:
+  void Add(double value) {
+    double new_sum = sum_ + value;
+    if (std::abs(sum_) >= std::abs(value)) {
+      compensation_ += (sum_ - new_sum) + value;
+    } else {
+      compensation_ += (value - new_sum) + sum_;
+    }
+    sum_ = new_sum;
+  }
+
+  void Subtract(double value) { Add(-value); }
+
+  void Clear() {
+    sum_ = 0;
+    compensation_ = 0;
+  }
+
+  double Value() const { return sum_ + compensation_; }
+
+ private:
+  double sum_ = 0;
+  double compensation_ = 0;
+};
+
+// Maintains statistics over a window of timestamped samples, each of which
+// carries `kNumValues` values. Samples are appended at the back of the window
+// and discarded from the front; the per-value sums are updated incrementally,
+// so the sum, mean, and time span of the window can be queried in constant
+// time, regardless of the number of samples in the window.
+//
+// The policy for discarding samples is left to the caller, e.g.:
+//   while (window.Size() > max_samples) window.PopFront();
+template <int kNumValues>
+class SlidingWindowStats {
+ public:
+  using Values = std::array<double, kNumValues>;
+
+  // Removes all samples from the window.
+  void Clear() {
+    samples_.clear();
+    for (CompensatedSum &sum : sums_) sum.Clear();
+  }
+
+  // Appends a sample to the back of the window.
+  void PushBack(Time time, const Values &values) {
+    samples_.push_back({.time = time, .values = values});
+    for (int i = 0; i < kNumValues; ++i) sums_[i].Add(values[i]);
+  }
+
+  // Discards the sample at the front of the window. The window must not be
+  // empty.
+  void PopFront() {
+    const Sample &front = samples_.front();
+    for (int i = 0; i < kNumValues; ++i) sums_[i].Subtract(front.values[i]);
+    samples_.pop_front();
+    // Once the window is empty the sums are known to be exactly zero, so we
+    // discard any residual error instead of carrying it forward.
+    if (samples_.empty()) {
+      for (CompensatedSum &sum : sums_) sum.Clear();
+    }
+  }
+
+  bool Empty() const { return samples_.empty(); }
+  int Size() const { return samples_.size(); }
+
+  // Returns the time of the oldest and newest samples in the window. The
+  // window must not be empty.
+  Time FrontTime() const { return samples_.front().time; }
+  Time BackTime() const { return samples_.back().time; }
+
+  // Returns the difference in time between the newest and oldest samples in
+  // the window, or zero if the window is empty.
+  Duration TimeSpan() const {
+    if (samples_.empty()) return Duration(0);
+    return samples_.back().time - samples_.front().time;
+  }
+
+  // Returns the sum of the `index`th value over all samples in the window.
+  double Sum(int index) const { return sums_[index].Value(); }
+
+  // Returns the mean of the `index`th value over all samples in the window, or
+  // zero if the window is empty.
+  double Mean(int index) const {
+    if (samples_.empty()) return 0;
+    return Sum(index) / samples_.size();
+  }
+
+ private:
+  struct Sample {
+    Time time;
+    Values values;
+  };
+
+  std::deque<Sample> samples_;
+  std::array<CompensatedSum, kNumValues> sums_;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_SLIDING_WINDOW_STATS_H_
@@ -0,0 +1,146 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/sliding_window_stats.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::DoubleNear;
+
+TEST(CompensatedSumTest, AddAndSubtract) {
+  CompensatedSum sum;
+  EXPECT_EQ(sum.Value(), 0);
+  sum.Add(3);
+  sum.Add(4.5);
+  EXPECT_THAT(sum.Value(), DoubleEq(7.5));
+  sum.Subtract(3);
+  EXPECT_THAT(sum.Value(), DoubleEq(4.5));
+  sum.Clear();
+  EXPECT_EQ(sum.Value(), 0);
+}
+
+TEST(CompensatedSumTest, DoesNotLoseSmallValuesNextToLargeOnes) {
+  CompensatedSum sum;
+  sum.Add(1e16);
+  sum.Add(1);
+  sum.Add(1);
+  sum.Subtract(1e16);
+  EXPECT_THAT(sum.Value(), DoubleEq(2));
+}
+
+TEST(CompensatedSumTest, DoesNotDriftOverManyUpdates) {
+  // Emulate a sliding window of size 3 over a long sequence of values that are
+  // not exactly representable.
+  CompensatedSum sum;
+  for (int i = 0; i < 100000; ++i) {
+    sum.Add(.1 * (i % 7));
+    if (i >= 3) sum.Subtract(.1 * ((i - 3) % 7));
+  }
+  // The last three values are .1 * (99997 % 7, 99998 % 7, 99999 % 7), i.e.
+  // .1 * (2 + 3 + 4).
+  EXPECT_THAT(sum.Value(), DoubleNear(.9, 1e-15));
+}
+
+TEST(SlidingWindowStatsTest, Empty) {
+  SlidingWindowStats<2> window;
+  EXPECT_TRUE(window.Empty());
+  EXPECT_EQ(window.Size(), 0);
+  EXPECT_EQ(window.TimeSpan(), Duration(0));
+  EXPECT_EQ(window.Sum(0), 0);
+  EXPECT_EQ(window.Mean(1), 0);
+}
+
+TEST(SlidingWindowStatsTest, PushAndPop) {
+  SlidingWindowStats<2> window;
+  window.PushBack(Time(1), {2, 10});
+  window.PushBack(Time(1.5), {4, 20});
+  window.PushBack(Time(3), {9, 30});
+  EXPECT_FALSE(window.Empty());
+  EXPECT_EQ(window.Size(), 3);
+  EXPECT_EQ(window.FrontTime(), Time(1));
+  EXPECT_EQ(window.BackTime(), Time(3));
+  EXPECT_EQ(window.TimeSpan(), Duration(2));
+  EXPECT_THAT(window.Sum(0), DoubleEq(15));
+  EXPECT_THAT(window.Sum(1), DoubleEq(60));
+  EXPECT_THAT(window.Mean(0), DoubleEq(5));
+  EXPECT_THAT(window.Mean(1), DoubleEq(20));
+
+  window.PopFront();
+  EXPECT_EQ(window.Size(), 2);
+  EXPECT_EQ(window.FrontTime(), Time(1.5));
+  EXPECT_EQ(window.TimeSpan(), Duration(1.5));
+  EXPECT_THAT(window.Sum(0), DoubleEq(13));
+  EXPECT_THAT(window.Mean(1), DoubleEq(25));
+
+  window.PopFront();
+  window.PopFront();
+  EXPECT_TRUE(window.Empty());
+  EXPECT_EQ(window.Sum(0), 0);
+  EXPECT_EQ(window.Sum(1), 0);
+}
+
+TEST(SlidingWindowStatsTest, SumsAreExactlyZeroOnceEmptied) {
+  SlidingWindowStats<1> window;
+  window.PushBack(Time(0), {.1});
+  window.PushBack(Time(1), {.2});
+  window.PushBack(Time(2), {1e10});
+  window.PopFront();
+  window.PopFront();
+  window.PopFront();
+  EXPECT_EQ(window.Sum(0), 0);
+}
+
+TEST(SlidingWindowStatsTest, Clear) {
+  SlidingWindowStats<1> window;
+  window.PushBack(Time(0), {5});
+  window.PushBack(Time(1), {7});
+  window.Clear();
+  EXPECT_TRUE(window.Empty());
+  EXPECT_EQ(window.Sum(0), 0);
+  EXPECT_EQ(window.TimeSpan(), Duration(0));
+
+  window.PushBack(Time(4), {3});
+  EXPECT_THAT(window.Mean(0), DoubleEq(3));
+}
+
+TEST(SlidingWindowStatsTest, NoValues) {
+  SlidingWindowStats<0> window;
+  window.PushBack(Time(2), {});
+  window.PushBack(Time(2.5), {});
+  EXPECT_EQ(window.Size(), 2);
+  EXPECT_EQ(window.TimeSpan(), Duration(.5));
+  window.PopFront();
+  EXPECT_EQ(window.TimeSpan(), Duration(0));
+}
+
+TEST(SlidingWindowStatsTest, CopyIsIndependent) {
+  SlidingWindowStats<1> window;
+  window.PushBack(Time(0), {1});
+  SlidingWindowStats<1> copy = window;
+  window.PushBack(Time(1), {2});
+  EXPECT_EQ(copy.Size(), 1);
+  EXPECT_THAT(copy.Sum(0), DoubleEq(1));
+  EXPECT_THAT(window.Sum(0), DoubleEq(3));
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
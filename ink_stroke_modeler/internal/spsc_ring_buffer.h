@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_SPSC_RING_BUFFER_H_
+#define INK_STROKE_MODELER_INTERNAL_SPSC_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ink {
+namespace stroke_model {
+
+// A bounded, lock-free queue for passing values from exactly one producer
+// thread to exactly one consumer thread. TryPush() may only be called from the
+// producer thread, and TryPop() only from the consumer thread; the other
+// methods may be called from any thread.
+//
+// The slots are allocated once, at construction. Values are copy-assigned into
+// a slot when pushed, and swapped out of it when popped, so that the slot
+// takes over the allocations of the consumer's previous value. When `T` owns
+// heap allocations (e.g. a std::vector), this means that once the queue has
+// cycled through each slot, pushing and popping allocate nothing.
+template <typename T>
+class SpscRingBuffer {
+ public:
+  // `capacity` must be greater than zero.
+  explicit SpscRingBuffer(int capacity) : slots_(capacity + 1) {}
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+  // Copies `value` to the back of the queue. Returns false, leaving the queue
+  // unchanged, if the queue is full.
+  bool TryPush(const T &value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t next_tail = Next(tail);
+    if (next_tail == cached_head_) {
+      // The queue looked full the last time we checked; the consumer may have
+      // popped since then.
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (next_tail == cached_head_) return false;
+    }
+    slots_[tail] = value;
+    tail_.store(next_tail, std::memory_order_release);
+    return true;
+  }
+
+  // Swaps the value at the front of the queue into `value`, and removes it.
+  // Returns false, leaving `value` unchanged, if the queue is empty.
+  bool TryPop(T &value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      // The queue looked empty the last time we checked; the producer may have
+      // pushed since then.
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) return false;
+    }
+    using std::swap;
+    swap(slots_[head], value);
+    head_.store(Next(head), std::memory_order_release);
+    return true;
+  }
+
+  // Returns the number of values in the queue. If called concurrently with
+  // TryPush() or TryPop(), this may be out of date by the time it returns.
+  int Size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return tail >= head ? tail - head : tail + slots_.size() - head;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  int Capacity() const { return slots_.size() - 1; }
+
+ private:
+  size_t Next(size_t index) const {
+    return index + 1 == slots_.size() ? 0 : index + 1;
+  }
+
+  // The queue holds one more slot than its capacity, so that a full queue can
+  // be distinguished from an empty one: it's empty when `head_ == tail_`, and
+  // full when `Next(tail_) == head_`.
+  std::vector<T> slots_;
+
+  // The consumer and producer indices, and each side's cached copy of the
+  // other's index, are kept on separate cache lines, so that the two threads
+  // don't contend for them.
+  alignas(64) std::atomic<size_t> head_ = 0;
+  size_t cached_tail_ = 0;
+  alignas(64) std::atomic<size_t> tail_ = 0;
+  size_t cached_head_ = 0;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_SPSC_RING_BUFFER_H_
@@ -0,0 +1,122 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/spsc_ring_buffer.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(SpscRingBufferTest, PushAndPop) {
+  SpscRingBuffer<int> buffer(3);
+  EXPECT_EQ(buffer.Capacity(), 3);
+  EXPECT_TRUE(buffer.Empty());
+
+  int value = -1;
+  EXPECT_FALSE(buffer.TryPop(value));
+  EXPECT_EQ(value, -1);
+
+  EXPECT_TRUE(buffer.TryPush(1));
+  EXPECT_TRUE(buffer.TryPush(2));
+  EXPECT_TRUE(buffer.TryPush(3));
+  EXPECT_EQ(buffer.Size(), 3);
+  EXPECT_FALSE(buffer.TryPush(4));
+  EXPECT_EQ(buffer.Size(), 3);
+
+  EXPECT_TRUE(buffer.TryPop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(buffer.TryPush(4));
+  EXPECT_FALSE(buffer.TryPush(5));
+
+  std::vector<int> popped;
+  while (buffer.TryPop(value)) popped.push_back(value);
+  EXPECT_THAT(popped, ElementsAre(2, 3, 4));
+  EXPECT_TRUE(buffer.Empty());
+}
+
+TEST(SpscRingBufferTest, WrapsAround) {
+  SpscRingBuffer<int> buffer(2);
+  int value;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(buffer.TryPush(i));
+    ASSERT_EQ(buffer.Size(), 1);
+    ASSERT_TRUE(buffer.TryPop(value));
+    EXPECT_EQ(value, i);
+  }
+}
+
+TEST(SpscRingBufferTest, PopReturnsPreviousValueToTheSlot) {
+  SpscRingBuffer<std::vector<int>> buffer(1);
+  std::vector<int> value;
+  value.reserve(100);
+  const int *allocation = value.data();
+
+  ASSERT_TRUE(buffer.TryPush({1, 2}));
+  ASSERT_TRUE(buffer.TryPop(value));
+  EXPECT_THAT(value, ElementsAre(1, 2));
+
+  // The first slot now holds the allocation that `value` had, which is reused
+  // when a value is next copied into it, after going around the other slot.
+  std::vector<int> other;
+  ASSERT_TRUE(buffer.TryPush({3}));
+  ASSERT_TRUE(buffer.TryPop(other));
+  EXPECT_THAT(other, ElementsAre(3));
+  ASSERT_TRUE(buffer.TryPush({4}));
+  std::vector<int> next;
+  ASSERT_TRUE(buffer.TryPop(next));
+  EXPECT_THAT(next, ElementsAre(4));
+  EXPECT_EQ(next.data(), allocation);
+  EXPECT_THAT(value, ElementsAre(1, 2));
+
+  std::vector<int> empty;
+  EXPECT_FALSE(buffer.TryPop(empty));
+  EXPECT_THAT(empty, IsEmpty());
+}
+
+TEST(SpscRingBufferTest, TransfersAllValuesInOrderAcrossThreads) {
+  constexpr int kNumValues = 100000;
+  SpscRingBuffer<int> buffer(16);
+
+  std::thread producer([&buffer]() {
+    for (int i = 0; i < kNumValues; ++i) {
+      while (!buffer.TryPush(i)) std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  int value;
+  while (expected < kNumValues) {
+    if (!buffer.TryPop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(value, expected);
+    ++expected;
+  }
+  producer.join();
+  EXPECT_TRUE(buffer.Empty());
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
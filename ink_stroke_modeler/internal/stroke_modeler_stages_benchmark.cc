@@ -0,0 +1,203 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for each stage of the StrokeModeler pipeline in isolation, on a
+// synthetic signature, with hardware counters reported per input and per
+// output where they are available. This shows which stages are bound by
+// compute, branches or memory.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ink_stroke_modeler/internal/benchmark_perf_counters.h"
+#include "ink_stroke_modeler/internal/internal_types.h"
+#include "ink_stroke_modeler/internal/position_modeler.h"
+#include "ink_stroke_modeler/internal/prediction/input_predictor.h"
+#include "ink_stroke_modeler/internal/prediction/kalman_predictor.h"
+#include "ink_stroke_modeler/internal/prediction/stroke_end_predictor.h"
+#include "ink_stroke_modeler/internal/stylus_state_modeler.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/internal/wobble_smoother.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+const StrokeModelParams kParams = RecommendedStrokeModelParams();
+const WobbleSmootherParams &kWobbleSmootherParams =
+    kParams.wobble_smoother_params;
+const PositionModelerParams &kPositionModelerParams =
+    kParams.position_modeler_params;
+const SamplingParams &kSamplingParams = kParams.sampling_params;
+const StylusStateModelerParams &kStylusStateModelerParams =
+    kParams.stylus_state_modeler_params;
+const KalmanPredictorParams &kKalmanPredictorParams =
+    std::get<KalmanPredictorParams>(kParams.prediction_params);
+
+std::vector<Input> MakeStroke() {
+  return GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .duration = Duration(2),
+       .input_rate = 240,
+       .timestamp_jitter = .2,
+       .position_noise = .002,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+}
+
+// The number of tip states modeled between two inputs, as StrokeModeler would
+// choose it, ignoring the angle limit.
+int NumberOfSteps(const Input &start, const Input &end) {
+  return std::max(1, static_cast<int>(std::ceil(
+                         (end.time - start.time).Value() *
+                         kSamplingParams.min_output_rate)));
+}
+
+// Returns the tip states modeled for each input after the first.
+std::vector<std::vector<TipState>> ModelTipStates(
+    const std::vector<Input> &inputs) {
+  PositionModeler modeler;
+  modeler.Reset({.position = inputs[0].position, .time = inputs[0].time},
+                kPositionModelerParams);
+  std::vector<std::vector<TipState>> tip_states(inputs.size());
+  for (size_t i = 1; i < inputs.size(); ++i) {
+    modeler.UpdateAlongLinearPath(
+        inputs[i - 1].position, inputs[i - 1].time, inputs[i].position,
+        inputs[i].time, NumberOfSteps(inputs[i - 1], inputs[i]),
+        std::back_inserter(tip_states[i]));
+  }
+  return tip_states;
+}
+
+void BM_WobbleSmoother(benchmark::State &state) {
+  const std::vector<Input> inputs = MakeStroke();
+  BenchmarkPerfCounters perf_counters(state);
+  WobbleSmoother smoother;
+  for (auto _ : state) {
+    smoother.Reset(kWobbleSmootherParams, inputs[0].position, inputs[0].time);
+    perf_counters.Start();
+    for (const Input &input : inputs) {
+      benchmark::DoNotOptimize(smoother.Update(input.position, input.time));
+    }
+    perf_counters.Stop();
+  }
+  const int64_t n_inputs = state.iterations() * inputs.size();
+  state.SetItemsProcessed(n_inputs);
+  perf_counters.Report(n_inputs, n_inputs);
+}
+BENCHMARK(BM_WobbleSmoother);
+
+// The argument is the PositionModelerParams::Integrator: 0 for semi-implicit
+// Euler, and 1 for exact.
+void BM_PositionModeler(benchmark::State &state) {
+  const std::vector<Input> inputs = MakeStroke();
+  PositionModelerParams params = kPositionModelerParams;
+  params.integrator =
+      static_cast<PositionModelerParams::Integrator>(state.range(0));
+  BenchmarkPerfCounters perf_counters(state);
+  PositionModeler modeler;
+  std::vector<TipState> tip_states;
+  int64_t n_results = 0;
+  for (auto _ : state) {
+    modeler.Reset({.position = inputs[0].position, .time = inputs[0].time},
+                  params);
+    tip_states.clear();
+    perf_counters.Start();
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      modeler.UpdateAlongLinearPath(
+          inputs[i - 1].position, inputs[i - 1].time, inputs[i].position,
+          inputs[i].time, NumberOfSteps(inputs[i - 1], inputs[i]),
+          std::back_inserter(tip_states));
+    }
+    perf_counters.Stop();
+    n_results += tip_states.size();
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  perf_counters.Report(state.iterations() * inputs.size(), n_results);
+}
+BENCHMARK(BM_PositionModeler)->ArgName("integrator")->DenseRange(0, 1);
+
+// Adds each input to the stylus state model, and queries it for each of the
+// tip states modeled for that input.
+void BM_StylusStateModeler(benchmark::State &state) {
+  const std::vector<Input> inputs = MakeStroke();
+  const std::vector<std::vector<TipState>> tip_states = ModelTipStates(inputs);
+  BenchmarkPerfCounters perf_counters(state);
+  StylusStateModeler modeler;
+  int64_t n_results = 0;
+  for (auto _ : state) {
+    modeler.Reset(kStylusStateModelerParams);
+    perf_counters.Start();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      modeler.Update(inputs[i].position, inputs[i].time,
+                     {.pressure = inputs[i].pressure,
+                      .tilt = inputs[i].tilt,
+                      .orientation = inputs[i].orientation});
+      for (const TipState &tip_state : tip_states[i]) {
+        benchmark::DoNotOptimize(modeler.Query(tip_state, std::nullopt));
+      }
+      n_results += tip_states[i].size();
+    }
+    perf_counters.Stop();
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  perf_counters.Report(state.iterations() * inputs.size(), n_results);
+}
+BENCHMARK(BM_StylusStateModeler);
+
+// Adds each input to the predictor, and constructs a prediction from the last
+// tip state modeled for it. The argument is 0 for the Kalman predictor, and 1
+// for the stroke end predictor.
+void BM_Predictor(benchmark::State &state) {
+  const std::vector<Input> inputs = MakeStroke();
+  const std::vector<std::vector<TipState>> tip_states = ModelTipStates(inputs);
+  std::unique_ptr<InputPredictor> predictor;
+  if (state.range(0) == 0) {
+    predictor = std::make_unique<KalmanPredictor>(kKalmanPredictorParams,
+                                                  kSamplingParams);
+  } else {
+    predictor = std::make_unique<StrokeEndPredictor>(kPositionModelerParams,
+                                                     kSamplingParams);
+  }
+  BenchmarkPerfCounters perf_counters(state);
+  std::vector<TipState> prediction;
+  int64_t n_results = 0;
+  for (auto _ : state) {
+    predictor->Reset();
+    predictor->Update(inputs[0].position, inputs[0].time);
+    perf_counters.Start();
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      predictor->Update(inputs[i].position, inputs[i].time);
+      predictor->ConstructPrediction(tip_states[i].back(), prediction);
+      n_results += prediction.size();
+    }
+    perf_counters.Stop();
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  perf_counters.Report(state.iterations() * inputs.size(), n_results);
+}
+BENCHMARK(BM_Predictor)->ArgName("predictor")->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
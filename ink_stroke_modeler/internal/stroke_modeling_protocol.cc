@@ -0,0 +1,164 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/stroke_modeling_protocol.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "ink_stroke_modeler/types.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace ink {
+namespace stroke_model {
+
+InputMessage ToInputMessage(const Input &input) {
+  return {.event_type = static_cast<int32_t>(input.event_type),
+          .position_x = input.position.x,
+          .position_y = input.position.y,
+          .pressure = input.pressure,
+          .time = input.time.Value(),
+          .tilt = input.tilt,
+          .orientation = input.orientation};
+}
+
+absl::StatusOr<Input> FromInputMessage(const InputMessage &message) {
+  Input::EventType event_type;
+  switch (message.event_type) {
+    case static_cast<int32_t>(Input::EventType::kDown):
+      event_type = Input::EventType::kDown;
+      break;
+    case static_cast<int32_t>(Input::EventType::kMove):
+      event_type = Input::EventType::kMove;
+      break;
+    case static_cast<int32_t>(Input::EventType::kUp):
+      event_type = Input::EventType::kUp;
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::Substitute("Unknown event type: $0", message.event_type));
+  }
+  return Input{.event_type = event_type,
+               .position = {message.position_x, message.position_y},
+               .time = Time(message.time),
+               .pressure = message.pressure,
+               .tilt = message.tilt,
+               .orientation = message.orientation};
+}
+
+absl::Status ValidateSocketPath(absl::string_view path) {
+#ifdef __linux__
+  // The path must leave room for the terminating null.
+  if (path.empty() || path.size() >= sizeof(sockaddr_un::sun_path)) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "Socket path must have between 1 and $0 characters. Actual value: $1",
+        sizeof(sockaddr_un::sun_path) - 1, path));
+  }
+  return absl::OkStatus();
+#else
+  return absl::UnavailableError(
+      "The stroke modeling server is only supported on Linux");
+#endif  // __linux__
+}
+
+absl::Status SendMessage(int socket_fd, const void *message, size_t size,
+                         int fd_to_send) {
+#ifdef __linux__
+  iovec iov{.iov_base = const_cast<void *>(message), .iov_len = size};
+  msghdr header{};
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  if (fd_to_send != -1) {
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    cmsghdr *control_header = CMSG_FIRSTHDR(&header);
+    control_header->cmsg_level = SOL_SOCKET;
+    control_header->cmsg_type = SCM_RIGHTS;
+    control_header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(control_header), &fd_to_send, sizeof(int));
+  }
+  ssize_t n_sent;
+  do {
+    // MSG_NOSIGNAL reports a closed peer as EPIPE, instead of raising SIGPIPE.
+    n_sent = sendmsg(socket_fd, &header, MSG_NOSIGNAL);
+  } while (n_sent < 0 && errno == EINTR);
+  if (n_sent < 0) return absl::ErrnoToStatus(errno, "sendmsg failed");
+  if (static_cast<size_t>(n_sent) != size) {
+    return absl::InternalError("sendmsg sent a partial message");
+  }
+  return absl::OkStatus();
+#else
+  return absl::UnavailableError(
+      "The stroke modeling server is only supported on Linux");
+#endif  // __linux__
+}
+
+absl::StatusOr<int> ReceiveMessage(int socket_fd, void *message, size_t size) {
+#ifdef __linux__
+  iovec iov{.iov_base = message, .iov_len = size};
+  msghdr header{};
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  header.msg_control = control;
+  header.msg_controllen = sizeof(control);
+  ssize_t n_received;
+  do {
+    n_received = recvmsg(socket_fd, &header, MSG_CMSG_CLOEXEC);
+  } while (n_received < 0 && errno == EINTR);
+  if (n_received < 0) return absl::ErrnoToStatus(errno, "recvmsg failed");
+
+  int received_fd = -1;
+  for (cmsghdr *control_header = CMSG_FIRSTHDR(&header);
+       control_header != nullptr;
+       control_header = CMSG_NXTHDR(&header, control_header)) {
+    if (control_header->cmsg_level == SOL_SOCKET &&
+        control_header->cmsg_type == SCM_RIGHTS &&
+        control_header->cmsg_len == CMSG_LEN(sizeof(int))) {
+      std::memcpy(&received_fd, CMSG_DATA(control_header), sizeof(int));
+    }
+  }
+  // Neither side sends empty messages, so this is the end of the stream.
+  if (n_received == 0) {
+    if (received_fd != -1) close(received_fd);
+    return absl::UnavailableError("Connection closed by peer");
+  }
+  if (static_cast<size_t>(n_received) != size ||
+      (header.msg_flags & MSG_TRUNC) != 0) {
+    if (received_fd != -1) close(received_fd);
+    return absl::InvalidArgumentError(
+        absl::Substitute("Expected a message of $0 bytes", size));
+  }
+  return received_fd;
+#else
+  return absl::UnavailableError(
+      "The stroke modeling server is only supported on Linux");
+#endif  // __linux__
+}
+
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_STROKE_MODELING_PROTOCOL_H_
+#define INK_STROKE_MODELER_INTERNAL_STROKE_MODELING_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// The messages exchanged by StrokeModelingServer and StrokeModelingClient over
+// a Unix domain socket, and the system calls to send and receive them. The
+// socket is a SOCK_SEQPACKET socket, so each message is received whole. The
+// server and client may be built separately, so the messages only contain
+// fixed-size fields, and anything that changes them must also change
+// kStrokeModelingProtocolVersion.
+
+inline constexpr uint32_t kStrokeModelingProtocolMagic = 0x494e4b53;  // "INKS"
+inline constexpr uint32_t kStrokeModelingProtocolVersion = 1;
+
+// Sent by the server to each client as it connects, along with a file
+// descriptor for the shared memory that holds the ResultBroadcastRing.
+struct HelloMessage {
+  uint32_t magic;
+  uint32_t protocol_version;
+  // The size of the shared memory, in bytes.
+  uint64_t ring_bytes;
+};
+
+// Sent by a client for each input to be modeled.
+struct InputMessage {
+  int32_t event_type;
+  float position_x;
+  float position_y;
+  float pressure;
+  double time;
+  float tilt;
+  float orientation;
+};
+
+InputMessage ToInputMessage(const Input &input);
+
+// Returns an error if the message's event type is unknown. The rest of the
+// input is validated by StrokeModeler::Update().
+absl::StatusOr<Input> FromInputMessage(const InputMessage &message);
+
+// Returns an error if `path` is empty or too long for a Unix domain socket
+// address.
+absl::Status ValidateSocketPath(absl::string_view path);
+
+// Sends the `size` bytes at `message` as a single message, along with
+// `fd_to_send` if it isn't -1.
+absl::Status SendMessage(int socket_fd, const void *message, size_t size,
+                         int fd_to_send = -1);
+
+// Receives a single message of exactly `size` bytes into `message`, and
+// returns the file descriptor sent along with it, or -1 if there was none.
+// Returns an UnavailableError if the peer has closed the connection, and an
+// InvalidArgumentError if the message has the wrong size.
+absl::StatusOr<int> ReceiveMessage(int socket_fd, void *message, size_t size);
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_STROKE_MODELING_PROTOCOL_H_
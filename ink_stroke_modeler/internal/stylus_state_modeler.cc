@@ -14,12 +14,16 @@
 
 #include "ink_stroke_modeler/internal/stylus_state_modeler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <deque>
 #include <limits>
 #include <optional>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "ink_stroke_modeler/internal/internal_types.h"
+#include "ink_stroke_modeler/internal/polyline_segment_index.h"
 #include "ink_stroke_modeler/internal/utils.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
@@ -67,6 +71,7 @@ void StylusStateModeler::Update(Vec2 position, Time time,
       state_.received_unknown_orientation) {
     // We've stopped tracking all fields, so there's no need to keep updating.
     state_.raw_input_and_stylus_states.clear();
+    state_.segment_index.Clear();
     return;
   }
 
@@ -90,14 +95,17 @@ void StylusStateModeler::Update(Vec2 position, Time time,
       .tilt = state.tilt,
       .orientation = state.orientation,
   });
+  state_.segment_index.PushBack(position);
 
   while (ShouldDropOldestInput(params_, state_.raw_input_and_stylus_states)) {
     state_.raw_input_and_stylus_states.pop_front();
+    state_.segment_index.PopFront();
   }
 }
 
 void StylusStateModeler::Reset(const StylusStateModelerParams &params) {
   state_.raw_input_and_stylus_states.clear();
+  state_.segment_index.Clear();
   state_.received_unknown_pressure = false;
   state_.received_unknown_tilt = false;
   state_.received_unknown_orientation = false;
@@ -113,134 +121,403 @@ struct RawInputProjection {
   float ratio_along_segment;
 };
 
-std::optional<RawInputProjection> ProjectAlongStrokeNormal(
-    Vec2 position, Vec2 acceleration, Time time, Vec2 stroke_normal,
-    const std::deque<Result> &raw_input_polyline) {
-  // We track the best candidate separately for the left and right sides of the
-  // stroke, in case the closest projection is not in the right direction.
-  std::optional<RawInputProjection> best_left_projection;
-  std::optional<RawInputProjection> best_right_projection;
-  float best_distance_left = std::numeric_limits<float>::infinity();
-  float best_distance_right = std::numeric_limits<float>::infinity();
-
-  // Update `best_projection` and `best_distance` if needed.
-  auto maybe_update_projection =
-      [](RawInputProjection candidate, float distance,
-         std::optional<RawInputProjection> &best_projection,
-         float &best_distance) {
-        if (distance < best_distance) {
-          best_projection = candidate;
-          best_distance = distance;
-        }
-      };
+// Accumulates the best projection along the stroke normal over the segments of
+// the raw input polyline passed to `AddSegment()`. Segments must be added in
+// increasing order.
+class StrokeNormalProjection {
+ public:
+  StrokeNormalProjection(Vec2 position, Vec2 stroke_normal,
+                         const std::deque<Result> &raw_input_polyline)
+      : position_(position),
+        stroke_normal_(stroke_normal),
+        raw_input_polyline_(raw_input_polyline) {}
+
+  // A segment can only change the result if it is closer than the best
+  // candidate on at least one side. Until we have candidates on both sides,
+  // this is infinite.
+  float MaxDistance() const {
+    return std::max(best_distance_left_, best_distance_right_);
+  }
 
-  for (decltype(raw_input_polyline.size()) i = 0;
-       i < raw_input_polyline.size() - 1; ++i) {
-    const Vec2 segment_start = raw_input_polyline[i].position;
-    const Vec2 segment_end = raw_input_polyline[i + 1].position;
+  void AddSegment(int i) {
+    const Vec2 segment_start = raw_input_polyline_[i].position;
+    const Vec2 segment_end = raw_input_polyline_[i + 1].position;
 
     // Find the intersection of the stroke normal with the polyline segment.
     std::optional<float> segment_ratio = ProjectToSegmentAlongNormal(
-        segment_start, segment_end, position, stroke_normal);
-    if (!segment_ratio.has_value()) continue;
+        segment_start, segment_end, position_, stroke_normal_);
+    if (!segment_ratio.has_value()) return;
 
     Vec2 projection = Interp(segment_start, segment_end, *segment_ratio);
-    float distance = Distance(position, projection);
+    float distance = Distance(position_, projection);
 
     // We update either the best left or the right projection, depending which
     // side of the stroke it lies on -- recall that the stroke normal always
     // points to the left.
-    RawInputProjection candidate{.segment_index = static_cast<int>(i),
-                                 .ratio_along_segment = *segment_ratio};
-    if (Vec2::DotProduct(projection - position, stroke_normal) < 0) {
-      maybe_update_projection(candidate, distance, best_right_projection,
-                              best_distance_right);
+    RawInputProjection candidate{
+        .segment_index = i, .ratio_along_segment = *segment_ratio};
+    if (Vec2::DotProduct(projection - position_, stroke_normal_) < 0) {
+      MaybeUpdateProjection(candidate, distance, best_right_projection_,
+                            best_distance_right_);
     } else {
-      maybe_update_projection(candidate, distance, best_left_projection,
-                              best_distance_left);
+      MaybeUpdateProjection(candidate, distance, best_left_projection_,
+                            best_distance_left_);
+    }
+  }
+
+  std::optional<RawInputProjection> Best(Vec2 acceleration) const {
+    if (best_left_projection_.has_value() &&
+        best_right_projection_.has_value()) {
+      // We have candidate projections on both sides of the stroke, so we want
+      // to choose the one on the "outside" of the turn. The acceleration will
+      // always point to the "inside" of the curve, so we can compare it to the
+      // stroke normal (which always points left) to determine whether to use
+      // the left or right candidate.
+      return Vec2::DotProduct(stroke_normal_, acceleration) > 0
+                 ? best_right_projection_
+                 : best_left_projection_;
     }
+
+    // We have at most one projection -- return it if we have it. If we have
+    // neither, this returns std::nullopt, which is exactly what we want.
+    return best_right_projection_.has_value() ? best_right_projection_
+                                              : best_left_projection_;
   }
 
-  if (best_left_projection.has_value() && best_right_projection.has_value()) {
-    // We have candidate projections on both sides of the stroke, so we want to
-    // choose the one on the "outside" of the turn. The acceleration will always
-    // point to the "inside" of the curve, so we can compare it to the stroke
-    // normal (which always points left) to determine whether to use the left or
-    // right candidate.
-    return Vec2::DotProduct(stroke_normal, acceleration) > 0
-               ? best_right_projection
-               : best_left_projection;
+ private:
+  // Update `best_projection` and `best_distance` if needed.
+  static void MaybeUpdateProjection(
+      RawInputProjection candidate, float distance,
+      std::optional<RawInputProjection> &best_projection,
+      float &best_distance) {
+    if (distance < best_distance) {
+      best_projection = candidate;
+      best_distance = distance;
+    }
   }
 
-  // We have at most one projection -- return it if we have it. If we have
-  // neither, this returns std::nullopt, which is exactly what we want.
-  return best_right_projection.has_value() ? best_right_projection
-                                           : best_left_projection;
-}
+  Vec2 position_;
+  Vec2 stroke_normal_;
+  const std::deque<Result> &raw_input_polyline_;
 
-std::optional<RawInputProjection> ProjectToClosestPoint(
-    Vec2 position, const std::deque<Result> &raw_input_polyline) {
-  std::optional<RawInputProjection> best_projection;
-  float min_distance = std::numeric_limits<float>::infinity();
-  for (decltype(raw_input_polyline.size()) i = 0;
-       i < raw_input_polyline.size() - 1; ++i) {
-    const Vec2 segment_start = raw_input_polyline[i].position;
-    const Vec2 segment_end = raw_input_polyline[i + 1].position;
+  // We track the best candidate separately for the left and right sides of the
+  // stroke, in case the closest projection is not in the right direction.
+  std::optional<RawInputProjection> best_left_projection_;
+  std::optional<RawInputProjection> best_right_projection_;
+  float best_distance_left_ = std::numeric_limits<float>::infinity();
+  float best_distance_right_ = std::numeric_limits<float>::infinity();
+};
+
+// Accumulates the closest projection over the segments of the raw input
+// polyline passed to `AddSegment()`. Segments must be added in increasing
+// order.
+class ClosestPointProjection {
+ public:
+  ClosestPointProjection(Vec2 position,
+                         const std::deque<Result> &raw_input_polyline)
+      : position_(position), raw_input_polyline_(raw_input_polyline) {}
+
+  // Returns the ratio along segment `i` of the point closest to the position,
+  // and stores the distance to that point in `distance`.
+  float ProjectToSegment(int i, float &distance) const {
+    const Vec2 segment_start = raw_input_polyline_[i].position;
+    const Vec2 segment_end = raw_input_polyline_[i + 1].position;
     float segment_ratio =
-        NearestPointOnSegment(segment_start, segment_end, position);
-    float distance =
-        Distance(position, Interp(segment_start, segment_end, segment_ratio));
-    if (distance <= min_distance) {
-      best_projection =
-          RawInputProjection{.segment_index = static_cast<int>(i),
-                             .ratio_along_segment = segment_ratio};
-      min_distance = distance;
+        NearestPointOnSegment(segment_start, segment_end, position_);
+    distance =
+        Distance(position_, Interp(segment_start, segment_end, segment_ratio));
+    return segment_ratio;
+  }
+
+  float MinDistance() const { return min_distance_; }
+
+  void AddSegment(int i) {
+    float distance;
+    float segment_ratio = ProjectToSegment(i, distance);
+    if (distance <= min_distance_) {
+      best_projection_ = RawInputProjection{
+          .segment_index = i, .ratio_along_segment = segment_ratio};
+      min_distance_ = distance;
     }
   }
-  return best_projection;
+
+  std::optional<RawInputProjection> Best() const { return best_projection_; }
+
+ private:
+  Vec2 position_;
+  const std::deque<Result> &raw_input_polyline_;
+
+  std::optional<RawInputProjection> best_projection_;
+  float min_distance_ = std::numeric_limits<float>::infinity();
+};
+
+std::optional<RawInputProjection> ProjectAlongStrokeNormal(
+    Vec2 position, Vec2 acceleration, Vec2 stroke_normal,
+    const std::deque<Result> &raw_input_polyline,
+    const PolylineSegmentIndex &segment_index) {
+  StrokeNormalProjection projection(position, stroke_normal,
+                                    raw_input_polyline);
+  segment_index.VisitSegmentsNearLine(
+      position, stroke_normal,
+      [&projection]() { return projection.MaxDistance(); },
+      [&projection](int i) { projection.AddSegment(i); });
+  return projection.Best(acceleration);
+}
+
+std::optional<RawInputProjection> ProjectToClosestPoint(
+    Vec2 position, const std::deque<Result> &raw_input_polyline,
+    const PolylineSegmentIndex &segment_index) {
+  if (segment_index.SegmentCount() == 0) return std::nullopt;
+
+  ClosestPointProjection projection(position, raw_input_polyline);
+
+  // The modeled position usually trails just behind the most recent input, so
+  // the distance to the last segment is a good initial bound for pruning. Note
+  // that we can't use it as the initial candidate, because the segments must be
+  // considered in order to break ties in the same way.
+  float last_segment_distance;
+  projection.ProjectToSegment(segment_index.SegmentCount() - 1,
+                              last_segment_distance);
+
+  segment_index.VisitSegmentsNear(
+      position,
+      [&projection, last_segment_distance]() {
+        return std::min(projection.MinDistance(), last_segment_distance);
+      },
+      [&projection](int i) { projection.AddSegment(i); });
+  return projection.Best();
+}
+
+// The tolerance used when filtering segments in QueryBatch(), relative to the
+// magnitude of the coordinates involved. As in PolylineSegmentIndex, this is
+// much larger than the floating-point error of the exact computations, so the
+// filter never discards a segment that could be chosen.
+constexpr float kBatchRelativeTolerance = 1e-5;
+
+// Computes the squared distance from `position` to each segment, for use as a
+// filter. This is written as a simple loop over arrays so that the compiler can
+// vectorize it; it doesn't need to match the exact computation bit-for-bit.
+void SquaredDistancesToSegments(int n_segments, const float *start_x,
+                                const float *start_y, const float *delta_x,
+                                const float *delta_y,
+                                const float *length_squared, Vec2 position,
+                                float *squared_distance) {
+  for (int i = 0; i < n_segments; ++i) {
+    float to_position_x = position.x - start_x[i];
+    float to_position_y = position.y - start_y[i];
+    float ratio =
+        (to_position_x * delta_x[i] + to_position_y * delta_y[i]) /
+        length_squared[i];
+    ratio = length_squared[i] == 0 ? 0 : ratio;
+    ratio = ratio < 0 ? 0 : ratio;
+    ratio = ratio > 1 ? 1 : ratio;
+    float dx = delta_x[i] * ratio - to_position_x;
+    float dy = delta_y[i] * ratio - to_position_y;
+    squared_distance[i] = dx * dx + dy * dy;
+  }
+}
+
+// Computes, for each segment, whether it may intersect the line through
+// `position` in the direction of `normal`, storing 1 if it may and 0 if it
+// can't. As above, this is written to be vectorized.
+void SegmentsCrossingLine(int n_segments, const float *start_x,
+                          const float *start_y, const float *end_x,
+                          const float *end_y, Vec2 position, Vec2 normal,
+                          float tolerance, float *may_cross) {
+  for (int i = 0; i < n_segments; ++i) {
+    // These are the cross products of the endpoints (relative to `position`)
+    // with the normal, i.e. the signed distances from the line, scaled by the
+    // magnitude of the normal.
+    float start_side = (start_x[i] - position.x) * normal.y -
+                       (start_y[i] - position.y) * normal.x;
+    float end_side =
+        (end_x[i] - position.x) * normal.y - (end_y[i] - position.y) * normal.x;
+    bool both_left = start_side > tolerance && end_side > tolerance;
+    bool both_right = start_side < -tolerance && end_side < -tolerance;
+    may_cross[i] = both_left || both_right ? 0 : 1;
+  }
+}
+
+// Returns the point of the raw input polyline at `projection`, or the endpoint
+// closest to `tip` if there is no projection.
+Result ProjectedResult(const std::deque<Result> &raw_input_polyline,
+                       const TipState &tip,
+                       const std::optional<RawInputProjection> &projection) {
+  if (projection.has_value()) {
+    return InterpResult(raw_input_polyline[projection->segment_index],
+                        raw_input_polyline[projection->segment_index + 1],
+                        projection->ratio_along_segment);
+  }
+  // We didn't find an appropriate projection; fall back to projecting to the
+  // closest endpoint of the raw input polyline.
+  return Distance(raw_input_polyline.front().position, tip.position) <
+                 Distance(raw_input_polyline.back().position, tip.position)
+             ? raw_input_polyline.front()
+             : raw_input_polyline.back();
 }
 
 }  // namespace
 
 Result StylusStateModeler::Query(const TipState &tip,
                                  std::optional<Vec2> stroke_normal) const {
-  if (state_.raw_input_and_stylus_states.empty())
-    return {
-        .position = {0, 0},
-        .velocity = {0, 0},
-        .acceleration = {0, 0},
-        .time = Time(0),
-        .pressure = -1,
-        .tilt = -1,
-        .orientation = -1,
-    };
+  if (state_.raw_input_and_stylus_states.empty()) return EmptyQueryResult();
 
   std::optional<RawInputProjection> projection =
       params_.use_stroke_normal_projection && stroke_normal.has_value()
-          ? ProjectAlongStrokeNormal(tip.position, tip.acceleration, tip.time,
+          ? ProjectAlongStrokeNormal(tip.position, tip.acceleration,
                                      *stroke_normal,
-                                     state_.raw_input_and_stylus_states)
+                                     state_.raw_input_and_stylus_states,
+                                     state_.segment_index)
           : ProjectToClosestPoint(tip.position,
-                                  state_.raw_input_and_stylus_states);
+                                  state_.raw_input_and_stylus_states,
+                                  state_.segment_index);
+  return FinishQueryResult(
+      tip,
+      ProjectedResult(state_.raw_input_and_stylus_states, tip, projection));
+}
 
-  Result projected_result;
-  if (projection.has_value()) {
-    projected_result = InterpResult(
-        state_.raw_input_and_stylus_states[projection->segment_index],
-        state_.raw_input_and_stylus_states[projection->segment_index + 1],
-        projection->ratio_along_segment);
-  } else {
-    // We didn't find an appropriate projection; fall back to projecting to the
-    // closest endpoint of the raw input polyline.
-    projected_result =
-        Distance(state_.raw_input_and_stylus_states.front().position,
-                 tip.position) <
-                Distance(state_.raw_input_and_stylus_states.back().position,
-                         tip.position)
-            ? state_.raw_input_and_stylus_states.front()
-            : state_.raw_input_and_stylus_states.back();
+void StylusStateModeler::QueryBatch(
+    absl::Span<const TipState> tips,
+    absl::Span<const std::optional<Vec2>> stroke_normals,
+    BatchScratch &scratch, std::vector<Result> &results) const {
+  results.reserve(results.size() + tips.size());
+  const std::deque<Result> &polyline = state_.raw_input_and_stylus_states;
+  if (polyline.empty()) {
+    results.insert(results.end(), tips.size(), EmptyQueryResult());
+    return;
+  }
+
+  const int n_segments = state_.segment_index.SegmentCount();
+  float max_coordinate = 0;
+  for (const Result &point : polyline) {
+    max_coordinate = std::max({max_coordinate, std::abs(point.position.x),
+                               std::abs(point.position.y)});
   }
 
+  for (decltype(tips.size()) tip_index = 0; tip_index < tips.size();
+       ++tip_index) {
+    const TipState &tip = tips[tip_index];
+    const std::optional<Vec2> &stroke_normal = stroke_normals[tip_index];
+    const bool use_stroke_normal =
+        params_.use_stroke_normal_projection && stroke_normal.has_value();
+
+    // Collect the candidate segments from the index. Unlike Query(), we can't
+    // tighten the bound as segments are evaluated, so we use a fixed bound
+    // that the chosen segment is known to satisfy: the stroke normal
+    // projection only prunes by the line, and the closest-point projection by
+    // the distance to the last segment.
+    scratch.candidates.clear();
+    const auto add_candidate = [&scratch](int i) {
+      scratch.candidates.push_back(i);
+    };
+    if (use_stroke_normal) {
+      state_.segment_index.VisitSegmentsNearLine(
+          tip.position, *stroke_normal,
+          []() { return std::numeric_limits<float>::infinity(); },
+          add_candidate);
+    } else if (n_segments > 0) {
+      float last_segment_distance;
+      ClosestPointProjection(tip.position, polyline)
+          .ProjectToSegment(n_segments - 1, last_segment_distance);
+      state_.segment_index.VisitSegmentsNear(
+          tip.position,
+          [last_segment_distance]() { return last_segment_distance; },
+          add_candidate);
+    }
+
+    // Lay out the candidate segments as a structure of arrays.
+    const int n_candidates = scratch.candidates.size();
+    scratch.start_x.resize(n_candidates);
+    scratch.start_y.resize(n_candidates);
+    scratch.end_x.resize(n_candidates);
+    scratch.end_y.resize(n_candidates);
+    scratch.delta_x.resize(n_candidates);
+    scratch.delta_y.resize(n_candidates);
+    scratch.length_squared.resize(n_candidates);
+    scratch.filter_values.resize(n_candidates);
+    for (int j = 0; j < n_candidates; ++j) {
+      const Vec2 start = polyline[scratch.candidates[j]].position;
+      const Vec2 end = polyline[scratch.candidates[j] + 1].position;
+      scratch.start_x[j] = start.x;
+      scratch.start_y[j] = start.y;
+      scratch.end_x[j] = end.x;
+      scratch.end_y[j] = end.y;
+      scratch.delta_x[j] = end.x - start.x;
+      scratch.delta_y[j] = end.y - start.y;
+      scratch.length_squared[j] = scratch.delta_x[j] * scratch.delta_x[j] +
+                                  scratch.delta_y[j] * scratch.delta_y[j];
+    }
+
+    // The tolerance for the filters, accounting for the floating-point error
+    // in the exact computations. A NaN here disables the filtering.
+    const float tolerance =
+        kBatchRelativeTolerance *
+        (max_coordinate + std::abs(tip.position.x) + std::abs(tip.position.y));
+
+    std::optional<RawInputProjection> projection;
+    if (use_stroke_normal) {
+      // Discard the candidates that the stroke normal can't intersect, then
+      // evaluate the rest exactly as Query() does.
+      SegmentsCrossingLine(
+          n_candidates, scratch.start_x.data(), scratch.start_y.data(),
+          scratch.end_x.data(), scratch.end_y.data(), tip.position,
+          *stroke_normal,
+          tolerance * (std::abs(stroke_normal->x) + std::abs(stroke_normal->y)),
+          scratch.filter_values.data());
+      StrokeNormalProjection normal_projection(tip.position, *stroke_normal,
+                                               polyline);
+      for (int j = 0; j < n_candidates; ++j) {
+        if (scratch.filter_values[j] != 0) {
+          normal_projection.AddSegment(scratch.candidates[j]);
+        }
+      }
+      projection = normal_projection.Best(tip.acceleration);
+    } else if (n_candidates > 0) {
+      // Discard the candidates that are clearly further away than the closest
+      // one, then evaluate the rest exactly as Query() does.
+      SquaredDistancesToSegments(
+          n_candidates, scratch.start_x.data(), scratch.start_y.data(),
+          scratch.delta_x.data(), scratch.delta_y.data(),
+          scratch.length_squared.data(), tip.position,
+          scratch.filter_values.data());
+      float min_squared_distance = std::numeric_limits<float>::infinity();
+      for (int j = 0; j < n_candidates; ++j) {
+        min_squared_distance =
+            std::min(min_squared_distance, scratch.filter_values[j]);
+      }
+      float max_distance =
+          std::sqrt(min_squared_distance) * (1 + kBatchRelativeTolerance) +
+          tolerance;
+      float max_squared_distance = max_distance * max_distance;
+      ClosestPointProjection closest_projection(tip.position, polyline);
+      for (int j = 0; j < n_candidates; ++j) {
+        // Written so that a NaN results in the segment being evaluated.
+        if (!(scratch.filter_values[j] > max_squared_distance)) {
+          closest_projection.AddSegment(scratch.candidates[j]);
+        }
+      }
+      projection = closest_projection.Best();
+    }
+    results.push_back(FinishQueryResult(
+        tip,
+        ProjectedResult(state_.raw_input_and_stylus_states, tip, projection)));
+  }
+}
+
+Result StylusStateModeler::EmptyQueryResult() {
+  return {
+      .position = {0, 0},
+      .velocity = {0, 0},
+      .acceleration = {0, 0},
+      .time = Time(0),
+      .pressure = -1,
+      .tilt = -1,
+      .orientation = -1,
+  };
+}
+
+Result StylusStateModeler::FinishQueryResult(const TipState &tip,
+                                             Result projected_result) const {
   // Correct the time and strip missing fields before returning.
   projected_result.time = tip.time;
   if (state_.received_unknown_pressure) {
@@ -267,5 +544,10 @@ void StylusStateModeler::Restore() {
   }
 }
 
+void StylusStateModeler::CopyStateFrom(const StylusStateModeler &other) {
+  state_ = other.state_;
+  params_ = other.params_;
+}
+
 }  // namespace stroke_model
 }  // namespace ink
@@ -19,8 +19,11 @@
 
 #include <deque>
 #include <optional>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "ink_stroke_modeler/internal/internal_types.h"
+#include "ink_stroke_modeler/internal/polyline_segment_index.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
 
@@ -73,6 +76,40 @@ class StylusStateModeler {
   // end result, but merely a container to hold all the relevant values.
   Result Query(const TipState &tip, std::optional<Vec2> stroke_normal) const;
 
+  // The buffers used by QueryBatch(). This doesn't hold state between calls;
+  // it only allows allocations to be reused.
+  struct BatchScratch {
+    // The segments that the segment index can't rule out for a tip state.
+    std::vector<int> candidates;
+    // The candidate segments laid out as a structure of arrays, plus space for
+    // a per-segment filter value.
+    std::vector<float> start_x;
+    std::vector<float> start_y;
+    std::vector<float> end_x;
+    std::vector<float> end_y;
+    std::vector<float> delta_x;
+    std::vector<float> delta_y;
+    std::vector<float> length_squared;
+    std::vector<float> filter_values;
+  };
+
+  // Queries the model for each of the given tip states, using the
+  // corresponding element of `stroke_normals`, and appends the results to
+  // `results`. `tips` and `stroke_normals` must have the same size.
+  //
+  // The results are bit-identical to calling Query() for each tip state, but
+  // this is faster when querying many tip states at once: for each tip state,
+  // the candidate segments from the segment index are laid out as arrays, so
+  // that they can be filtered with vectorized arithmetic before the remaining
+  // candidates are evaluated exactly.
+  //
+  // This may be called concurrently from multiple threads on the same
+  // modeler, so long as each thread uses its own `scratch`, and the modeler
+  // isn't modified at the same time.
+  void QueryBatch(absl::Span<const TipState> tips,
+                  absl::Span<const std::optional<Vec2>> stroke_normals,
+                  BatchScratch &scratch, std::vector<Result> &results) const;
+
   // The number of input samples currently held. Exposed for testing.
   int InputSampleCount() const {
     return state_.raw_input_and_stylus_states.size();
@@ -86,7 +123,19 @@ class StylusStateModeler {
   // StrokeModeler::Restore() for more details.
   void Restore();
 
+  // Copies the current state and parameters of `other`, but not its saved
+  // state. This is cheaper than copying the whole modeler when only the
+  // current state is needed, e.g. for a PredictionSnapshot.
+  void CopyStateFrom(const StylusStateModeler &other);
+
  private:
+  static Result EmptyQueryResult();
+
+  // Completes the result of a query for `tip` from the `projected_result` on
+  // the raw input polyline, by setting its time and clearing the fields that
+  // were missing from the input.
+  Result FinishQueryResult(const TipState &tip, Result projected_result) const;
+
   struct ModelerState {
     bool received_unknown_pressure = false;
     bool received_unknown_tilt = false;
@@ -95,6 +144,10 @@ class StylusStateModeler {
     // This does not actually contain an end results but we reuse `Result`
     // because it has all the fields we need to store.
     std::deque<Result> raw_input_and_stylus_states;
+
+    // Bounding boxes of the segments of `raw_input_and_stylus_states`, used to
+    // skip segments that can't contain the projection when querying.
+    PolylineSegmentIndex segment_index;
   };
 
   ModelerState state_;
@@ -14,7 +14,10 @@
 
 #include "ink_stroke_modeler/internal/stylus_state_modeler.h"
 
+#include <cmath>
 #include <optional>
+#include <random>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -28,6 +31,8 @@ namespace ink {
 namespace stroke_model {
 namespace {
 
+using ::testing::ElementsAre;
+
 constexpr float kTol = 1e-5;
 constexpr float kAccelTol = 1e-3;
 constexpr StylusState kUnknownState{
@@ -1164,6 +1169,83 @@ TEST(StylusStateModelerTest, SaveAndRestore) {
                   kTol, kAccelTol));
 }
 
+TEST(StylusStateModelerTest, QueryBatchEmpty) {
+  StylusStateModeler modeler;
+  std::vector<TipState> tips = {
+      {.position = {0, 0}, .time = Time(1)},
+      {.position = {3, 4}, .time = Time(2)},
+  };
+  std::vector<std::optional<Vec2>> normals = {std::nullopt, Vec2{0, 1}};
+  StylusStateModeler::BatchScratch scratch;
+  std::vector<Result> results;
+  modeler.QueryBatch(tips, normals, scratch, results);
+  EXPECT_THAT(results, ElementsAre(kUnknownResult, kUnknownResult));
+}
+
+TEST(StylusStateModelerTest, QueryBatchAppendsToResults) {
+  StylusStateModeler modeler;
+  modeler.Update({0, 0}, Time(0),
+                 {.pressure = .1, .tilt = .2, .orientation = .3});
+  modeler.Update({1, 0}, Time(1),
+                 {.pressure = .5, .tilt = .6, .orientation = .7});
+  std::vector<TipState> tips = {{.position = {.5, 1}, .time = Time(2)}};
+  std::vector<std::optional<Vec2>> normals = {std::nullopt};
+  StylusStateModeler::BatchScratch scratch;
+  std::vector<Result> results = {kUnknownResult};
+  modeler.QueryBatch(tips, normals, scratch, results);
+  EXPECT_THAT(results, ElementsAre(kUnknownResult,
+                                   modeler.Query(tips[0], normals[0])));
+}
+
+// Feeds a noisy, looping stroke to the modeler, and checks that QueryBatch()
+// gives exactly the same results as Query() for a batch of tip states near the
+// end of the stroke, with and without the stroke normal projection.
+TEST(StylusStateModelerTest, QueryBatchMatchesQueryOnLoopingStroke) {
+  std::mt19937 rng(54321);
+  std::uniform_real_distribution<float> noise(-.05, .05);
+  std::uniform_real_distribution<float> query_offset(-2, 2);
+  std::uniform_real_distribution<float> angle(0, 6.3);
+
+  for (bool use_stroke_normal_projection : {false, true}) {
+    StylusStateModeler modeler;
+    modeler.Reset({.use_stroke_normal_projection = use_stroke_normal_projection,
+                   .min_input_samples = 40,
+                   .min_sample_duration = Duration(1)});
+    std::vector<TipState> tips;
+    std::vector<std::optional<Vec2>> normals;
+    StylusStateModeler::BatchScratch scratch;
+    std::vector<Result> results;
+    for (int step = 0; step < 300; ++step) {
+      float t = step * .3f;
+      Vec2 point{1000 + std::cos(t) + .01f * t + noise(rng),
+                 -500 + std::sin(t) + noise(rng)};
+      modeler.Update(point, Time(t * .01),
+                     {.pressure = t, .tilt = .5, .orientation = 1});
+
+      tips.clear();
+      normals.clear();
+      for (int i = 0; i < 8; ++i) {
+        float a = angle(rng);
+        tips.push_back(
+            {.position = point + Vec2{query_offset(rng), query_offset(rng)},
+             .acceleration = {std::cos(a + 1), std::sin(a + 1)},
+             .time = Time(t * .01 + i)});
+        // Leave out the stroke normal for some tip states.
+        normals.push_back(i % 3 == 0 ? std::nullopt
+                                     : std::optional<Vec2>(
+                                           {std::cos(a), std::sin(a)}));
+      }
+
+      results.clear();
+      modeler.QueryBatch(tips, normals, scratch, results);
+      ASSERT_EQ(results.size(), tips.size());
+      for (int i = 0; i < static_cast<int>(tips.size()); ++i) {
+        EXPECT_EQ(results[i], modeler.Query(tips[i], normals[i]));
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace stroke_model
 }  // namespace ink
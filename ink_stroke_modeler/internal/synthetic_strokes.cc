@@ -0,0 +1,215 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ink_stroke_modeler/numbers.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+constexpr float kTwoPi = 2 * kPi;
+
+// The shape of a kSignature stroke, drawn from the seed.
+struct SignatureShape {
+  float loop_frequency;
+  float loop_width;
+  float loop_height;
+  float height_modulation_frequency;
+  float height_modulation_phase;
+};
+
+SignatureShape MakeSignatureShape(float size, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> unit(0, 1);
+  return {
+      .loop_frequency = kTwoPi * (4 + 4 * unit(rng)),
+      // The loop width times the angular frequency exceeds the drift speed,
+      // so that the path crosses back over itself.
+      .loop_width = size * (.06f + .04f * unit(rng)),
+      .loop_height = size * (.08f + .07f * unit(rng)),
+      .height_modulation_frequency = kTwoPi * (.5f + unit(rng)),
+      .height_modulation_phase = kTwoPi * unit(rng),
+  };
+}
+
+// Returns the position along the stroke, relative to its start, where
+// `progress` goes from 0 at the down event to 1 at the up event.
+Vec2 PathPosition(const SyntheticStrokeParams &params,
+                  const SignatureShape &signature, float progress) {
+  const float half_size = .5f * params.size;
+  switch (params.shape) {
+    case SyntheticStrokeShape::kLine: {
+      float distance = params.size * progress * progress * progress *
+                       (10 + progress * (-15 + 6 * progress));
+      // Draw the line at 30 degrees to the x-axis.
+      return {std::cos(kTwoPi / 12) * distance,
+              std::sin(kTwoPi / 12) * distance};
+    }
+    case SyntheticStrokeShape::kSpiral: {
+      float angle = 3 * kTwoPi * progress;
+      float radius = half_size * progress;
+      return {radius * std::cos(angle), radius * std::sin(angle)};
+    }
+    case SyntheticStrokeShape::kLissajous:
+      return {half_size * std::sin(3 * kTwoPi * progress),
+              half_size * std::sin(2 * kTwoPi * progress)};
+    case SyntheticStrokeShape::kSignature: {
+      float loop_angle = signature.loop_frequency * progress;
+      float height =
+          signature.loop_height *
+          (1 + .3f * std::sin(signature.height_modulation_frequency * progress +
+                              signature.height_modulation_phase));
+      return {params.size * progress +
+                  signature.loop_width * (std::cos(loop_angle) - 1),
+              height * std::sin(loop_angle)};
+    }
+  }
+  return {0, 0};
+}
+
+float Pressure(const SyntheticStrokeParams &params, float progress,
+               float speed) {
+  switch (params.pressure_profile) {
+    case SyntheticPressureProfile::kNone:
+      return -1;
+    case SyntheticPressureProfile::kConstant:
+      return .5;
+    case SyntheticPressureProfile::kTaper:
+      return .1f + .6f * std::min(1.f, std::min(progress, 1 - progress) / .1f);
+    case SyntheticPressureProfile::kSpeedDependent: {
+      // Scale the speed by that of drawing the whole stroke at once.
+      float typical_speed = params.size / params.duration.Value();
+      return .9f - .6f * speed / (speed + typical_speed);
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+std::vector<Input> GenerateSyntheticStroke(
+    const SyntheticStrokeParams &params) {
+  std::mt19937 rng(params.seed);
+  const SignatureShape signature = MakeSignatureShape(params.size, rng);
+
+  const int n_intervals = std::max<int>(
+      1, std::lround(params.duration.Value() * params.input_rate));
+  const Duration nominal_interval = params.duration / n_intervals;
+  // These are standard normal distributions, scaled at each draw, since a
+  // normal distribution with a standard deviation of zero is undefined.
+  const double jitter_stddev =
+      params.timestamp_jitter * nominal_interval.Value();
+  std::normal_distribution<double> jitter;
+  std::normal_distribution<float> noise;
+  std::bernoulli_distribution coalesce(
+      std::clamp(params.coalesce_probability, 0., 1.));
+
+  auto quantize = [&params](float value) {
+    if (params.quantization <= 0) return value;
+    return std::round(value / params.quantization) * params.quantization;
+  };
+
+  std::vector<Input> inputs;
+  inputs.reserve(n_intervals + 1);
+  for (int i = 0; i <= n_intervals; ++i) {
+    const float progress = static_cast<float>(i) / n_intervals;
+
+    Time time = params.start_time + nominal_interval * i;
+    if (i > 0) {
+      time = coalesce(rng) ? inputs.back().time
+                           : std::max(inputs.back().time,
+                                      time + Duration(jitter_stddev *
+                                                      jitter(rng)));
+    }
+
+    Vec2 position = params.origin + PathPosition(params, signature, progress);
+    if (params.position_noise > 0) {
+      position += params.position_noise * Vec2{noise(rng), noise(rng)};
+    }
+    position = {quantize(position.x), quantize(position.y)};
+
+    // Estimate the stylus velocity from the noiseless path.
+    constexpr float kDelta = 1e-3;
+    const Vec2 velocity =
+        (PathPosition(params, signature, progress + kDelta) -
+         PathPosition(params, signature, progress - kDelta)) /
+        (2 * kDelta * params.duration.Value());
+
+    float tilt = -1;
+    float orientation = -1;
+    switch (params.tilt_profile) {
+      case SyntheticTiltProfile::kNone:
+        break;
+      case SyntheticTiltProfile::kConstant:
+        tilt = .6;
+        orientation = 1;
+        break;
+      case SyntheticTiltProfile::kVarying:
+        tilt = .6f + .2f * std::sin(2 * kTwoPi * progress);
+        orientation = std::atan2(velocity.y, velocity.x);
+        if (orientation < 0) orientation += kTwoPi;
+        break;
+    }
+
+    Input::EventType event_type = Input::EventType::kMove;
+    if (i == 0) {
+      event_type = Input::EventType::kDown;
+    } else if (i == n_intervals) {
+      event_type = Input::EventType::kUp;
+    } else if (inputs.back().position == position &&
+               inputs.back().time == time) {
+      continue;
+    }
+    inputs.push_back(
+        {.event_type = event_type,
+         .position = position,
+         .time = time,
+         .pressure = Pressure(params, progress, velocity.Magnitude()),
+         .tilt = tilt,
+         .orientation = orientation});
+  }
+  return inputs;
+}
+
+StrokeModelParams RecommendedStrokeModelParams() {
+  return {.wobble_smoother_params{.timeout = Duration(.04),
+                                  .speed_floor = 1.31,
+                                  .speed_ceiling = 1.44},
+          .position_modeler_params{.spring_mass_constant = 11.f / 32400,
+                                   .drag_constant = 72.f},
+          .sampling_params{.min_output_rate = 180,
+                           .end_of_stroke_stopping_distance = .001,
+                           .end_of_stroke_max_iterations = 20},
+          .stylus_state_modeler_params{.max_input_samples = 20},
+          .prediction_params = KalmanPredictorParams{
+              .process_noise = .00026458,
+              .measurement_noise = .026458,
+              .min_catchup_velocity = .01,
+              .prediction_interval = Duration(1. / 60),
+              .confidence_params{.max_estimation_distance = .04,
+                                 .min_travel_speed = 3,
+                                 .max_travel_speed = 15,
+                                 .max_linear_deviation = .2}}};
+}
+
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_INTERNAL_SYNTHETIC_STROKES_H_
+#define INK_STROKE_MODELER_INTERNAL_SYNTHETIC_STROKES_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// The path traced by a synthetic stroke.
+enum class SyntheticStrokeShape {
+  // A straight line, with a minimum-jerk speed profile, i.e. accelerating from
+  // rest and decelerating to rest as a hand does.
+  kLine,
+  // An outward spiral of three turns, drawn at a constant angular speed.
+  kSpiral,
+  // A 3:2 Lissajous curve, which has sharp changes in curvature.
+  kLissajous,
+  // A cursive-like signature: forward drift with overlapping loops, whose
+  // sizes and frequencies are drawn from the seed.
+  kSignature,
+};
+
+// How pressure evolves over a synthetic stroke.
+enum class SyntheticPressureProfile {
+  // The pressure is not reported, i.e. it is -1.
+  kNone,
+  kConstant,
+  // The pressure ramps up after the down event and tapers off before the up
+  // event, as when landing and lifting the stylus.
+  kTaper,
+  // The pressure decreases as the stylus moves faster.
+  kSpeedDependent,
+};
+
+// How tilt and orientation evolve over a synthetic stroke.
+enum class SyntheticTiltProfile {
+  // The tilt and orientation are not reported, i.e. they are -1.
+  kNone,
+  kConstant,
+  // The tilt oscillates, and the orientation follows the direction of travel.
+  kVarying,
+};
+
+struct SyntheticStrokeParams {
+  SyntheticStrokeShape shape = SyntheticStrokeShape::kSpiral;
+
+  // The extent of the stroke, in the same units as Input::position. The stroke
+  // starts at `origin`.
+  float size = 10;
+  Vec2 origin{0, 0};
+
+  // The time of the down event, and the time taken to draw the stroke.
+  Time start_time{0};
+  Duration duration{1};
+
+  // The nominal rate at which the digitizer reports inputs, in Hz.
+  double input_rate = 240;
+
+  // The standard deviation of the difference between each input's time and
+  // its nominal time, as a fraction of the nominal interval between inputs.
+  // Times are kept non-decreasing.
+  double timestamp_jitter = 0;
+
+  // The probability that an input is delivered in the same batch as the one
+  // before, and so is stamped with the same time, as happens when the
+  // platform coalesces input events.
+  double coalesce_probability = 0;
+
+  // The standard deviation of the digitizer's noise, in the same units as
+  // Input::position, followed by the digitizer's resolution, to which each
+  // position is rounded. A resolution of zero disables the rounding. Inputs
+  // that are rounded to the same position and time as the input before are
+  // dropped, as the digitizer would not report them.
+  float position_noise = 0;
+  float quantization = 0;
+
+  SyntheticPressureProfile pressure_profile = SyntheticPressureProfile::kNone;
+  SyntheticTiltProfile tilt_profile = SyntheticTiltProfile::kNone;
+
+  // Seeds the noise and, for kSignature, the shape.
+  uint32_t seed = 0;
+};
+
+// Returns the inputs for a single stroke, i.e. a kDown, followed by kMoves, and
+// ending with a kUp. The result is deterministic for a given set of params.
+// Params are assumed to be finite, with a positive size, duration and input
+// rate; the generator is intended for tests and benchmarks, so it does not
+// validate them.
+std::vector<Input> GenerateSyntheticStroke(const SyntheticStrokeParams &params);
+
+// Returns the StrokeModelParams recommended in the README, but with the Kalman
+// predictor, as a realistic baseline for tests, benchmarks and tools.
+StrokeModelParams RecommendedStrokeModelParams();
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_INTERNAL_SYNTHETIC_STROKES_H_
@@ -0,0 +1,182 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink_stroke_modeler/internal/type_matchers.h"
+#include "ink_stroke_modeler/numbers.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Each;
+using ::testing::Field;
+using ::testing::FloatEq;
+using ::testing::Ge;
+using ::testing::SizeIs;
+
+void ExpectWellFormedStroke(const std::vector<Input> &inputs) {
+  ASSERT_THAT(inputs, SizeIs(Ge(2)));
+  EXPECT_EQ(inputs.front().event_type, Input::EventType::kDown);
+  EXPECT_EQ(inputs.back().event_type, Input::EventType::kUp);
+  for (size_t i = 1; i < inputs.size(); ++i) {
+    if (i + 1 < inputs.size()) {
+      EXPECT_EQ(inputs[i].event_type, Input::EventType::kMove);
+    }
+    EXPECT_GE(inputs[i].time, inputs[i - 1].time);
+    EXPECT_NE(inputs[i], inputs[i - 1]);
+  }
+}
+
+TEST(SyntheticStrokesTest, AllShapesAreWellFormed) {
+  for (SyntheticStrokeShape shape :
+       {SyntheticStrokeShape::kLine, SyntheticStrokeShape::kSpiral,
+        SyntheticStrokeShape::kLissajous, SyntheticStrokeShape::kSignature}) {
+    std::vector<Input> inputs = GenerateSyntheticStroke(
+        {.shape = shape, .origin = {3, 4}, .start_time = Time(2)});
+    ExpectWellFormedStroke(inputs);
+    // Inputs are evenly spaced at 240Hz over one second.
+    EXPECT_THAT(inputs, SizeIs(241));
+    EXPECT_THAT(inputs.front().position, Vec2Near({3, 4}, 1e-5));
+    EXPECT_EQ(inputs.front().time, Time(2));
+    EXPECT_THAT(inputs[120].time, TimeNear(Time(2.5), 1e-6));
+    EXPECT_THAT(inputs.back().time, TimeNear(Time(3), 1e-6));
+  }
+}
+
+TEST(SyntheticStrokesTest, ShapeEndpoints) {
+  EXPECT_THAT(
+      GenerateSyntheticStroke({.shape = SyntheticStrokeShape::kLine, .size = 2})
+          .back()
+          .position,
+      Vec2Near({std::sqrt(3.f), 1}, 1e-5));
+  EXPECT_THAT(GenerateSyntheticStroke(
+                  {.shape = SyntheticStrokeShape::kSpiral, .size = 2})
+                  .back()
+                  .position,
+              Vec2Near({1, 0}, 1e-5));
+  EXPECT_THAT(GenerateSyntheticStroke(
+                  {.shape = SyntheticStrokeShape::kLissajous, .size = 2})
+                  .back()
+                  .position,
+              Vec2Near({0, 0}, 1e-5));
+}
+
+TEST(SyntheticStrokesTest, InputRateAndDuration) {
+  EXPECT_THAT(GenerateSyntheticStroke(
+                  {.duration = Duration(.5), .input_rate = 120}),
+              SizeIs(61));
+  // There is always at least a down and an up event.
+  EXPECT_THAT(GenerateSyntheticStroke(
+                  {.duration = Duration(.001), .input_rate = 60}),
+              SizeIs(2));
+}
+
+TEST(SyntheticStrokesTest, DeterministicForSeed) {
+  SyntheticStrokeParams params{.shape = SyntheticStrokeShape::kSignature,
+                               .timestamp_jitter = .2,
+                               .coalesce_probability = .1,
+                               .position_noise = .01,
+                               .seed = 5};
+  EXPECT_EQ(GenerateSyntheticStroke(params), GenerateSyntheticStroke(params));
+  std::vector<Input> inputs = GenerateSyntheticStroke(params);
+  params.seed = 6;
+  EXPECT_NE(GenerateSyntheticStroke(params), inputs);
+}
+
+TEST(SyntheticStrokesTest, TimestampJitterAndCoalescing) {
+  std::vector<Input> inputs = GenerateSyntheticStroke(
+      {.timestamp_jitter = .3, .coalesce_probability = .25, .seed = 1});
+  ExpectWellFormedStroke(inputs);
+  int n_coalesced = 0;
+  int n_jittered = 0;
+  for (size_t i = 1; i < inputs.size(); ++i) {
+    if (inputs[i].time == inputs[i - 1].time) {
+      ++n_coalesced;
+    } else if (std::abs((inputs[i].time - Time(i / 240.)).Value()) > 1e-6) {
+      ++n_jittered;
+    }
+  }
+  EXPECT_GT(n_coalesced, 20);
+  EXPECT_LT(n_coalesced, 100);
+  EXPECT_GT(n_jittered, 100);
+}
+
+TEST(SyntheticStrokesTest, Quantization) {
+  std::vector<Input> inputs =
+      GenerateSyntheticStroke({.shape = SyntheticStrokeShape::kLine,
+                               .size = 1,
+                               .coalesce_probability = .5,
+                               .position_noise = .001,
+                               .quantization = .05});
+  ExpectWellFormedStroke(inputs);
+  for (const Input &input : inputs) {
+    EXPECT_NEAR(std::remainder(input.position.x, .05f), 0, 1e-5);
+    EXPECT_NEAR(std::remainder(input.position.y, .05f), 0, 1e-5);
+  }
+  // The line starts and ends slowly, so some coalesced inputs are rounded onto
+  // the same position as the input before, and are dropped.
+  EXPECT_LT(inputs.size(), 241);
+}
+
+TEST(SyntheticStrokesTest, PressureAndTiltProfiles) {
+  EXPECT_THAT(GenerateSyntheticStroke({}),
+              Each(AllOf(Field(&Input::pressure, FloatEq(-1)),
+                         Field(&Input::tilt, FloatEq(-1)),
+                         Field(&Input::orientation, FloatEq(-1)))));
+  EXPECT_THAT(
+      GenerateSyntheticStroke(
+          {.pressure_profile = SyntheticPressureProfile::kConstant,
+           .tilt_profile = SyntheticTiltProfile::kConstant}),
+      Each(AllOf(Field(&Input::pressure, FloatEq(.5)),
+                 Field(&Input::tilt, FloatEq(.6)),
+                 Field(&Input::orientation, FloatEq(1)))));
+
+  std::vector<Input> tapered = GenerateSyntheticStroke(
+      {.pressure_profile = SyntheticPressureProfile::kTaper});
+  EXPECT_FLOAT_EQ(tapered.front().pressure, .1);
+  EXPECT_FLOAT_EQ(tapered[120].pressure, .7);
+  EXPECT_FLOAT_EQ(tapered.back().pressure, .1);
+
+  // The line is fastest in the middle, so the pressure is lowest there.
+  std::vector<Input> speed_dependent =
+      GenerateSyntheticStroke({.shape = SyntheticStrokeShape::kLine,
+                               .pressure_profile =
+                                   SyntheticPressureProfile::kSpeedDependent});
+  EXPECT_NEAR(speed_dependent.front().pressure, .9, 1e-4);
+  EXPECT_LT(speed_dependent[120].pressure, speed_dependent[60].pressure);
+  EXPECT_LT(speed_dependent[60].pressure, speed_dependent.front().pressure);
+
+  // The orientation of the line follows its direction.
+  std::vector<Input> varying_tilt =
+      GenerateSyntheticStroke({.shape = SyntheticStrokeShape::kLine,
+                               .tilt_profile = SyntheticTiltProfile::kVarying});
+  EXPECT_NEAR(varying_tilt[120].orientation, kPi / 6, 1e-4);
+  for (const Input &input : varying_tilt) {
+    EXPECT_GE(input.tilt, 0);
+    EXPECT_LE(input.tilt, kPi / 2);
+  }
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
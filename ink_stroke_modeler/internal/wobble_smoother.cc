@@ -23,11 +23,9 @@ namespace stroke_model {
 
 void WobbleSmoother::Reset(const WobbleSmootherParams& params, Vec2 position,
                            Time time) {
-  state_.samples.clear();
-  state_.weighted_position_sum = Vec2{0, 0};
-  state_.distance_sum = 0;
-  state_.duration_sum = 0;
-  state_.samples.push_back({.position = position, .time = time});
+  state_.samples.Clear();
+  state_.samples.PushBack(time, {0, 0, 0, 0});
+  state_.last_position = position;
 
   save_active_ = false;
 
@@ -42,24 +40,17 @@ Vec2 WobbleSmoother::Update(Vec2 position, Time time) {
   // of the touch digitizer. To compensate for the distance between the average
   // position and the actual position, we interpolate between them, based on
   // speed, to determine the position to use for the input model.
-  Duration delta_time = time - state_.samples.back().time;
-  state_.samples.push_back(
-      {.position = position,
-       .weighted_position = position * delta_time.Value(),
-       .distance = Distance(position, state_.samples.back().position),
-       .duration = delta_time,
-       .time = time});
-  state_.weighted_position_sum += state_.samples.back().weighted_position;
-  state_.distance_sum += state_.samples.back().distance;
-  state_.duration_sum += state_.samples.back().duration.Value();
-  while (state_.samples.front().time < time - params_.timeout) {
-    state_.weighted_position_sum -= state_.samples.front().weighted_position;
-    state_.distance_sum -= state_.samples.front().distance;
-    state_.duration_sum -= state_.samples.front().duration.Value();
-    state_.samples.pop_front();
+  double delta_time = (time - state_.samples.BackTime()).Value();
+  state_.samples.PushBack(
+      time, {position.x * delta_time, position.y * delta_time,
+             Distance(position, state_.last_position), delta_time});
+  state_.last_position = position;
+  while (state_.samples.FrontTime() < time - params_.timeout) {
+    state_.samples.PopFront();
   }
 
-  if (state_.duration_sum == 0) {
+  double duration_sum = state_.samples.Sum(kDuration);
+  if (duration_sum == 0) {
     return position;
   }
   // Average of sample positions, weighted by the duration of the preceeding
@@ -68,9 +59,12 @@ Vec2 WobbleSmoother::Update(Vec2 position, Time time) {
   // params. Also, this is only looking at the first of a set of postions with
   // identical timestamps instead of doing someting more complicated in that
   // edge-case.)
-  Vec2 avg_position = state_.weighted_position_sum / state_.duration_sum;
+  Vec2 avg_position{
+      static_cast<float>(state_.samples.Sum(kWeightedPositionX) / duration_sum),
+      static_cast<float>(state_.samples.Sum(kWeightedPositionY) /
+                         duration_sum)};
   // Estimate of physical average speed.
-  float avg_speed = state_.distance_sum / state_.duration_sum;
+  float avg_speed = state_.samples.Sum(kDistance) / duration_sum;
   return Interp(
       avg_position, position,
       Normalize01(params_.speed_floor, params_.speed_ceiling, avg_speed));
@@ -85,5 +79,10 @@ void WobbleSmoother::Restore() {
   if (save_active_) state_ = saved_state_;
 }
 
+void WobbleSmoother::CopyStateFrom(const WobbleSmoother &other) {
+  state_ = other.state_;
+  params_ = other.params_;
+}
+
 }  // namespace stroke_model
 }  // namespace ink
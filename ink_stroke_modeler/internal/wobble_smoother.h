@@ -17,8 +17,7 @@
 #ifndef INK_STROKE_MODELER_INTERNAL_WOBBLE_SMOOTHER_H_
 #define INK_STROKE_MODELER_INTERNAL_WOBBLE_SMOOTHER_H_
 
-#include <deque>
-
+#include "ink_stroke_modeler/internal/sliding_window_stats.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
 
@@ -46,28 +45,33 @@ class WobbleSmoother {
   // StrokeModeler::Restore() for more details.
   void Restore();
 
+  // Copies the current state and parameters of `other`, but not its saved
+  // state. See comment on StrokeModeler::ModelHypothetical() for more details.
+  void CopyStateFrom(const WobbleSmoother &other);
+
  private:
-  struct Sample {
-    Vec2 position{0, 0};
-    Vec2 weighted_position{0, 0};
-    float distance = 0;
-    Duration duration{0};
-    Time time{0};
+  // Indices of the values tracked for each sample in the moving average
+  // window.
+  enum SampleValue {
+    kWeightedPositionX,
+    kWeightedPositionY,
+    kDistance,
+    kDuration,
+    kNumSampleValues,
   };
 
   struct State {
-    std::deque<Sample> samples;
-    Vec2 weighted_position_sum{0, 0};
-    float distance_sum = 0;
-    float duration_sum = 0;
+    SlidingWindowStats<kNumSampleValues> samples;
+    Vec2 last_position{0, 0};
   };
 
   State state_;
 
   // Use a State + bool instead of optional<State> for performance. State
-  // contains a std::deque, which has a non-trivial destructor that would
-  // deallocate its capacity. This setup avoids extra calls to the destructor
-  // that would be triggered by each call to std::optional::reset().
+  // contains a std::deque (via SlidingWindowStats), which has a non-trivial
+  // destructor that would deallocate its capacity. This setup avoids extra
+  // calls to the destructor that would be triggered by each call to
+  // std::optional::reset().
   State saved_state_;
   bool save_active_ = false;
 
@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/latency_histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+// Histograms are only written by Record() and its kin, and are only read for
+// reporting, so none of the accesses need to be ordered with respect to
+// anything else.
+constexpr std::memory_order kRelaxed = std::memory_order_relaxed;
+
+void UpdateMax(std::atomic<int64_t> &max, int64_t value) {
+  int64_t current = max.load(kRelaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value, kRelaxed)) {
+  }
+}
+
+}  // namespace
+
+LatencyHistogram &LatencyHistogram::operator=(const LatencyHistogram &other) {
+  if (this == &other) return *this;
+  for (int i = 0; i < kBucketCount; ++i) {
+    buckets_[i].store(other.buckets_[i].load(kRelaxed), kRelaxed);
+  }
+  total_ns_.store(other.total_ns_.load(kRelaxed), kRelaxed);
+  max_ns_.store(other.max_ns_.load(kRelaxed), kRelaxed);
+  return *this;
+}
+
+int LatencyHistogram::BucketIndex(int64_t latency_ns) {
+  const uint64_t value = static_cast<uint64_t>(
+      std::clamp<int64_t>(latency_ns, 0, kMaxLatencyNanoseconds));
+  if (value < kSubBucketCount) return static_cast<int>(value);
+  // The value is in [2^exponent, 2^(exponent + 1)), which is split into
+  // kSubBucketCount buckets, indexed by the kSubBucketBits bits after the
+  // leading one.
+  const int exponent = std::bit_width(value) - 1;
+  const int shift = exponent - kSubBucketBits;
+  const int sub_bucket = static_cast<int>(value >> shift) - kSubBucketCount;
+  return kSubBucketCount * (shift + 1) + sub_bucket;
+}
+
+int64_t LatencyHistogram::BucketUpperBoundNanoseconds(int index) {
+  if (index < kSubBucketCount) return index;
+  const int shift = index / kSubBucketCount - 1;
+  const int64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::RecordNanoseconds(int64_t latency_ns) {
+  latency_ns = std::max<int64_t>(latency_ns, 0);
+  buckets_[BucketIndex(latency_ns)].fetch_add(1, kRelaxed);
+  total_ns_.fetch_add(latency_ns, kRelaxed);
+  UpdateMax(max_ns_, latency_ns);
+}
+
+int64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (const std::atomic<uint64_t> &bucket : buckets_) {
+    count += bucket.load(kRelaxed);
+  }
+  return static_cast<int64_t>(count);
+}
+
+absl::Duration LatencyHistogram::Mean() const {
+  const int64_t count = Count();
+  if (count == 0) return absl::ZeroDuration();
+  return absl::Nanoseconds(static_cast<double>(total_ns_.load(kRelaxed)) /
+                           count);
+}
+
+absl::Duration LatencyHistogram::Max() const {
+  return absl::Nanoseconds(max_ns_.load(kRelaxed));
+}
+
+absl::Duration LatencyHistogram::Quantile(double quantile) const {
+  const int64_t count = Count();
+  if (count == 0) return absl::ZeroDuration();
+  // The rank, counting from one, of the latency at the quantile.
+  const int64_t rank = std::clamp<int64_t>(
+      static_cast<int64_t>(std::ceil(std::clamp(quantile, 0., 1.) * count)), 1,
+      count);
+  int64_t seen = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i].load(kRelaxed);
+    if (seen >= rank) {
+      // The bucket's upper bound can exceed every latency in it, most notably
+      // in the bucket holding the maximum.
+      return std::min(absl::Nanoseconds(BucketUpperBoundNanoseconds(i)), Max());
+    }
+  }
+  // Only reachable if latencies are recorded concurrently with this call.
+  return Max();
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  for (int i = 0; i < kBucketCount; ++i) {
+    if (uint64_t n = other.buckets_[i].load(kRelaxed); n != 0) {
+      buckets_[i].fetch_add(n, kRelaxed);
+    }
+  }
+  total_ns_.fetch_add(other.total_ns_.load(kRelaxed), kRelaxed);
+  UpdateMax(max_ns_, other.max_ns_.load(kRelaxed));
+}
+
+void LatencyHistogram::Reset() {
+  for (std::atomic<uint64_t> &bucket : buckets_) bucket.store(0, kRelaxed);
+  total_ns_.store(0, kRelaxed);
+  max_ns_.store(0, kRelaxed);
+}
+
+}  // namespace stroke_model
+}  // namespace ink
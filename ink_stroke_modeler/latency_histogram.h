@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_LATENCY_HISTOGRAM_H_
+#define INK_STROKE_MODELER_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace ink {
+namespace stroke_model {
+
+// A histogram of latencies, with logarithmically-spaced buckets in the style of
+// HdrHistogram: each power of two is split into kSubBucketCount equal buckets,
+// so a latency is known to within 1 part in kSubBucketCount (about 3%),
+// however small or large it is. Latencies below kSubBucketCount nanoseconds are
+// recorded exactly; latencies from kMaxLatency upwards are counted in the last
+// bucket.
+//
+// The buckets are stored inline, so recording never allocates. Record() may be
+// called concurrently from multiple threads; reading the histogram while it's
+// being recorded into gives a result that may include only some of the
+// concurrent records.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+  // The number of powers of two covered by the buckets, above the exact ones.
+  static constexpr int kOctaveCount = 31;
+  static constexpr int kBucketCount = kSubBucketCount * (kOctaveCount + 1);
+  // About 68.7 seconds.
+  static constexpr int64_t kMaxLatencyNanoseconds =
+      (int64_t{1} << (kSubBucketBits + kOctaveCount)) - 1;
+  static constexpr absl::Duration kMaxLatency =
+      absl::Nanoseconds(kMaxLatencyNanoseconds);
+
+  LatencyHistogram() = default;
+  LatencyHistogram(const LatencyHistogram &other) { *this = other; }
+  LatencyHistogram &operator=(const LatencyHistogram &other);
+
+  // Negative latencies are recorded as zero.
+  void Record(absl::Duration latency) {
+    RecordNanoseconds(absl::ToInt64Nanoseconds(latency));
+  }
+  void RecordNanoseconds(int64_t latency_ns);
+
+  // Returns the number of latencies recorded.
+  int64_t Count() const;
+
+  // Returns the mean and maximum latencies recorded, or zero if none have
+  // been. The mean is exact, up to nanosecond rounding, and the maximum is
+  // exact up to kMaxLatency.
+  absl::Duration Mean() const;
+  absl::Duration Max() const;
+
+  // Returns the latency at the given quantile, e.g. .99 for the 99th
+  // percentile, i.e. the smallest latency that is at least as great as that
+  // fraction of the recorded latencies, to within the precision of the
+  // buckets. The quantile is clamped to [0, 1]. Returns zero if no latencies
+  // have been recorded.
+  absl::Duration Quantile(double quantile) const;
+
+  // Adds the latencies recorded by `other` to this histogram, e.g. to
+  // aggregate across StrokeModelers.
+  void Merge(const LatencyHistogram &other);
+
+  // Clears all recorded latencies.
+  void Reset();
+
+  // Returns the index of the bucket that `latency_ns` is counted in, and the
+  // greatest latency that is counted in a bucket.
+  static int BucketIndex(int64_t latency_ns);
+  static int64_t BucketUpperBoundNanoseconds(int index);
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+  std::atomic<int64_t> total_ns_ = 0;
+  std::atomic<int64_t> max_ns_ = 0;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_LATENCY_HISTOGRAM_H_
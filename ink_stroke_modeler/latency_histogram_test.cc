@@ -0,0 +1,179 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/latency_histogram.h"
+
+#include <cstdint>
+#include <limits>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Mean(), absl::ZeroDuration());
+  EXPECT_EQ(histogram.Max(), absl::ZeroDuration());
+  EXPECT_EQ(histogram.Quantile(.5), absl::ZeroDuration());
+}
+
+TEST(LatencyHistogramTest, BucketsCoverAllLatencies) {
+  // Each bucket starts just after the previous one ends.
+  EXPECT_EQ(LatencyHistogram::BucketUpperBoundNanoseconds(0), 0);
+  for (int i = 1; i < LatencyHistogram::kBucketCount; ++i) {
+    const int64_t lower =
+        LatencyHistogram::BucketUpperBoundNanoseconds(i - 1) + 1;
+    const int64_t upper = LatencyHistogram::BucketUpperBoundNanoseconds(i);
+    ASSERT_GE(upper, lower) << "bucket " << i;
+    EXPECT_EQ(LatencyHistogram::BucketIndex(lower), i);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(upper), i);
+  }
+  EXPECT_EQ(LatencyHistogram::BucketUpperBoundNanoseconds(
+                LatencyHistogram::kBucketCount - 1),
+            LatencyHistogram::kMaxLatencyNanoseconds);
+}
+
+TEST(LatencyHistogramTest, BucketsHaveBoundedRelativeWidth) {
+  for (int i = LatencyHistogram::kSubBucketCount;
+       i < LatencyHistogram::kBucketCount; ++i) {
+    const int64_t lower =
+        LatencyHistogram::BucketUpperBoundNanoseconds(i - 1) + 1;
+    const int64_t upper = LatencyHistogram::BucketUpperBoundNanoseconds(i);
+    EXPECT_LE(static_cast<double>(upper - lower + 1) / lower,
+              1. / LatencyHistogram::kSubBucketCount)
+        << "bucket " << i;
+  }
+}
+
+TEST(LatencyHistogramTest, OutOfRangeLatenciesAreClamped) {
+  EXPECT_EQ(LatencyHistogram::BucketIndex(-5), 0);
+  constexpr int64_t kMaxNs = LatencyHistogram::kMaxLatencyNanoseconds;
+  EXPECT_EQ(LatencyHistogram::BucketIndex(kMaxNs + 1),
+            LatencyHistogram::kBucketCount - 1);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(std::numeric_limits<int64_t>::max()),
+            LatencyHistogram::kBucketCount - 1);
+
+  LatencyHistogram histogram;
+  histogram.Record(absl::Nanoseconds(-5));
+  EXPECT_EQ(histogram.Count(), 1);
+  EXPECT_EQ(histogram.Max(), absl::ZeroDuration());
+  EXPECT_EQ(histogram.Quantile(1), absl::ZeroDuration());
+}
+
+TEST(LatencyHistogramTest, SmallLatenciesAreExact) {
+  LatencyHistogram histogram;
+  for (int ns = 1; ns <= 10; ++ns) histogram.RecordNanoseconds(ns);
+
+  EXPECT_EQ(histogram.Count(), 10);
+  EXPECT_EQ(histogram.Mean(), absl::Nanoseconds(5.5));
+  EXPECT_EQ(histogram.Max(), absl::Nanoseconds(10));
+  EXPECT_EQ(histogram.Quantile(0), absl::Nanoseconds(1));
+  EXPECT_EQ(histogram.Quantile(.1), absl::Nanoseconds(1));
+  EXPECT_EQ(histogram.Quantile(.11), absl::Nanoseconds(2));
+  EXPECT_EQ(histogram.Quantile(.5), absl::Nanoseconds(5));
+  EXPECT_EQ(histogram.Quantile(1), absl::Nanoseconds(10));
+  EXPECT_EQ(histogram.Quantile(2), absl::Nanoseconds(10));
+}
+
+TEST(LatencyHistogramTest, QuantilesAreWithinBucketPrecision) {
+  // 1us, 2us, ..., 1000us.
+  LatencyHistogram histogram;
+  for (int us = 1; us <= 1000; ++us) {
+    histogram.Record(absl::Microseconds(us));
+  }
+
+  EXPECT_EQ(histogram.Count(), 1000);
+  EXPECT_EQ(histogram.Mean(), absl::Microseconds(500.5));
+  EXPECT_EQ(histogram.Max(), absl::Microseconds(1000));
+  for (double quantile : {.5, .9, .99, .999}) {
+    const absl::Duration expected = absl::Microseconds(quantile * 1000);
+    const absl::Duration actual = histogram.Quantile(quantile);
+    EXPECT_GE(actual, expected) << quantile;
+    EXPECT_LE(actual,
+              expected * (1 + 1. / LatencyHistogram::kSubBucketCount))
+        << quantile;
+  }
+  EXPECT_EQ(histogram.Quantile(1), absl::Microseconds(1000));
+}
+
+TEST(LatencyHistogramTest, Merge) {
+  LatencyHistogram a;
+  a.RecordNanoseconds(1);
+  a.RecordNanoseconds(2);
+  LatencyHistogram b;
+  b.RecordNanoseconds(3);
+  b.RecordNanoseconds(30);
+
+  a.Merge(b);
+  EXPECT_EQ(a.Count(), 4);
+  EXPECT_EQ(a.Mean(), absl::Nanoseconds(9));
+  EXPECT_EQ(a.Max(), absl::Nanoseconds(30));
+  EXPECT_EQ(a.Quantile(.75), absl::Nanoseconds(3));
+  // The other histogram is unchanged.
+  EXPECT_EQ(b.Count(), 2);
+}
+
+TEST(LatencyHistogramTest, Copy) {
+  LatencyHistogram a;
+  a.RecordNanoseconds(7);
+  LatencyHistogram b = a;
+  a.RecordNanoseconds(9);
+
+  EXPECT_EQ(a.Count(), 2);
+  EXPECT_EQ(b.Count(), 1);
+  EXPECT_EQ(b.Max(), absl::Nanoseconds(7));
+
+  b = a;
+  EXPECT_EQ(b.Count(), 2);
+  EXPECT_EQ(b.Max(), absl::Nanoseconds(9));
+}
+
+TEST(LatencyHistogramTest, Reset) {
+  LatencyHistogram histogram;
+  histogram.Record(absl::Milliseconds(3));
+  histogram.Reset();
+
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Mean(), absl::ZeroDuration());
+  EXPECT_EQ(histogram.Max(), absl::ZeroDuration());
+  EXPECT_EQ(histogram.Quantile(1), absl::ZeroDuration());
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecord) {
+  constexpr int kThreads = 4;
+  constexpr int kRecordsPerThread = 10000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&histogram, t] {
+      for (int i = 0; i < kRecordsPerThread; ++i) {
+        histogram.RecordNanoseconds(t * 1000 + i % 100);
+      }
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+
+  EXPECT_EQ(histogram.Count(), kThreads * kRecordsPerThread);
+  EXPECT_EQ(histogram.Max(), absl::Nanoseconds((kThreads - 1) * 1000 + 99));
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
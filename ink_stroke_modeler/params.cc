@@ -100,6 +100,14 @@ absl::Status ValidatePositionModelerParams(
   RETURN_IF_ERROR(
       ValidateGreaterThanZero(params.spring_mass_constant,
                               "PositionModelerParams::spring_mass_constant"));
+  if (params.integrator != PositionModelerParams::Integrator::kExact &&
+      params.integrator !=
+          PositionModelerParams::Integrator::kSemiImplicitEuler) {
+    return absl::InvalidArgumentError(
+        absl::Substitute("PositionModelerParams::integrator has an unknown "
+                         "value: $0",
+                         static_cast<int>(params.integrator)));
+  }
   return ValidateGreaterThanZero(params.drag_constant,
                                  "PositionModelerParams::drag_ratio");
 }
@@ -233,6 +241,24 @@ absl::Status ValidateKalmanPredictorParams(
   return absl::OkStatus();
 }
 
+absl::Status ValidateInputCoalescingParams(
+    const InputCoalescingParams& params) {
+  if (!params.is_enabled) return absl::OkStatus();
+
+  RETURN_IF_ERROR(ValidateGreaterThanOrEqualToZero(
+      params.position_tolerance, "InputCoalescingParams::position_tolerance"));
+  RETURN_IF_ERROR(ValidateGreaterThanOrEqualToZero(
+      params.pressure_tolerance, "InputCoalescingParams::pressure_tolerance"));
+  RETURN_IF_ERROR(ValidateGreaterThanOrEqualToZero(
+      params.tilt_tolerance, "InputCoalescingParams::tilt_tolerance"));
+  RETURN_IF_ERROR(ValidateGreaterThanOrEqualToZero(
+      params.orientation_tolerance,
+      "InputCoalescingParams::orientation_tolerance"));
+  return ValidateGreaterThanOrEqualToZero(
+      params.max_skipped_duration.Value(),
+      "InputCoalescingParams::max_skipped_duration");
+}
+
 }  // namespace
 
 absl::Status ValidatePredictionParams(const PredictionParams& params) {
@@ -261,6 +287,8 @@ absl::Status ValidateStrokeModelParams(const StrokeModelParams& params) {
   RETURN_IF_ERROR(ValidateSamplingParams(params.sampling_params));
   RETURN_IF_ERROR(
       ValidateStylusStateModelerParams(params.stylus_state_modeler_params));
+  RETURN_IF_ERROR(
+      ValidateInputCoalescingParams(params.input_coalescing_params));
   return ValidatePredictionParams(params.prediction_params);
 }
 
@@ -109,6 +109,23 @@ struct PositionModelerParams {
   };
 
   LoopContractionMitigationParameters loop_contraction_mitigation_params;
+
+  // The method used to advance the spring model from one output to the next.
+  enum class Integrator {
+    // A fixed-step semi-implicit Euler method. This is only accurate, and only
+    // stable, for time steps that are small relative to the spring's natural
+    // period, which is why `SamplingParams::min_output_rate` and
+    // `SamplingParams::max_estimated_angle_to_traverse_per_input` need to
+    // oversample the inputs.
+    kSemiImplicitEuler,
+    // The closed-form solution of the spring-damper, with the anchor moving
+    // linearly between inputs. This is exact for any time step, so the modeled
+    // positions don't depend on how densely the stroke is sampled, and the
+    // sampling parameters only need to be as high as is wanted for output
+    // density.
+    kExact,
+  };
+  Integrator integrator = Integrator::kSemiImplicitEuler;
 };
 
 // These parameters are used for sampling.
@@ -133,7 +150,9 @@ struct SamplingParams {
 
   // Maximum number of outputs to generate per call to Update or Predict.
   // This limit avoids crashes if input events are received with too long of
-  // a time between, possibly because a client was suspended and resumed.
+  // a time between, possibly because a client was suspended and resumed. It
+  // doesn't apply to budgeted calls to Update, whose UpdateBudget already
+  // bounds the work per call.
   int max_outputs_per_call = 100000;
 
   // Max absolute value of estimated angle to traverse in a single upsampled
@@ -142,6 +161,14 @@ struct SamplingParams {
   // to the input without any upsampling. If set to -1 (the default), input is
   // not upsampled for this reason.
   double max_estimated_angle_to_traverse_per_input = -1;
+
+  // If true, time is measured internally relative to the down event of the
+  // stroke in progress, and the times of the Results are converted back to
+  // the time base of the inputs. This keeps the internal timestamps small, so
+  // that no precision is lost when they're interpolated or offset by
+  // durations, even if the inputs carry large absolute timestamps, e.g. from
+  // the Unix epoch. The Results are otherwise unaffected.
+  bool use_stroke_relative_time = false;
 };
 
 // These parameters are used for modeling the non-positional state of the stylus
@@ -305,6 +332,19 @@ struct KalmanPredictorParams {
     float baseline_linearity_confidence = .4;
   };
   ConfidenceParams confidence_params;
+
+  // If true, the error covariance of the Kalman filters is kept when the
+  // predictor is reset at the start of a new stroke; only the estimated state
+  // is reset. Once the predictor has been stable during a previous stroke,
+  // this allows it to make a prediction after the second input of a stroke,
+  // instead of waiting for `min_stable_iteration` inputs.
+  //
+  // The error covariance depends only on the noise parameters and the number
+  // of inputs, not on their values, so it converges to the same value for
+  // every stroke. Note, however, that the estimated velocity, acceleration, and
+  // jerk still start at zero, so the first few predictions of each stroke tend
+  // to be shorter.
+  bool carry_over_error_covariance = false;
 };
 
 // Type used to indicate that no prediction strategy should be used. Attempting
@@ -315,6 +355,35 @@ using PredictionParams =
     std::variant<StrokeEndPredictorParams, KalmanPredictorParams,
                  DisabledPredictorParams>;
 
+// These parameters are used for skipping move inputs that are redundant, e.g.
+// at high input rates, where many consecutive inputs differ by less than the
+// resolution of the digitizer.
+struct InputCoalescingParams {
+  // If true, a move input is skipped if it differs from the most recent
+  // modeled input by no more than all of the tolerances below, and it's no
+  // more than `max_skipped_duration` after it. If false, no inputs are
+  // skipped, and the remainder of the parameters in the struct will be
+  // ignored.
+  bool is_enabled = false;
+
+  // The tolerances on the difference in each field of the Input. The
+  // tolerance for position is on the distance between the positions, and the
+  // tolerance for orientation is on the smaller of the two angles between the
+  // orientations. An input whose pressure, tilt, or orientation is NaN is
+  // never skipped.
+  float position_tolerance = 0;
+  float pressure_tolerance = 0;
+  float tilt_tolerance = 0;
+  float orientation_tolerance = 0;
+
+  // The maximum time between the most recent modeled input and a skipped
+  // input. This bounds the time over which the model can fall behind, e.g.
+  // while the stylus is held still.
+  //
+  // A good starting point is a few times the expected interval between inputs.
+  Duration max_skipped_duration{0};
+};
+
 // Temporary params governing experimental changes in behavior. Any params
 // here may be removed without warning in a future release.
 struct ExperimentalParams {};
@@ -328,6 +397,7 @@ struct StrokeModelParams {
   StylusStateModelerParams stylus_state_modeler_params;
   PredictionParams prediction_params = StrokeEndPredictorParams{};
   ExperimentalParams experimental_params;
+  InputCoalescingParams input_coalescing_params;
 };
 
 // This validation function will return an error if the given parameter is
@@ -80,6 +80,19 @@ TEST(ParamsTest, ValidatePositionModelerParams) {
                         .min_discrete_speed_samples = 10}})
                   .ok());
 
+  EXPECT_TRUE(ValidatePositionModelerParams(
+                  {.spring_mass_constant = 1,
+                   .drag_constant = 3,
+                   .integrator = PositionModelerParams::Integrator::kExact})
+                  .ok());
+
+  EXPECT_EQ(ValidatePositionModelerParams(
+                {.spring_mass_constant = 1,
+                 .drag_constant = 3,
+                 .integrator =
+                     static_cast<PositionModelerParams::Integrator>(-1)})
+                .code(),
+            absl::StatusCode::kInvalidArgument);
   EXPECT_EQ(ValidatePositionModelerParams(
                 {.spring_mass_constant = 0, .drag_constant = 1})
                 .code(),
@@ -362,6 +375,42 @@ TEST(ParamsTest, ValidateStrokeModelParams) {
   }
 }
 
+TEST(ParamsTest, ValidateInputCoalescingParams) {
+  auto params = kGoodStrokeModelParams;
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .position_tolerance = .01,
+                                    .pressure_tolerance = .02,
+                                    .tilt_tolerance = .03,
+                                    .orientation_tolerance = .04,
+                                    .max_skipped_duration = Duration(.01)};
+  EXPECT_TRUE(ValidateStrokeModelParams(params).ok());
+
+  // This is valid because `is_enabled` is false; otherwise, this would not be a
+  // valid configuration.
+  params.input_coalescing_params = {.is_enabled = false,
+                                    .position_tolerance = -1,
+                                    .max_skipped_duration = Duration(-1)};
+  EXPECT_TRUE(ValidateStrokeModelParams(params).ok());
+
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .position_tolerance = -1};
+  EXPECT_EQ(ValidateStrokeModelParams(params).code(),
+            absl::StatusCode::kInvalidArgument);
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .orientation_tolerance = -1};
+  EXPECT_EQ(ValidateStrokeModelParams(params).code(),
+            absl::StatusCode::kInvalidArgument);
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .max_skipped_duration = Duration(-1)};
+  EXPECT_EQ(ValidateStrokeModelParams(params).code(),
+            absl::StatusCode::kInvalidArgument);
+  params.input_coalescing_params = {
+      .is_enabled = true,
+      .pressure_tolerance = std::numeric_limits<float>::quiet_NaN()};
+  EXPECT_EQ(ValidateStrokeModelParams(params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST(ParamsTest, NaNIsNotAValidValue) {
   auto bad_params = kGoodStrokeModelParams;
   bad_params.position_modeler_params.spring_mass_constant =
@@ -0,0 +1,255 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/substitute.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// The ring's memory consists of this header, followed by `capacity`
+// Slots. Since the memory may be shared between processes
+// built from different versions of the library, anything that changes the
+// layout must also change kLayoutVersion.
+struct ResultBroadcastRingHeader {
+  uint32_t magic;
+  uint32_t layout_version;
+  int32_t capacity;
+  int32_t record_size;
+  // The number of Results published so far.
+  std::atomic<uint64_t> n_published;
+};
+
+namespace {
+
+constexpr uint32_t kMagic = 0x494e4b52;  // "INKR"
+constexpr uint32_t kLayoutVersion = 1;
+
+static_assert(std::is_trivially_copyable_v<BroadcastResult>);
+static_assert(sizeof(BroadcastResult) % sizeof(uint32_t) == 0);
+constexpr int kWordsPerRecord = sizeof(BroadcastResult) / sizeof(uint32_t);
+
+// The atomics must be address-free to be shared between processes, which in
+// practice means lock-free.
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+// Each slot is a seqlock: the writer makes `sequence` odd while it's writing
+// the slot, and even once it's done. A reader copies the record, then checks
+// that `sequence` didn't change while it was doing so. The record is stored as
+// relaxed atomic words, so that a reader racing with the writer reads a torn
+// (and discarded) record, rather than causing undefined behavior.
+struct Slot {
+  // For the Result with index `i`, this is 2 * i + 1 while the Result is being
+  // written, and 2 * i + 2 once it has been written.
+  std::atomic<uint64_t> sequence;
+  std::array<std::atomic<uint32_t>, kWordsPerRecord> words;
+};
+
+uint64_t WritingSequence(uint64_t index) { return 2 * index + 1; }
+uint64_t WrittenSequence(uint64_t index) { return 2 * index + 2; }
+
+Slot *Slots(ResultBroadcastRingHeader *header) {
+  return reinterpret_cast<Slot *>(header + 1);
+}
+
+const Slot *Slots(const ResultBroadcastRingHeader *header) {
+  return reinterpret_cast<const Slot *>(header + 1);
+}
+
+void WriteSlot(Slot &slot, uint64_t index, const BroadcastResult &record) {
+  std::array<uint32_t, kWordsPerRecord> words;
+  std::memcpy(words.data(), &record, sizeof(record));
+
+  slot.sequence.store(WritingSequence(index), std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (int i = 0; i < kWordsPerRecord; ++i) {
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot.sequence.store(WrittenSequence(index), std::memory_order_release);
+}
+
+enum class SlotState { kNotYetWritten, kRead, kOverwritten };
+
+SlotState ReadSlot(const Slot &slot, uint64_t index, BroadcastResult &record) {
+  uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+  if (sequence < WrittenSequence(index)) return SlotState::kNotYetWritten;
+  if (sequence > WrittenSequence(index)) return SlotState::kOverwritten;
+
+  std::array<uint32_t, kWordsPerRecord> words;
+  for (int i = 0; i < kWordsPerRecord; ++i) {
+    words[i] = slot.words[i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+    return SlotState::kOverwritten;
+  }
+  // BroadcastResult has default member initializers, so it isn't trivial, but
+  // it is trivially copyable, as asserted above.
+  std::memcpy(static_cast<void *>(&record), words.data(), sizeof(record));
+  return SlotState::kRead;
+}
+
+}  // namespace
+
+size_t ResultBroadcastWriter::RequiredBytes(int capacity) {
+  return sizeof(ResultBroadcastRingHeader) +
+         sizeof(Slot) * static_cast<size_t>(capacity > 0 ? capacity : 0);
+}
+
+absl::StatusOr<ResultBroadcastWriter> ResultBroadcastWriter::Create(
+    absl::Span<std::byte> memory, int capacity) {
+  if (capacity <= 0) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "capacity must be greater than zero. Actual value: $0", capacity));
+  }
+  if (memory.size() < RequiredBytes(capacity)) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "A ring with capacity $0 needs $1 bytes of memory, but only $2 were "
+        "provided",
+        capacity, RequiredBytes(capacity), memory.size()));
+  }
+  if (reinterpret_cast<uintptr_t>(memory.data()) %
+          alignof(ResultBroadcastRingHeader) !=
+      0) {
+    return absl::InvalidArgumentError(
+        absl::Substitute("Ring memory must be aligned to $0 bytes",
+                         alignof(ResultBroadcastRingHeader)));
+  }
+
+  auto *header = new (memory.data()) ResultBroadcastRingHeader{
+      .magic = kMagic,
+      .layout_version = kLayoutVersion,
+      .capacity = capacity,
+      .record_size = sizeof(BroadcastResult),
+      .n_published = 0};
+  Slot *slots = Slots(header);
+  for (int i = 0; i < capacity; ++i) {
+    Slot *slot = new (&slots[i]) Slot;
+    slot->sequence.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint32_t> &word : slot->words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+  // Publishes the initialized memory to any reader that sees `n_published`.
+  header->n_published.store(0, std::memory_order_release);
+  return ResultBroadcastWriter(*header);
+}
+
+void ResultBroadcastWriter::Publish(absl::Span<const Result> results) {
+  Slot *slots = Slots(header_);
+  for (const Result &result : results) {
+    uint64_t index = n_published_;
+    WriteSlot(slots[index % header_->capacity], index,
+              {.stroke_index = stroke_index_, .result = result});
+    ++n_published_;
+  }
+  header_->n_published.store(n_published_, std::memory_order_release);
+}
+
+absl::StatusOr<ResultBroadcastReader> ResultBroadcastReader::Attach(
+    absl::Span<const std::byte> memory) {
+  if (memory.size() < sizeof(ResultBroadcastRingHeader) ||
+      reinterpret_cast<uintptr_t>(memory.data()) %
+              alignof(ResultBroadcastRingHeader) !=
+          0) {
+    return absl::InvalidArgumentError(
+        "Ring memory is too small or misaligned to contain a ring");
+  }
+  const auto *header =
+      reinterpret_cast<const ResultBroadcastRingHeader *>(memory.data());
+  if (header->magic != kMagic) {
+    return absl::InvalidArgumentError("Memory does not contain a ring");
+  }
+  if (header->layout_version != kLayoutVersion ||
+      header->record_size != sizeof(BroadcastResult)) {
+    return absl::FailedPreconditionError(absl::Substitute(
+        "Ring has layout version $0 and record size $1, but this reader "
+        "expects layout version $2 and record size $3",
+        header->layout_version, header->record_size, kLayoutVersion,
+        sizeof(BroadcastResult)));
+  }
+  if (header->capacity <= 0 ||
+      memory.size() < ResultBroadcastWriter::RequiredBytes(header->capacity)) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "Ring has capacity $0, which doesn't fit in $1 bytes of memory",
+        header->capacity, memory.size()));
+  }
+
+  uint64_t n_published = header->n_published.load(std::memory_order_acquire);
+  uint64_t capacity = header->capacity;
+  return ResultBroadcastReader(
+      *header, n_published > capacity ? n_published - capacity : 0);
+}
+
+void ResultBroadcastReader::Read(std::vector<BroadcastResult> &results) {
+  const Slot *slots = Slots(header_);
+  const uint64_t capacity = header_->capacity;
+  // When the writer laps us, we skip ahead to halfway through the ring,
+  // rather than to the oldest Result that hasn't been overwritten yet. That
+  // Result is the next one the writer overwrites, so we'd likely just be lapped
+  // again.
+  auto skip_ahead = [this, capacity](uint64_t n_published) {
+    uint64_t index = n_published - capacity / 2;
+    if (index > next_index_) {
+      n_dropped_ += index - next_index_;
+      next_index_ = index;
+    }
+  };
+
+  // We only read up to the Results that had been published when we started,
+  // so that this returns even if the writer is faster than we are.
+  const uint64_t n_published =
+      header_->n_published.load(std::memory_order_acquire);
+  if (n_published - next_index_ > capacity) skip_ahead(n_published);
+  BroadcastResult record;
+  while (next_index_ < n_published) {
+    switch (ReadSlot(slots[next_index_ % capacity], next_index_, record)) {
+      case SlotState::kRead:
+        results.push_back(record);
+        ++next_index_;
+        break;
+      case SlotState::kOverwritten:
+        // The writer has lapped us since we loaded `n_published`. The
+        // Result that overwrote this one may not have been counted yet, so we
+        // skip at least this one.
+        skip_ahead(
+            std::max(header_->n_published.load(std::memory_order_acquire),
+                     next_index_ + 1 + capacity / 2));
+        break;
+      case SlotState::kNotYetWritten:
+        // This can't happen for indices below `n_published`, since the slot
+        // is written before `n_published` is updated.
+        return;
+    }
+  }
+}
+
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_RESULT_BROADCAST_RING_H_
+#define INK_STROKE_MODELER_RESULT_BROADCAST_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// The layout of the start of the ring's memory; see result_broadcast_ring.cc.
+struct ResultBroadcastRingHeader;
+
+// A Result, tagged with the stroke that it belongs to.
+struct BroadcastResult {
+  // The index of the stroke, as counted by
+  // ResultBroadcastWriter::StartStroke().
+  int64_t stroke_index = 0;
+  Result result;
+};
+
+// These classes let a single StrokeModeler share its Results with any number
+// of readers, so that several consumers of the same pen stream (possibly in
+// different processes) don't each need to run their own modeler.
+//
+// The writer and readers communicate through a fixed-size ring of Results in a
+// caller-provided block of memory. The ring contains no pointers, so the block
+// may be mapped at different addresses in different processes, e.g. in POSIX
+// or Android shared memory; setting up the mapping, and telling readers about
+// it, is left to the caller. There is exactly one writer, which never waits for
+// the readers: a reader that falls more than a ring's worth of Results behind
+// skips ahead, and counts the Results it missed as dropped.
+//
+// Example usage:
+//   // Producer:
+//   std::vector<std::byte> memory(ResultBroadcastWriter::RequiredBytes(1024));
+//   auto writer = ResultBroadcastWriter::Create(absl::MakeSpan(memory), 1024);
+//   writer->StartStroke();
+//   modeler.Update(input, results);
+//   writer->Publish(results);
+//
+//   // Consumer:
+//   auto reader = ResultBroadcastReader::Attach(memory);
+//   std::vector<BroadcastResult> results;
+//   reader->Read(results);
+
+class ResultBroadcastWriter {
+ public:
+  // Returns the number of bytes of memory needed for a ring holding
+  // `capacity` Results.
+  static size_t RequiredBytes(int capacity);
+
+  // Initializes an empty ring holding `capacity` Results in `memory`, which
+  // must be at least RequiredBytes(capacity) bytes, and aligned to an 8-byte
+  // boundary. Any previous contents of `memory` are overwritten. Returns an
+  // error if `capacity` is not positive, or `memory` is too small or
+  // misaligned.
+  static absl::StatusOr<ResultBroadcastWriter> Create(
+      absl::Span<std::byte> memory, int capacity);
+
+  // Starts a new stroke; Results published after this are tagged with the
+  // next stroke index. The first stroke has index 1.
+  void StartStroke() { ++stroke_index_; }
+
+  // Appends `results` to the ring, tagged with the current stroke index.
+  void Publish(absl::Span<const Result> results);
+
+  // Returns the total number of Results published to the ring.
+  int64_t NumPublished() const { return n_published_; }
+
+ private:
+  explicit ResultBroadcastWriter(ResultBroadcastRingHeader &header)
+      : header_(&header) {}
+
+  ResultBroadcastRingHeader *header_;
+  int64_t stroke_index_ = 0;
+  int64_t n_published_ = 0;
+};
+
+class ResultBroadcastReader {
+ public:
+  // Attaches a reader to a ring previously initialized by
+  // ResultBroadcastWriter::Create(). The reader starts at the oldest Result
+  // still in the ring. Returns an error if `memory` does not contain a ring
+  // that's compatible with this version of the library.
+  static absl::StatusOr<ResultBroadcastReader> Attach(
+      absl::Span<const std::byte> memory);
+
+  // Appends the Results that have been published since the last call to
+  // `results`. If the writer has overwritten Results that this reader hadn't
+  // read yet, the reader skips ahead to the Results published most recently,
+  // and adds the ones it skipped to NumDropped(). This only reads the Results
+  // that were published before it was called, so it returns promptly even if
+  // the writer is publishing faster than the reader can keep up.
+  void Read(std::vector<BroadcastResult> &results);
+
+  // Returns the total number of Results that this reader skipped because they
+  // were overwritten before they could be read.
+  int64_t NumDropped() const { return n_dropped_; }
+
+ private:
+  ResultBroadcastReader(const ResultBroadcastRingHeader &header,
+                        uint64_t next_index)
+      : header_(&header), next_index_(next_index) {}
+
+  const ResultBroadcastRingHeader *header_;
+  // The index of the next Result to read, counting from the first Result ever
+  // published.
+  uint64_t next_index_;
+  int64_t n_dropped_ = 0;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_RESULT_BROADCAST_RING_H_
@@ -0,0 +1,130 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Loopback benchmarks for ResultBroadcastRing: a writer publishes Results from
+// the benchmark thread, and reader threads read them back out of the same
+// memory, as they would from shared memory in other processes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+constexpr int kCapacity = 1024;
+constexpr int kResultsPerPublish = 4;
+
+double NowInSeconds() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Publishes batches of Results, each stamped with the time it was published,
+// while reader threads poll the ring. Reports the mean latency from publishing
+// a Result to a reader reading it, and the fraction of Results that readers
+// dropped. The arguments are the number of readers, and the interval between
+// batches in microseconds; an interval of zero publishes as fast as possible,
+// which is far faster than a real pen, and so faster than readers can keep up
+// with.
+void BM_BroadcastLoopback(benchmark::State &state) {
+  const int n_readers = state.range(0);
+  const auto publish_interval = std::chrono::microseconds(state.range(1));
+  std::vector<std::byte> memory(
+      ResultBroadcastWriter::RequiredBytes(kCapacity));
+  auto writer =
+      ResultBroadcastWriter::Create(absl::MakeSpan(memory), kCapacity);
+  if (!writer.ok()) {
+    state.SkipWithError("Create failed");
+    return;
+  }
+
+  std::atomic<bool> done = false;
+  std::atomic<int64_t> n_read = 0;
+  std::atomic<int64_t> n_dropped = 0;
+  std::atomic<double> total_latency = 0;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < n_readers; ++i) {
+    readers.emplace_back([&memory, &done, &n_read, &n_dropped,
+                          &total_latency]() {
+      auto reader = ResultBroadcastReader::Attach(memory);
+      if (!reader.ok()) return;
+      std::vector<BroadcastResult> results;
+      double latency = 0;
+      int64_t count = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        results.clear();
+        reader->Read(results);
+        if (results.empty()) {
+          std::this_thread::yield();
+          continue;
+        }
+        double now = NowInSeconds();
+        for (const BroadcastResult &result : results) {
+          latency += now - result.result.time.Value();
+        }
+        count += results.size();
+      }
+      n_read += count;
+      n_dropped += reader->NumDropped();
+      double expected = total_latency.load();
+      while (!total_latency.compare_exchange_weak(expected,
+                                                  expected + latency)) {
+      }
+    });
+  }
+
+  std::vector<Result> results(kResultsPerPublish);
+  writer->StartStroke();
+  auto next_publish_time = std::chrono::steady_clock::now();
+  for (auto _ : state) {
+    while (std::chrono::steady_clock::now() < next_publish_time) {
+    }
+    next_publish_time += publish_interval;
+    Time now(NowInSeconds());
+    for (Result &result : results) result.time = now;
+    writer->Publish(results);
+  }
+  done = true;
+  for (std::thread &reader : readers) reader.join();
+
+  state.SetItemsProcessed(state.iterations() * kResultsPerPublish);
+  if (n_readers > 0) {
+    state.counters["mean_latency_us"] =
+        1e6 * total_latency / std::max<int64_t>(n_read, 1);
+    state.counters["dropped_fraction"] =
+        static_cast<double>(n_dropped) / (n_read + n_dropped);
+  }
+}
+BENCHMARK(BM_BroadcastLoopback)
+    ->Args({0, 0})
+    ->Args({1, 0})
+    ->Args({1, 100})
+    ->Args({3, 100})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
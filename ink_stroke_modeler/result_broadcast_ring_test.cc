@@ -0,0 +1,219 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+// Returns zeroed memory big enough for a ring of the given capacity.
+std::vector<std::byte> MakeMemory(int capacity) {
+  return std::vector<std::byte>(
+      ResultBroadcastWriter::RequiredBytes(capacity));
+}
+
+Result MakeResult(int i) {
+  return {.position = {static_cast<float>(i), static_cast<float>(-i)},
+          .velocity = {1, 2},
+          .acceleration = {3, 4},
+          .time = Time(i),
+          .pressure = .5,
+          .tilt = .25,
+          .orientation = 1};
+}
+
+std::vector<Result> MakeResults(int begin, int end) {
+  std::vector<Result> results;
+  for (int i = begin; i < end; ++i) results.push_back(MakeResult(i));
+  return results;
+}
+
+TEST(ResultBroadcastRingTest, CreateRejectsBadArguments) {
+  std::vector<std::byte> memory = MakeMemory(4);
+  EXPECT_EQ(ResultBroadcastWriter::Create(absl::MakeSpan(memory), 0)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ResultBroadcastWriter::Create(absl::MakeSpan(memory), 5)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  // Misaligned.
+  EXPECT_EQ(
+      ResultBroadcastWriter::Create(absl::MakeSpan(memory).subspan(1), 1)
+          .status()
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+  EXPECT_TRUE(ResultBroadcastWriter::Create(absl::MakeSpan(memory), 4).ok());
+}
+
+TEST(ResultBroadcastRingTest, AttachRejectsMemoryWithoutARing) {
+  std::vector<std::byte> memory = MakeMemory(4);
+  EXPECT_EQ(ResultBroadcastReader::Attach(memory).status().code(),
+            absl::StatusCode::kInvalidArgument);
+
+  ASSERT_TRUE(ResultBroadcastWriter::Create(absl::MakeSpan(memory), 4).ok());
+  EXPECT_TRUE(ResultBroadcastReader::Attach(memory).ok());
+  EXPECT_EQ(ResultBroadcastReader::Attach(absl::MakeConstSpan(memory).first(
+                                              memory.size() - 1))
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ResultBroadcastRingTest, ReadersSeeEachStroke) {
+  std::vector<std::byte> memory = MakeMemory(16);
+  auto writer = ResultBroadcastWriter::Create(absl::MakeSpan(memory), 16);
+  ASSERT_TRUE(writer.ok());
+  auto reader1 = ResultBroadcastReader::Attach(memory);
+  auto reader2 = ResultBroadcastReader::Attach(memory);
+  ASSERT_TRUE(reader1.ok());
+  ASSERT_TRUE(reader2.ok());
+
+  std::vector<BroadcastResult> results;
+  reader1->Read(results);
+  EXPECT_THAT(results, IsEmpty());
+
+  writer->StartStroke();
+  writer->Publish(MakeResults(0, 3));
+  reader1->Read(results);
+  ASSERT_THAT(results, SizeIs(3));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(results[i].stroke_index, 1);
+    EXPECT_EQ(results[i].result, MakeResult(i));
+  }
+
+  writer->StartStroke();
+  writer->Publish(MakeResults(3, 5));
+  EXPECT_EQ(writer->NumPublished(), 5);
+  reader1->Read(results);
+  ASSERT_THAT(results, SizeIs(5));
+  EXPECT_EQ(results[3].stroke_index, 2);
+  EXPECT_EQ(results[4].result, MakeResult(4));
+
+  // Each reader keeps its own position.
+  std::vector<BroadcastResult> results2;
+  reader2->Read(results2);
+  ASSERT_THAT(results2, SizeIs(5));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(results2[i].stroke_index, results[i].stroke_index);
+    EXPECT_EQ(results2[i].result, results[i].result);
+  }
+  EXPECT_EQ(reader1->NumDropped(), 0);
+  EXPECT_EQ(reader2->NumDropped(), 0);
+}
+
+TEST(ResultBroadcastRingTest, SlowReaderDropsOverwrittenResults) {
+  std::vector<std::byte> memory = MakeMemory(4);
+  auto writer = ResultBroadcastWriter::Create(absl::MakeSpan(memory), 4);
+  ASSERT_TRUE(writer.ok());
+  auto reader = ResultBroadcastReader::Attach(memory);
+  ASSERT_TRUE(reader.ok());
+
+  writer->StartStroke();
+  writer->Publish(MakeResults(0, 10));
+  std::vector<BroadcastResult> results;
+  reader->Read(results);
+  // The reader skips ahead to halfway through the ring, so that it doesn't
+  // immediately get lapped again.
+  ASSERT_THAT(results, SizeIs(2));
+  EXPECT_EQ(results[0].result, MakeResult(8));
+  EXPECT_EQ(results[1].result, MakeResult(9));
+  EXPECT_EQ(reader->NumDropped(), 8);
+
+  // A reader that attaches late starts at the oldest Result in the ring.
+  auto late_reader = ResultBroadcastReader::Attach(memory);
+  ASSERT_TRUE(late_reader.ok());
+  results.clear();
+  late_reader->Read(results);
+  ASSERT_THAT(results, SizeIs(4));
+  EXPECT_EQ(results[0].result, MakeResult(6));
+  EXPECT_EQ(late_reader->NumDropped(), 0);
+}
+
+// Publishes from one thread while several others read, and checks that each
+// reader sees the Results in order, without any torn Results.
+TEST(ResultBroadcastRingTest, ConcurrentReadersSeeConsistentResults) {
+  constexpr int kNumResults = 20000;
+  constexpr int kNumReaders = 3;
+  std::vector<std::byte> memory = MakeMemory(64);
+  auto writer = ResultBroadcastWriter::Create(absl::MakeSpan(memory), 64);
+  ASSERT_TRUE(writer.ok());
+
+  std::vector<ResultBroadcastReader> readers;
+  for (int r = 0; r < kNumReaders; ++r) {
+    auto reader = ResultBroadcastReader::Attach(memory);
+    ASSERT_TRUE(reader.ok());
+    readers.push_back(*reader);
+  }
+
+  std::atomic<bool> done = false;
+  std::vector<std::thread> reader_threads;
+  std::vector<int64_t> n_read(kNumReaders, 0);
+  std::vector<int> n_inconsistent(kNumReaders, 0);
+  for (int r = 0; r < kNumReaders; ++r) {
+    reader_threads.emplace_back([&, r]() {
+      ResultBroadcastReader &reader = readers[r];
+      std::vector<BroadcastResult> results;
+      int last = -1;
+      while (true) {
+        bool was_done = done.load();
+        results.clear();
+        reader.Read(results);
+        for (const BroadcastResult &result : results) {
+          int i = result.result.time.Value();
+          if (i <= last || result.result != MakeResult(i)) {
+            ++n_inconsistent[r];
+          }
+          last = i;
+        }
+        n_read[r] += results.size();
+        if (was_done) break;
+      }
+    });
+  }
+
+  writer->StartStroke();
+  for (int i = 0; i < kNumResults; i += 4) {
+    writer->Publish(MakeResults(i, i + 4));
+  }
+  done = true;
+  for (std::thread &thread : reader_threads) thread.join();
+
+  for (int r = 0; r < kNumReaders; ++r) {
+    EXPECT_EQ(n_inconsistent[r], 0) << "reader " << r;
+    EXPECT_EQ(n_read[r] + readers[r].NumDropped(), kNumResults)
+        << "reader " << r;
+  }
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
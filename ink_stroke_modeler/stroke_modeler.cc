@@ -14,16 +14,25 @@
 
 #include "ink_stroke_modeler/stroke_modeler.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>  // NOLINT
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "ink_stroke_modeler/internal/internal_types.h"
 #include "ink_stroke_modeler/internal/loop_contraction_mitigation_modeler.h"
 #include "ink_stroke_modeler/internal/position_modeler.h"
@@ -32,13 +41,47 @@
 #include "ink_stroke_modeler/internal/prediction/stroke_end_predictor.h"
 #include "ink_stroke_modeler/internal/stylus_state_modeler.h"
 #include "ink_stroke_modeler/internal/utils.h"
+#include "ink_stroke_modeler/internal/validation.h"
+#include "ink_stroke_modeler/latency_histogram.h"
+#include "ink_stroke_modeler/numbers.h"
 #include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_trace.h"
 #include "ink_stroke_modeler/types.h"
 
 namespace ink {
 namespace stroke_model {
 namespace {
 
+// Records the time from its construction to its destruction in one of the
+// histograms, if they're enabled.
+class ScopedLatencyRecorder {
+ public:
+  ScopedLatencyRecorder(
+      StrokeModelerLatencyHistograms *histograms,
+      LatencyHistogram StrokeModelerLatencyHistograms::*histogram)
+      : histogram_(histograms == nullptr ? nullptr
+                                         : &(histograms->*histogram)) {
+    if (histogram_ != nullptr) start_ = std::chrono::steady_clock::now();
+  }
+  ~ScopedLatencyRecorder() {
+    if (histogram_ != nullptr) {
+      histogram_->RecordNanoseconds(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start_)
+              .count());
+    }
+  }
+
+  ScopedLatencyRecorder(const ScopedLatencyRecorder &) = delete;
+  ScopedLatencyRecorder &operator=(const ScopedLatencyRecorder &) = delete;
+
+ private:
+  LatencyHistogram *histogram_;
+  // The steady clock, unlike the wall clock, can't jump, e.g. when the system
+  // time is adjusted, so it can't produce negative or inflated latencies.
+  std::chrono::steady_clock::time_point start_;
+};
+
 Result MakeResultFromTipState(const TipState &tipstate,
                               const Result &stylus_state) {
   return {
@@ -52,67 +95,303 @@ Result MakeResultFromTipState(const TipState &tipstate,
   };
 }
 
+// Models the tip states in `scratch.tip_states`, using the rest of `scratch`
+// as buffers.
 void ModelStylus(
-    const std::vector<TipState> &tip_states,
     const StylusStateModeler &stylus_state_modeler,
     LoopContractionMitigationModeler &loop_contraction_mitigation_modeler,
-    std::vector<Result> &result, Time prev_time) {
-  result.reserve(tip_states.size());
+    std::vector<Result> &result, Time prev_time, PredictionScratch &scratch) {
+  INK_STROKE_TRACE_SCOPE("ModelStylus");
+  const std::vector<TipState> &tip_states = scratch.tip_states;
+  result.reserve(result.size() + tip_states.size());
+
+  // The projections don't depend on the loop contraction mitigation, so we
+  // can query the stylus state modeler for all of the tip states at once.
+  std::vector<std::optional<Vec2>> &stroke_normal_buffer =
+      scratch.stroke_normals;
+  stroke_normal_buffer.clear();
+  stroke_normal_buffer.reserve(tip_states.size());
+  for (const auto &tip_state : tip_states) {
+    stroke_normal_buffer.push_back(GetStrokeNormal(tip_state, prev_time));
+    prev_time = tip_state.time;
+  }
+  std::vector<Result> &projected_state_buffer = scratch.projected_states;
+  projected_state_buffer.clear();
+  stylus_state_modeler.QueryBatch(tip_states, stroke_normal_buffer,
+                                  scratch.query_batch, projected_state_buffer);
 
   float interp_value =
       loop_contraction_mitigation_modeler.GetInterpolationValue();
-  for (const auto &tip_state : tip_states) {
-    std::optional<Vec2> stroke_normal = GetStrokeNormal(tip_state, prev_time);
-    Result projected_state =
-        stylus_state_modeler.Query(tip_state, stroke_normal);
+  for (decltype(tip_states.size()) i = 0; i < tip_states.size(); ++i) {
+    const TipState &tip_state = tip_states[i];
+    const Result &projected_state = projected_state_buffer[i];
     Result modeled_state = MakeResultFromTipState(tip_state, projected_state);
     result.push_back(
         InterpResult(projected_state, modeled_state, interp_value));
     interp_value = loop_contraction_mitigation_modeler.Update(
         result.back().velocity, tip_state.time);
-    prev_time = tip_state.time;
   }
 }
 
+// Converts the times of the Results from `first` onward from the modeler's
+// internal time base, which starts at `time_origin`, to the caller's.
+void RestoreTimeBase(Time time_origin, std::vector<Result>::iterator first,
+                     std::vector<Result>::iterator last) {
+  if (time_origin == Time(0)) return;
+  for (; first != last; ++first) {
+    first->time = time_origin + (first->time - Time(0));
+  }
+}
+
+// Returns true if `input` can be skipped, because it differs from `modeled`,
+// the most recent modeled input, by no more than the tolerances in `params`.
+bool IsRedundantInput(const Input &input, const Input &modeled,
+                      const InputCoalescingParams &params) {
+  if (!params.is_enabled) return false;
+  float orientation_delta = std::abs(input.orientation - modeled.orientation);
+  orientation_delta = std::min<float>(orientation_delta,
+                                      2 * kPi - orientation_delta);
+  // The comparisons are false for NaN, so such inputs are never skipped.
+  return input.time - modeled.time <= params.max_skipped_duration &&
+         Distance(modeled.position, input.position) <=
+             params.position_tolerance &&
+         std::abs(input.pressure - modeled.pressure) <=
+             params.pressure_tolerance &&
+         std::abs(input.tilt - modeled.tilt) <= params.tilt_tolerance &&
+         orientation_delta <= params.orientation_tolerance;
+}
+
+// Models the predicted tip states in `scratch.tip_states`.
+void ModelPrediction(const StylusStateModeler &stylus_state_modeler,
+                     const LoopContractionMitigationModeler
+                         &loop_contraction_mitigation_modeler,
+                     Time last_input_time, Time time_origin,
+                     PredictionScratch &scratch,
+                     std::vector<Result> &results) {
+  INK_STROKE_TRACE_COUNTER("predicted_tip_states", scratch.tip_states.size());
+  // Take a copy because ModelStylus() will modify the modeler passed in.
+  LoopContractionMitigationModeler prediction_loop_modeler =
+      loop_contraction_mitigation_modeler;
+  ModelStylus(stylus_state_modeler, prediction_loop_modeler, results,
+              last_input_time, scratch);
+  RestoreTimeBase(time_origin, results.begin(), results.end());
+}
+
+// Returns the name of the trace event for the arrival of the input.
+[[maybe_unused]] const char *InputTraceEventName(const Input &input) {
+  switch (input.event_type) {
+    case Input::EventType::kDown:
+      return "InputDown";
+    case Input::EventType::kMove:
+      return "InputMove";
+    case Input::EventType::kUp:
+      return "InputUp";
+  }
+  return "Input";
+}
+
+absl::Status ValidateUpdateBudget(const UpdateBudget &budget) {
+  if (absl::Status status = ValidateGreaterThanZero(
+          budget.max_results, "UpdateBudget::max_results");
+      !status.ok()) {
+    return status;
+  }
+  if (budget.max_time <= absl::ZeroDuration()) {
+    return absl::InvalidArgumentError(
+        "UpdateBudget::max_time must be greater than zero.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ValidatePredictionOverrides(Duration horizon,
+                                         Duration sample_spacing) {
+  if (absl::Status status =
+          ValidateGreaterThanOrEqualToZero(horizon.Value(), "horizon");
+      !status.ok()) {
+    return status;
+  }
+  return ValidateGreaterThanZero(sample_spacing.Value(), "sample_spacing");
+}
+
+// `last_input_time` is in the internal time base, which starts at
+// `time_origin`, while `time` and the returned Result are in the caller's.
+Result ModelPredictionAt(const InputPredictor &predictor,
+                         const TipState &current_state,
+                         const StylusStateModeler &stylus_state_modeler,
+                         const LoopContractionMitigationModeler
+                             &loop_contraction_mitigation_modeler,
+                         Time last_input_time, Time time_origin, Time time) {
+  std::optional<TipState> tip_state =
+      predictor.PredictAt(current_state, Time(0) + (time - time_origin));
+  if (!tip_state.has_value()) tip_state = current_state;
+
+  Result projected_state = stylus_state_modeler.Query(
+      *tip_state, GetStrokeNormal(*tip_state, last_input_time));
+  Result result = InterpResult(
+      projected_state, MakeResultFromTipState(*tip_state, projected_state),
+      loop_contraction_mitigation_modeler.GetInterpolationValue());
+  result.time = time_origin + (result.time - Time(0));
+  return result;
+}
+
+// Returns the most Results that the gap between two inputs may call for when
+// it's modeled by budgeted calls, which bound the work per call themselves.
+// This only guards against absurd gaps, e.g. from a clock jump, which would
+// take an unreasonable time and memory to drain.
+int MaxStepsBetweenDeferredInputs(const SamplingParams &sampling_params) {
+  constexpr int kMaxDeferredSteps = 1 << 22;
+  return std::max(sampling_params.max_outputs_per_call, kMaxDeferredSteps);
+}
+
 }  // namespace
 
-absl::Status StrokeModeler::Reset(
-    const StrokeModelParams &stroke_model_params) {
-  if (auto status = ValidateStrokeModelParams(stroke_model_params);
+// Tracks the work remaining in an UpdateBudget over the course of a call.
+class StrokeModeler::WorkBudget {
+ public:
+  explicit WorkBudget(const UpdateBudget &budget)
+      : results_left_(budget.max_results),
+        has_deadline_(budget.max_time != absl::InfiniteDuration()),
+        deadline_(has_deadline_ ? DeadlineAfter(budget.max_time)
+                                : Clock::time_point::max()),
+        is_unlimited_(!has_deadline_ && budget.max_results ==
+                                            UpdateBudget().max_results) {}
+
+  // Returns true for the default UpdateBudget, i.e. for unbudgeted calls.
+  bool IsUnlimited() const { return is_unlimited_; }
+
+  // The number of tip states to model before checking the budget again.
+  int MaxChunk() const {
+    // Checking the clock isn't free, so we only do so every so often.
+    constexpr int kDeadlineCheckInterval = 64;
+    return has_deadline_ ? std::min(results_left_, kDeadlineCheckInterval)
+                         : results_left_;
+  }
+
+  void Spend(int n_results) {
+    results_left_ -= n_results;
+    made_progress_ = true;
+  }
+
+  // Returns true if the budget has run out. This is never the case until
+  // some work has been done, so that each call makes progress.
+  bool Exhausted() const {
+    if (!made_progress_) return false;
+    return results_left_ <= 0 || (has_deadline_ && Clock::now() >= deadline_);
+  }
+
+ private:
+  // The deadline is measured on a monotonic clock, so that it isn't moved by
+  // adjustments to the system time.
+  using Clock = std::chrono::steady_clock;
+
+  // Returns the time `max_time` from now, saturating instead of overflowing.
+  static Clock::time_point DeadlineAfter(absl::Duration max_time) {
+    const Clock::time_point now = Clock::now();
+    const Clock::duration headroom = Clock::time_point::max() - now;
+    if (max_time >= absl::FromChrono(headroom)) return Clock::time_point::max();
+    return now + std::chrono::duration_cast<Clock::duration>(
+                     absl::ToChronoNanoseconds(max_time));
+  }
+
+  int results_left_;
+  bool has_deadline_;
+  Clock::time_point deadline_;
+  bool is_unlimited_;
+  bool made_progress_ = false;
+};
+
+void PredictionSnapshot::Predict(std::vector<Result> &results,
+                                 PredictionScratch &scratch) const {
+  INK_STROKE_TRACE_SCOPE("PredictionSnapshot::Predict");
+  results.clear();
+  predictor_->ConstructPrediction(current_state_, scratch.tip_states);
+  ModelPrediction(stylus_state_modeler_, loop_contraction_mitigation_modeler_,
+                  last_input_time_, time_origin_, scratch, results);
+}
+
+absl::Status PredictionSnapshot::Predict(Duration horizon,
+                                         Duration sample_spacing,
+                                         std::vector<Result> &results,
+                                         PredictionScratch &scratch) const {
+  INK_STROKE_TRACE_SCOPE("PredictionSnapshot::Predict");
+  results.clear();
+  if (absl::Status status =
+          ValidatePredictionOverrides(horizon, sample_spacing);
       !status.ok()) {
     return status;
   }
 
-  // Note that many of the sub-modelers require some knowledge about the stroke
-  // (e.g. start position, input type) when resetting, and as such are reset in
-  // ProcessTDown() instead.
-  stroke_model_params_ = stroke_model_params;
-  ResetInternal();
+  predictor_->ConstructPrediction(current_state_, horizon, sample_spacing,
+                                  scratch.tip_states);
+  ModelPrediction(stylus_state_modeler_, loop_contraction_mitigation_modeler_,
+                  last_input_time_, time_origin_, scratch, results);
+  return absl::OkStatus();
+}
 
-  const PredictionParams &prediction_params =
-      stroke_model_params_->prediction_params;
+Result PredictionSnapshot::PredictAt(Time time) const {
+  return ModelPredictionAt(*predictor_, current_state_, stylus_state_modeler_,
+                           loop_contraction_mitigation_modeler_,
+                           last_input_time_, time_origin_, time);
+}
+
+absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>>
+CompiledStrokeModelParams::Create(const StrokeModelParams &params) {
+  if (auto status = ValidateStrokeModelParams(params); !status.ok()) {
+    return status;
+  }
+  return std::shared_ptr<const CompiledStrokeModelParams>(
+      new CompiledStrokeModelParams(params));
+}
+
+CompiledStrokeModelParams::CompiledStrokeModelParams(
+    const StrokeModelParams &params)
+    : params_(params),
+      min_output_interval_(1. / params.sampling_params.min_output_rate) {
   static_assert(std::variant_size_v<PredictionParams> == 3);
-  if (std::holds_alternative<KalmanPredictorParams>(prediction_params)) {
-    predictor_ = std::make_unique<KalmanPredictor>(
-        std::get<KalmanPredictorParams>(prediction_params),
-        stroke_model_params_->sampling_params);
+  if (std::holds_alternative<KalmanPredictorParams>(
+          params_.prediction_params)) {
+    predictor_prototype_ = std::make_unique<KalmanPredictor>(
+        std::get<KalmanPredictorParams>(params_.prediction_params),
+        params_.sampling_params);
   } else if (std::holds_alternative<StrokeEndPredictorParams>(
-                 prediction_params)) {
-    predictor_ = std::make_unique<StrokeEndPredictor>(
-        stroke_model_params_->position_modeler_params,
-        stroke_model_params_->sampling_params);
+                 params_.prediction_params)) {
+    predictor_prototype_ = std::make_unique<StrokeEndPredictor>(
+        params_.position_modeler_params, params_.sampling_params);
   } else if (std::holds_alternative<DisabledPredictorParams>(
-                 prediction_params)) {
-    predictor_ = nullptr;
+                 params_.prediction_params)) {
+    predictor_prototype_ = nullptr;
   }
-  loop_contraction_mitigation_modeler_.Reset(
-      stroke_model_params_->position_modeler_params
-          .loop_contraction_mitigation_params);
+}
+
+absl::Status StrokeModeler::Reset(
+    const StrokeModelParams &stroke_model_params) {
+  absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>> params =
+      CompiledStrokeModelParams::Create(stroke_model_params);
+  if (!params.ok()) return params.status();
+  Reset(*std::move(params));
   return absl::OkStatus();
 }
 
+void StrokeModeler::Reset(
+    std::shared_ptr<const CompiledStrokeModelParams> params) {
+  // Note that many of the sub-modelers require some knowledge about the stroke
+  // (e.g. start position, input type) when resetting, and as such are reset in
+  // ProcessTDown() instead.
+  compiled_params_ = std::move(params);
+  stroke_model_params_ = &compiled_params_->Params();
+  ResetInternal();
+
+  // The predictor is copied from the prototype by the next down event.
+  predictor_.reset();
+  if (stroke_state_ != nullptr) {
+    stroke_state_->loop_contraction_mitigation_modeler.Reset(
+        stroke_model_params_->position_modeler_params
+            .loop_contraction_mitigation_params);
+  }
+}
+
 absl::Status StrokeModeler::Reset() {
-  if (!stroke_model_params_.has_value()) {
+  if (stroke_model_params_ == nullptr) {
     return absl::FailedPreconditionError(
         "Initial call to Reset must pass StrokeModelParams.");
   }
@@ -122,12 +401,53 @@ absl::Status StrokeModeler::Reset() {
 
 void StrokeModeler::ResetInternal() {
   last_input_.reset();
+  last_skipped_input_.reset();
+  pending_segment_.reset();
+  if (stroke_state_ != nullptr) stroke_state_->pending_inputs.clear();
   save_active_ = false;
 }
 
 absl::Status StrokeModeler::Update(const Input &input,
                                    std::vector<Result> &results) {
-  if (!stroke_model_params_.has_value()) {
+  return Update(input, results, UpdateBudget());
+}
+
+absl::Status StrokeModeler::Update(absl::Span<const DigitizerSample> samples,
+                                   const DigitizerTransform &transform,
+                                   std::vector<Result> &results) {
+  if (absl::Status status = ValidateDigitizerTransform(transform);
+      !status.ok()) {
+    return status;
+  }
+  // Converting a chunk at a time lets the conversion be vectorized, without
+  // allocating a buffer for the whole batch.
+  constexpr int kChunkSize = 64;
+  std::array<Input, kChunkSize> inputs;
+  while (!samples.empty()) {
+    int n_inputs = std::min<int>(samples.size(), kChunkSize);
+    for (int i = 0; i < n_inputs; ++i) {
+      inputs[i] = transform.ToInput(samples[i]);
+    }
+    for (int i = 0; i < n_inputs; ++i) {
+      if (absl::Status status = Update(inputs[i], results); !status.ok()) {
+        return status;
+      }
+    }
+    samples.remove_prefix(n_inputs);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status StrokeModeler::Update(const Input &input,
+                                   std::vector<Result> &results,
+                                   const UpdateBudget &budget) {
+  // The value is the input's own timestamp, so that the delay between the
+  // input being generated and its arrival is visible on the timeline.
+  INK_STROKE_TRACE_INSTANT(InputTraceEventName(input), input.time.Value());
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::Update");
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::update);
+  if (stroke_model_params_ == nullptr) {
     return absl::FailedPreconditionError(
         "Stroke model has not yet been initialized");
   }
@@ -135,37 +455,380 @@ absl::Status StrokeModeler::Update(const Input &input,
   if (absl::Status status = ValidateInput(input); !status.ok()) {
     return status;
   }
+  if (absl::Status status = ValidateUpdateBudget(budget); !status.ok()) {
+    return status;
+  }
+
+  if (HasPendingWork()) {
+    // The input will be started once the pending work ahead of it is done, so
+    // we check it against the most recent pending input now, instead of
+    // leaving that to ProcessDownEvent() etc.
+    if (absl::Status status = ValidatePendingInput(input); !status.ok()) {
+      return status;
+    }
+    stroke_state_->pending_inputs.push_back(input);
+    WorkBudget work_budget(budget);
+    return ProcessPendingWork(results, work_budget);
+  }
 
   if (last_input_) {
-    if (last_input_->input == input) {
+    const Input &previous = MostRecentInput();
+    if (previous == input) {
       return absl::InvalidArgumentError("Received duplicate input");
     }
 
-    if (input.time < last_input_->input.time) {
+    if (input.time < previous.time) {
+      return absl::InvalidArgumentError("Inputs travel backwards in time");
+    }
+  }
+
+  WorkBudget work_budget(budget);
+  const SamplingParams &sampling_params = stroke_model_params_->sampling_params;
+  size_t n_results = results.size();
+  if (absl::Status status = StartInput(
+          input, results,
+          work_budget.IsUnlimited()
+              ? sampling_params.max_outputs_per_call
+              : MaxStepsBetweenDeferredInputs(sampling_params));
+      !status.ok()) {
+    return status;
+  }
+  work_budget.Spend(results.size() - n_results);
+  return ProcessPendingWork(results, work_budget);
+}
+
+absl::Status StrokeModeler::Drain(std::vector<Result> &results,
+                                  const UpdateBudget &budget) {
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::Drain");
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::drain);
+  if (stroke_model_params_ == nullptr) {
+    return absl::FailedPreconditionError(
+        "Stroke model has not yet been initialized");
+  }
+  if (absl::Status status = ValidateUpdateBudget(budget); !status.ok()) {
+    return status;
+  }
+  WorkBudget work_budget(budget);
+  return ProcessPendingWork(results, work_budget);
+}
+
+absl::Status StrokeModeler::ValidatePendingInput(const Input &input) const {
+  // The most recent input of the stroke that will be in progress once the
+  // pending inputs have been started, if any.
+  const std::deque<Input> &pending_inputs = stroke_state_->pending_inputs;
+  const Input *previous = nullptr;
+  if (!pending_inputs.empty()) {
+    if (pending_inputs.back().event_type != Input::EventType::kUp) {
+      previous = &pending_inputs.back();
+    }
+  } else if (!pending_segment_->is_up_event) {
+    previous = &MostRecentInput();
+  }
+
+  if (previous != nullptr) {
+    if (*previous == input) {
+      return absl::InvalidArgumentError("Received duplicate input");
+    }
+    if (input.time < previous->time) {
       return absl::InvalidArgumentError("Inputs travel backwards in time");
     }
   }
 
+  switch (input.event_type) {
+    case Input::EventType::kDown:
+      if (previous != nullptr) {
+        return absl::FailedPreconditionError(
+            "Received down event while stroke is in-progress");
+      }
+      return absl::OkStatus();
+    case Input::EventType::kMove:
+      if (previous == nullptr) {
+        return absl::FailedPreconditionError(
+            "Received move event while no stroke is in-progress");
+      }
+      return absl::OkStatus();
+    case Input::EventType::kUp:
+      if (previous == nullptr) {
+        return absl::FailedPreconditionError(
+            "Received up event while no stroke is in-progress");
+      }
+      return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError("Invalid EventType.");
+}
+
+absl::Status StrokeModeler::StartInput(const Input &input,
+                                       std::vector<Result> &results,
+                                       int max_steps) {
+  if (input.event_type == Input::EventType::kMove && last_input_.has_value() &&
+      IsRedundantInput(input, last_input_->input,
+                       stroke_model_params_->input_coalescing_params)) {
+    INK_STROKE_TRACE_INSTANT("SkippedInput", input.time.Value());
+    last_skipped_input_ = input;
+    return absl::OkStatus();
+  }
+  last_skipped_input_.reset();
+
   switch (input.event_type) {
     case Input::EventType::kDown:
       return ProcessDownEvent(input, results);
     case Input::EventType::kMove:
-      return ProcessMoveEvent(input, results);
+      return ProcessMoveEvent(input, max_steps);
     case Input::EventType::kUp:
-      return ProcessUpEvent(input, results);
+      return ProcessUpEvent(input, max_steps);
   }
   return absl::InvalidArgumentError("Invalid EventType.");
 }
 
+absl::Status StrokeModeler::ProcessPendingWork(std::vector<Result> &results,
+                                               WorkBudget &budget) {
+  while (!budget.Exhausted()) {
+    if (pending_segment_.has_value()) {
+      ContinuePendingSegment(results, budget);
+      continue;
+    }
+    // There's no stroke state until the first stroke, in which case there are
+    // no pending inputs either.
+    if (stroke_state_ == nullptr || stroke_state_->pending_inputs.empty()) {
+      break;
+    }
+
+    Input input = stroke_state_->pending_inputs.front();
+    stroke_state_->pending_inputs.pop_front();
+    size_t n_results = results.size();
+    const SamplingParams &sampling_params =
+        stroke_model_params_->sampling_params;
+    if (absl::Status status = StartInput(
+            input, results,
+            budget.IsUnlimited()
+                ? sampling_params.max_outputs_per_call
+                : MaxStepsBetweenDeferredInputs(sampling_params));
+        !status.ok()) {
+      return status;
+    }
+    budget.Spend(results.size() - n_results);
+  }
+  return absl::OkStatus();
+}
+
+void StrokeModeler::ContinuePendingSegment(std::vector<Result> &results,
+                                           WorkBudget &budget) {
+  PendingSegment &segment = *pending_segment_;
+  StrokeState &stroke_state = *stroke_state_;
+  std::vector<TipState> &end_of_stroke_states =
+      stroke_state.end_of_stroke_states;
+  scratch_.tip_states.clear();
+  if (segment.next_step <= segment.n_steps) {
+    int last_step = segment.n_steps - segment.next_step < budget.MaxChunk()
+                        ? segment.n_steps
+                        : segment.next_step - 1 + budget.MaxChunk();
+    scratch_.tip_states.reserve(last_step - segment.next_step + 1);
+    INK_STROKE_TRACE_SCOPE("PositionModeler::UpdateAlongLinearPath");
+    stroke_state.position_modeler.UpdateAlongLinearPath(
+        segment.start_position, segment.start_time, segment.end_position,
+        segment.end_time, segment.n_steps, segment.next_step, last_step,
+        std::back_inserter(scratch_.tip_states));
+    segment.next_step = last_step + 1;
+  } else if (segment.is_up_event) {
+    if (!segment.modeled_end_of_stroke) {
+      INK_STROKE_TRACE_SCOPE("PositionModeler::ModelEndOfStroke");
+      end_of_stroke_states.clear();
+      stroke_state.position_modeler.ModelEndOfStroke(
+          segment.end_position, compiled_params_->MinOutputInterval(),
+          stroke_model_params_->sampling_params.end_of_stroke_max_iterations,
+          stroke_model_params_->sampling_params.end_of_stroke_stopping_distance,
+          std::back_inserter(end_of_stroke_states));
+      if (segment.n_steps == 0 && end_of_stroke_states.empty()) {
+        // If we haven't generated any new states, add the current state. This
+        // can happen if the TUp has the same timestamp as the last in-contact
+        // input.
+        end_of_stroke_states.push_back(
+            stroke_state.position_modeler.CurrentState());
+      }
+      segment.modeled_end_of_stroke = true;
+    }
+    int n_states = std::min(static_cast<int>(end_of_stroke_states.size()) -
+                                segment.next_end_of_stroke_state,
+                            budget.MaxChunk());
+    auto first =
+        end_of_stroke_states.begin() + segment.next_end_of_stroke_state;
+    scratch_.tip_states.assign(first, first + n_states);
+    segment.next_end_of_stroke_state += n_states;
+  }
+
+  INK_STROKE_TRACE_COUNTER("tip_states", scratch_.tip_states.size());
+  if (!scratch_.tip_states.empty()) {
+    size_t n_results = results.size();
+    ModelStylus(stroke_state.stylus_state_modeler,
+                stroke_state.loop_contraction_mitigation_modeler, results,
+                segment.prev_time, scratch_);
+    RestoreTimeBase(time_origin_, results.begin() + n_results, results.end());
+    segment.prev_time = scratch_.tip_states.back().time;
+  }
+  budget.Spend(scratch_.tip_states.size());
+
+  if (segment.next_step <= segment.n_steps) return;
+  if (segment.is_up_event) {
+    if (!segment.modeled_end_of_stroke ||
+        segment.next_end_of_stroke_state <
+            static_cast<int>(end_of_stroke_states.size())) {
+      return;
+    }
+    // This indicates that we've finished the stroke.
+    last_input_ = std::nullopt;
+  }
+  pending_segment_.reset();
+}
+
 absl::Status StrokeModeler::Predict(std::vector<Result> &results) const {
+  return Predict(results, scratch_);
+}
+
+absl::Status StrokeModeler::Predict(Duration horizon, Duration sample_spacing,
+                                    std::vector<Result> &results) const {
+  return Predict(horizon, sample_spacing, results, scratch_);
+}
+
+absl::Status StrokeModeler::Predict(std::vector<Result> &results,
+                                    PredictionScratch &scratch) const {
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::Predict");
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::predict);
+  results.clear();
+  if (absl::Status status = ValidatePredictionState(); !status.ok()) {
+    return status;
+  }
+
+  predictor_->ConstructPrediction(
+      stroke_state_->position_modeler.CurrentState(), scratch.tip_states);
+  ModelPrediction(stroke_state_->stylus_state_modeler,
+                  stroke_state_->loop_contraction_mitigation_modeler,
+                  ToStrokeTime(last_input_->input.time), time_origin_,
+                  scratch, results);
+  return absl::OkStatus();
+}
+
+absl::Status StrokeModeler::Predict(Duration horizon, Duration sample_spacing,
+                                    std::vector<Result> &results,
+                                    PredictionScratch &scratch) const {
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::Predict");
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::predict);
   results.clear();
+  if (absl::Status status = ValidatePredictionState(); !status.ok()) {
+    return status;
+  }
+  if (absl::Status status =
+          ValidatePredictionOverrides(horizon, sample_spacing);
+      !status.ok()) {
+    return status;
+  }
 
-  if (!stroke_model_params_.has_value()) {
+  predictor_->ConstructPrediction(
+      stroke_state_->position_modeler.CurrentState(), horizon, sample_spacing,
+      scratch.tip_states);
+  ModelPrediction(stroke_state_->stylus_state_modeler,
+                  stroke_state_->loop_contraction_mitigation_modeler,
+                  ToStrokeTime(last_input_->input.time), time_origin_,
+                  scratch, results);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Result> StrokeModeler::PredictAt(Time time) const {
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::PredictAt");
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::predict);
+  if (absl::Status status = ValidatePredictionState(); !status.ok()) {
+    return status;
+  }
+
+  return ModelPredictionAt(*predictor_,
+                           stroke_state_->position_modeler.CurrentState(),
+                           stroke_state_->stylus_state_modeler,
+                           stroke_state_->loop_contraction_mitigation_modeler,
+                           ToStrokeTime(last_input_->input.time), time_origin_,
+                           time);
+}
+
+absl::StatusOr<std::shared_ptr<const PredictionSnapshot>>
+StrokeModeler::MakePredictionSnapshot() const {
+  if (absl::Status status = ValidatePredictionState(); !status.ok()) {
+    return status;
+  }
+
+  // The constructor is private, so we can't use std::make_shared.
+  return std::shared_ptr<const PredictionSnapshot>(new PredictionSnapshot(
+      predictor_->MakeCopy(), stroke_state_->position_modeler.CurrentState(),
+      stroke_state_->stylus_state_modeler,
+      stroke_state_->loop_contraction_mitigation_modeler,
+      ToStrokeTime(last_input_->input.time), time_origin_));
+}
+
+absl::Status StrokeModeler::ModelHypothetical(
+    absl::Span<const Input> inputs, std::vector<Result> &results) const {
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::ModelHypothetical");
+  if (stroke_model_params_ == nullptr) {
+    return absl::FailedPreconditionError(
+        "Stroke model has not yet been initialized");
+  }
+  // Deferred work may start the stroke in progress, so we check for it as
+  // well as for `last_input_`. Either way, the stroke state is allocated.
+  if (!last_input_.has_value() && !HasPendingWork()) {
+    return absl::FailedPreconditionError(
+        "Cannot model hypothetical inputs when no stroke is in-progress");
+  }
+  for (const Input &input : inputs) {
+    if (input.event_type == Input::EventType::kDown) {
+      return absl::InvalidArgumentError(
+          "Hypothetical inputs cannot start a new stroke");
+    }
+  }
+
+  if (hypothetical_modeler_ == nullptr) {
+    hypothetical_modeler_ = std::make_unique<StrokeModeler>();
+  }
+  StrokeModeler &modeler = *hypothetical_modeler_;
+  modeler.compiled_params_ = compiled_params_;
+  modeler.stroke_model_params_ = stroke_model_params_;
+  if (modeler.stroke_state_ == nullptr) {
+    modeler.stroke_state_ = std::make_unique<StrokeState>();
+  }
+  // Assigning into the existing stroke state reuses its buffers, and leaves
+  // out the saved state, which the scratch modeler never restores.
+  StrokeState &stroke_state = *modeler.stroke_state_;
+  stroke_state.wobble_smoother.CopyStateFrom(stroke_state_->wobble_smoother);
+  stroke_state.position_modeler.CopyStateFrom(stroke_state_->position_modeler);
+  stroke_state.stylus_state_modeler.CopyStateFrom(
+      stroke_state_->stylus_state_modeler);
+  stroke_state.loop_contraction_mitigation_modeler.CopyStateFrom(
+      stroke_state_->loop_contraction_mitigation_modeler);
+  stroke_state.end_of_stroke_states = stroke_state_->end_of_stroke_states;
+  stroke_state.pending_inputs = stroke_state_->pending_inputs;
+  modeler.last_input_ = last_input_;
+  modeler.last_skipped_input_ = last_skipped_input_;
+  modeler.pending_segment_ = pending_segment_;
+  modeler.time_origin_ = time_origin_;
+  // The predictor is only needed if deferred work starts a stroke, and then
+  // only for Predict(), so any left over from a previous call is dropped.
+  modeler.predictor_.reset();
+
+  for (const Input &input : inputs) {
+    if (absl::Status status = modeler.Update(input, results); !status.ok()) {
+      return status;
+    }
+  }
+  // With no inputs, the deferred work is still modeled.
+  return inputs.empty() ? modeler.Drain(results) : absl::OkStatus();
+}
+
+absl::Status StrokeModeler::ValidatePredictionState() const {
+  if (stroke_model_params_ == nullptr) {
     return absl::FailedPreconditionError(
         "Stroke model has not yet been initialized");
   }
 
-  if (predictor_ == nullptr) {
+  if (compiled_params_->predictor_prototype_ == nullptr) {
     return absl::FailedPreconditionError(
         "Prediction has been disabled by StrokeModelParams.");
   }
@@ -175,13 +838,6 @@ absl::Status StrokeModeler::Predict(std::vector<Result> &results) const {
         "Cannot construct prediction when no stroke is in-progress");
   }
 
-  predictor_->ConstructPrediction(position_modeler_.CurrentState(),
-                                  tip_state_buffer_);
-  // Take a copy because ModelStylus() will modify the modeler passed in.
-  LoopContractionMitigationModeler prediction_loop_modeler =
-      loop_contraction_mitigation_modeler_;
-  ModelStylus(tip_state_buffer_, stylus_state_modeler_, prediction_loop_modeler,
-              results, last_input_->input.time);
   return absl::OkStatus();
 }
 
@@ -191,29 +847,47 @@ absl::Status StrokeModeler::ProcessDownEvent(const Input &input,
     return absl::FailedPreconditionError(
         "Received down event while stroke is in-progress");
   }
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::ProcessDownEvent");
+
+  if (stroke_state_ == nullptr) {
+    stroke_state_ = std::make_unique<StrokeState>();
+  }
+  StrokeState &stroke_state = *stroke_state_;
+  time_origin_ = stroke_model_params_->sampling_params.use_stroke_relative_time
+                     ? input.time
+                     : Time(0);
+  const Time time = ToStrokeTime(input.time);
 
   // Note that many of the sub-modelers require some knowledge about the stroke
   // (e.g. start position, input type) when resetting, and as such are reset
   // here instead of in Reset().
-  wobble_smoother_.Reset(stroke_model_params_->wobble_smoother_params,
-                         input.position, input.time);
-  position_modeler_.Reset({.position = input.position, .time = input.time},
-                          stroke_model_params_->position_modeler_params);
-  stylus_state_modeler_.Reset(
+  stroke_state.wobble_smoother.Reset(
+      stroke_model_params_->wobble_smoother_params, input.position, time);
+  stroke_state.position_modeler.Reset(
+      {.position = input.position, .time = time},
+      stroke_model_params_->position_modeler_params);
+  stroke_state.stylus_state_modeler.Reset(
       stroke_model_params_->stylus_state_modeler_params);
-  loop_contraction_mitigation_modeler_.Reset(
+  stroke_state.loop_contraction_mitigation_modeler.Reset(
       stroke_model_params_->position_modeler_params
           .loop_contraction_mitigation_params);
 
-  stylus_state_modeler_.Update(input.position, input.time,
-                               {.pressure = input.pressure,
-                                .tilt = input.tilt,
-                                .orientation = input.orientation});
+  stroke_state.stylus_state_modeler.Update(
+      input.position, time,
+      {.pressure = input.pressure,
+       .tilt = input.tilt,
+       .orientation = input.orientation});
 
-  const TipState &tip_state = position_modeler_.CurrentState();
-  if (predictor_ != nullptr) {
-    predictor_->Reset();
-    predictor_->Update(input.position, input.time);
+  const TipState &tip_state = stroke_state.position_modeler.CurrentState();
+  if (const InputPredictor *prototype =
+          compiled_params_->predictor_prototype_.get();
+      prototype != nullptr) {
+    if (predictor_ == nullptr) {
+      predictor_ = prototype->MakeCopy();
+    } else {
+      predictor_->Reset();
+    }
+    predictor_->Update(input.position, time);
   }
 
   // We don't correct the position on the down event, so we set
@@ -222,7 +896,7 @@ absl::Status StrokeModeler::ProcessDownEvent(const Input &input,
   result.push_back({.position = tip_state.position,
                     .velocity = tip_state.velocity,
                     .acceleration = tip_state.acceleration,
-                    .time = tip_state.time,
+                    .time = FromStrokeTime(tip_state.time),
                     .pressure = input.pressure,
                     .tilt = input.tilt,
                     .orientation = input.orientation});
@@ -230,115 +904,171 @@ absl::Status StrokeModeler::ProcessDownEvent(const Input &input,
 }
 
 absl::Status StrokeModeler::ProcessUpEvent(const Input &input,
-                                           std::vector<Result> &results) {
+                                           int max_steps) {
   if (!last_input_) {
     return absl::FailedPreconditionError(
         "Received up event while no stroke is in-progress");
   }
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::ProcessUpEvent");
 
   absl::StatusOr<int> n_steps = NumberOfStepsBetweenInputs(
-      position_modeler_.CurrentState(), last_input_->input, input,
-      stroke_model_params_->sampling_params,
-      stroke_model_params_->position_modeler_params);
+      stroke_state_->position_modeler.CurrentState(), last_input_->input,
+      input, stroke_model_params_->sampling_params,
+      stroke_model_params_->position_modeler_params, max_steps);
   if (!n_steps.ok()) {
     return n_steps.status();
   }
-  tip_state_buffer_.clear();
-  tip_state_buffer_.reserve(
-      static_cast<size_t>(*n_steps) +
-      stroke_model_params_->sampling_params.end_of_stroke_max_iterations);
-  position_modeler_.UpdateAlongLinearPath(
-      last_input_->corrected_position, last_input_->input.time, input.position,
-      input.time, *n_steps, std::back_inserter(tip_state_buffer_));
-
-  position_modeler_.ModelEndOfStroke(
-      input.position,
-      Duration(1. / stroke_model_params_->sampling_params.min_output_rate),
-      stroke_model_params_->sampling_params.end_of_stroke_max_iterations,
-      stroke_model_params_->sampling_params.end_of_stroke_stopping_distance,
-      std::back_inserter(tip_state_buffer_));
-
-  if (tip_state_buffer_.empty()) {
-    // If we haven't generated any new states, add the current state. This can
-    // happen if the TUp has the same timestamp as the last in-contact input.
-    tip_state_buffer_.push_back(position_modeler_.CurrentState());
-  }
-
-  stylus_state_modeler_.Update(input.position, input.time,
-                               {.pressure = input.pressure,
-                                .tilt = input.tilt,
-                                .orientation = input.orientation});
-
-  ModelStylus(tip_state_buffer_, stylus_state_modeler_,
-              loop_contraction_mitigation_modeler_, results,
-              last_input_->input.time);
-  // This indicates that we've finished the stroke.
-  last_input_ = std::nullopt;
 
+  const Time time = ToStrokeTime(input.time);
+  const Time last_input_time = ToStrokeTime(last_input_->input.time);
+  stroke_state_->stylus_state_modeler.Update(
+      input.position, time,
+      {.pressure = input.pressure,
+       .tilt = input.tilt,
+       .orientation = input.orientation});
+
+  // The positions are modeled by ContinuePendingSegment(), which also models
+  // the end of the stroke, and then clears last_input_.
+  pending_segment_ = {.start_position = last_input_->corrected_position,
+                      .start_time = last_input_time,
+                      .end_position = input.position,
+                      .end_time = time,
+                      .n_steps = *n_steps,
+                      .prev_time = last_input_time,
+                      .is_up_event = true};
   return absl::OkStatus();
 }
 
 absl::Status StrokeModeler::ProcessMoveEvent(const Input &input,
-                                             std::vector<Result> &results) {
+                                             int max_steps) {
   if (!last_input_) {
     return absl::FailedPreconditionError(
         "Received move event while no stroke is in-progress");
   }
+  INK_STROKE_TRACE_SCOPE("StrokeModeler::ProcessMoveEvent");
 
-  Vec2 corrected_position = wobble_smoother_.Update(input.position, input.time);
-  stylus_state_modeler_.Update(corrected_position, input.time,
-                               {
-                                   .pressure = input.pressure,
-                                   .tilt = input.tilt,
-                                   .orientation = input.orientation,
-                               });
+  StrokeState &stroke_state = *stroke_state_;
+  const Time time = ToStrokeTime(input.time);
+  Vec2 corrected_position;
+  {
+    INK_STROKE_TRACE_SCOPE("WobbleSmoother::Update");
+    corrected_position =
+        stroke_state.wobble_smoother.Update(input.position, time);
+  }
+  {
+    INK_STROKE_TRACE_SCOPE("StylusStateModeler::Update");
+    stroke_state.stylus_state_modeler.Update(
+        corrected_position, time,
+        {
+            .pressure = input.pressure,
+            .tilt = input.tilt,
+            .orientation = input.orientation,
+        });
+  }
 
   absl::StatusOr<int> n_steps = NumberOfStepsBetweenInputs(
-      position_modeler_.CurrentState(), last_input_->input, input,
+      stroke_state.position_modeler.CurrentState(), last_input_->input, input,
       stroke_model_params_->sampling_params,
-      stroke_model_params_->position_modeler_params);
+      stroke_model_params_->position_modeler_params, max_steps);
   if (!n_steps.ok()) {
     return n_steps.status();
   }
-  tip_state_buffer_.clear();
-  tip_state_buffer_.reserve(*n_steps);
-  position_modeler_.UpdateAlongLinearPath(
-      last_input_->corrected_position, last_input_->input.time,
-      corrected_position, input.time, *n_steps,
-      std::back_inserter(tip_state_buffer_));
+  // The positions are modeled by ContinuePendingSegment().
+  pending_segment_ = {.start_position = last_input_->corrected_position,
+                      .start_time = ToStrokeTime(last_input_->input.time),
+                      .end_position = corrected_position,
+                      .end_time = time,
+                      .n_steps = *n_steps,
+                      .prev_time = time};
 
   if (predictor_ != nullptr) {
-    predictor_->Update(corrected_position, input.time);
+    INK_STROKE_TRACE_SCOPE("InputPredictor::Update");
+    predictor_->Update(corrected_position, time);
   }
   last_input_ = {.input = input, .corrected_position = corrected_position};
-  ModelStylus(tip_state_buffer_, stylus_state_modeler_,
-              loop_contraction_mitigation_modeler_, results,
-              last_input_->input.time);
   return absl::OkStatus();
 }
 
 void StrokeModeler::Save() {
-  wobble_smoother_.Save();
-  position_modeler_.Save();
-  stylus_state_modeler_.Save();
-  loop_contraction_mitigation_modeler_.Save();
-  saved_last_input_ = last_input_;
-  if (predictor_ != nullptr) {
-    saved_predictor_ = predictor_->MakeCopy();
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::save);
+  // Without any stroke state, there's no stroke to save, and the sub-modelers
+  // will be reset by the next stroke anyway.
+  if (stroke_state_ != nullptr) {
+    StrokeState &stroke_state = *stroke_state_;
+    stroke_state.wobble_smoother.Save();
+    stroke_state.position_modeler.Save();
+    stroke_state.stylus_state_modeler.Save();
+    stroke_state.loop_contraction_mitigation_modeler.Save();
+    stroke_state.saved_end_of_stroke_states =
+        stroke_state.end_of_stroke_states;
+    stroke_state.saved_pending_inputs = stroke_state.pending_inputs;
   }
+  saved_last_input_ = last_input_;
+  saved_last_skipped_input_ = last_skipped_input_;
+  saved_pending_segment_ = pending_segment_;
+  saved_time_origin_ = time_origin_;
+  // A null predictor is saved as such, so that Restore() doesn't bring back a
+  // predictor from an earlier stroke.
+  saved_predictor_ = predictor_ == nullptr ? nullptr : predictor_->MakeCopy();
   save_active_ = true;
 }
 
 void StrokeModeler::Restore() {
+  ScopedLatencyRecorder latency(latency_histograms_.get(),
+                                &StrokeModelerLatencyHistograms::restore);
   if (!save_active_) return;
 
-  wobble_smoother_.Restore();
-  position_modeler_.Restore();
-  stylus_state_modeler_.Restore();
-  loop_contraction_mitigation_modeler_.Restore();
+  // If the stroke state was allocated after the call to Save(), its saved
+  // fields are empty, and the sub-modelers have nothing to restore.
+  if (stroke_state_ != nullptr) {
+    StrokeState &stroke_state = *stroke_state_;
+    stroke_state.wobble_smoother.Restore();
+    stroke_state.position_modeler.Restore();
+    stroke_state.stylus_state_modeler.Restore();
+    stroke_state.loop_contraction_mitigation_modeler.Restore();
+    stroke_state.end_of_stroke_states = stroke_state.saved_end_of_stroke_states;
+    stroke_state.pending_inputs = stroke_state.saved_pending_inputs;
+  }
   last_input_ = saved_last_input_;
-  if (saved_predictor_ != nullptr) {
-    predictor_ = saved_predictor_->MakeCopy();
+  last_skipped_input_ = saved_last_skipped_input_;
+  pending_segment_ = saved_pending_segment_;
+  time_origin_ = saved_time_origin_;
+  predictor_ =
+      saved_predictor_ == nullptr ? nullptr : saved_predictor_->MakeCopy();
+}
+
+absl::Status StrokeModeler::Compact() {
+  if (last_input_.has_value() || HasPendingWork()) {
+    return absl::FailedPreconditionError(
+        "Cannot compact while a stroke is in progress");
+  }
+
+  stroke_state_.reset();
+  save_active_ = false;
+  saved_last_input_.reset();
+  saved_last_skipped_input_.reset();
+  saved_pending_segment_.reset();
+  saved_predictor_.reset();
+  scratch_ = PredictionScratch();
+  hypothetical_modeler_.reset();
+
+  // The Kalman predictor may carry its error covariance over to the next
+  // stroke, in which case we keep it.
+  const KalmanPredictorParams *kalman_params =
+      stroke_model_params_ == nullptr
+          ? nullptr
+          : std::get_if<KalmanPredictorParams>(
+                &stroke_model_params_->prediction_params);
+  if (kalman_params == nullptr || !kalman_params->carry_over_error_covariance) {
+    predictor_.reset();
+  }
+  return absl::OkStatus();
+}
+
+void StrokeModeler::EnableLatencyHistograms() {
+  if (latency_histograms_ == nullptr) {
+    latency_histograms_ = std::make_unique<StrokeModelerLatencyHistograms>();
   }
 }
 
@@ -17,23 +17,215 @@
 #ifndef INK_STROKE_MODELER_STROKE_MODELER_H_
 #define INK_STROKE_MODELER_STROKE_MODELER_H_
 
+#include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "ink_stroke_modeler/internal/internal_types.h"
 #include "ink_stroke_modeler/internal/loop_contraction_mitigation_modeler.h"
 #include "ink_stroke_modeler/internal/position_modeler.h"
 #include "ink_stroke_modeler/internal/prediction/input_predictor.h"
 #include "ink_stroke_modeler/internal/stylus_state_modeler.h"
 #include "ink_stroke_modeler/internal/wobble_smoother.h"
+#include "ink_stroke_modeler/latency_histogram.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
 
 namespace ink {
 namespace stroke_model {
 
+// Buffers used while modeling a prediction. These don't hold state between
+// calls; they only allow allocations to be reused. Passing a caller-owned
+// PredictionScratch to the prediction functions below makes them safe to call
+// concurrently with each other, so long as each thread uses its own scratch.
+//
+// The contents are an implementation detail, and should not be accessed
+// directly.
+struct PredictionScratch {
+  std::vector<TipState> tip_states;
+  std::vector<std::optional<Vec2>> stroke_normals;
+  std::vector<Result> projected_states;
+  StylusStateModeler::BatchScratch query_batch;
+};
+
+// Limits the work done by a single call to StrokeModeler::Update() or
+// StrokeModeler::Drain(). Work beyond the budget is deferred to later calls.
+// The default is unlimited.
+struct UpdateBudget {
+  // The maximum number of Results to append per call. Must be greater than
+  // zero.
+  int max_results = std::numeric_limits<int>::max();
+
+  // The time after which to stop modeling, measured on a monotonic clock from
+  // the start of the call. This is checked periodically, so a call may
+  // overrun it slightly; each call makes some progress, even if this is very
+  // small. Must be greater than zero.
+  absl::Duration max_time = absl::InfiniteDuration();
+};
+
+// An immutable copy of the state that a StrokeModeler uses for prediction,
+// taken by StrokeModeler::MakePredictionSnapshot(). This allows one thread to
+// continue updating the modeler while others predict from the snapshot, without
+// either having to wait for the other; see PredictionSnapshotPublisher.
+//
+// The prediction functions behave exactly like those of the same name on
+// StrokeModeler, as of the time the snapshot was taken, except that they can't
+// fail on account of the modeler's state: a snapshot can only be taken while a
+// stroke is in progress and prediction is enabled. They may be called
+// concurrently with each other, so long as each thread uses its own scratch.
+class PredictionSnapshot {
+ public:
+  void Predict(std::vector<Result>& results, PredictionScratch& scratch) const;
+  absl::Status Predict(Duration horizon, Duration sample_spacing,
+                       std::vector<Result>& results,
+                       PredictionScratch& scratch) const;
+  Result PredictAt(Time time) const;
+
+  // The time of the most recent input included in the snapshot.
+  Time LastInputTime() const {
+    return time_origin_ + (last_input_time_ - Time(0));
+  }
+
+ private:
+  friend class StrokeModeler;
+
+  PredictionSnapshot(std::unique_ptr<InputPredictor> predictor,
+                     const TipState& current_state,
+                     const StylusStateModeler& stylus_state_modeler,
+                     const LoopContractionMitigationModeler& loop_modeler,
+                     Time last_input_time, Time time_origin)
+      : predictor_(std::move(predictor)),
+        current_state_(current_state),
+        loop_contraction_mitigation_modeler_(loop_modeler),
+        last_input_time_(last_input_time),
+        time_origin_(time_origin) {
+    // Only the current state is needed for prediction, not the saved state.
+    stylus_state_modeler_.CopyStateFrom(stylus_state_modeler);
+  }
+
+  std::unique_ptr<const InputPredictor> predictor_;
+  TipState current_state_;
+  StylusStateModeler stylus_state_modeler_;
+  LoopContractionMitigationModeler loop_contraction_mitigation_modeler_;
+  // In the modeler's internal time base; see StrokeModeler::time_origin_.
+  Time last_input_time_;
+  Time time_origin_;
+};
+
+// Holds the most recently published PredictionSnapshot, allowing it to be
+// handed from the thread that updates a StrokeModeler to the threads that
+// render its prediction. All methods are thread-safe. The lock is only held
+// while swapping or copying the pointer; in particular, it's never held while
+// modeling or predicting, so neither side is blocked by the other's work.
+//
+// Example usage:
+//   // Input thread:
+//   modeler.Update(input, results);
+//   absl::StatusOr<std::shared_ptr<const PredictionSnapshot>> snapshot =
+//       modeler.MakePredictionSnapshot();
+//   if (snapshot.ok()) publisher.Publish(*std::move(snapshot));
+//
+//   // Render thread:
+//   if (auto snapshot = publisher.Latest(); snapshot != nullptr) {
+//     snapshot->Predict(predicted_results, scratch);
+//   }
+class PredictionSnapshotPublisher {
+ public:
+  // Replaces the published snapshot, which may be null, e.g. to indicate that
+  // the stroke has ended. Readers holding the previous snapshot may continue
+  // to use it.
+  void Publish(std::shared_ptr<const PredictionSnapshot> snapshot) {
+    absl::MutexLock lock(&mutex_);
+    snapshot_.swap(snapshot);
+    // The previous snapshot, now in `snapshot`, is released after the lock,
+    // so that the reader never waits on its destruction.
+  }
+
+  // Returns the most recently published snapshot, or null if none has been
+  // published.
+  std::shared_ptr<const PredictionSnapshot> Latest() const {
+    absl::MutexLock lock(&mutex_);
+    return snapshot_;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::shared_ptr<const PredictionSnapshot> snapshot_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Histograms of the latencies of a StrokeModeler's calls; see
+// StrokeModeler::EnableLatencyHistograms().
+struct StrokeModelerLatencyHistograms {
+  // Update(), with or without a budget.
+  LatencyHistogram update;
+  // Drain(), which is recorded separately from Update(), since it's typically
+  // called off the input path, e.g. when the app is idle.
+  LatencyHistogram drain;
+  // The Predict() overloads, and PredictAt().
+  LatencyHistogram predict;
+  LatencyHistogram save;
+  LatencyHistogram restore;
+
+  // Adds the latencies recorded by `other`, e.g. to aggregate the histograms
+  // of all of the modelers for a device.
+  void Merge(const StrokeModelerLatencyHistograms& other) {
+    update.Merge(other.update);
+    drain.Merge(other.drain);
+    predict.Merge(other.predict);
+    save.Merge(other.save);
+    restore.Merge(other.restore);
+  }
+
+  void Reset() {
+    update.Reset();
+    drain.Reset();
+    predict.Reset();
+    save.Reset();
+    restore.Reset();
+  }
+};
+
+// A validated set of StrokeModelParams, along with the state that a
+// StrokeModeler derives from them, e.g. the predictor's Kalman filters. This is
+// immutable, so a single instance can be shared by any number of
+// StrokeModelers, each of which can then be reset without re-validating the
+// parameters or re-deriving that state.
+class CompiledStrokeModelParams {
+ public:
+  // Returns an error if the parameters are invalid.
+  static absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>>
+  Create(const StrokeModelParams& params);
+
+  CompiledStrokeModelParams(const CompiledStrokeModelParams&) = delete;
+  CompiledStrokeModelParams& operator=(const CompiledStrokeModelParams&) =
+      delete;
+
+  const StrokeModelParams& Params() const { return params_; }
+
+  // The interval between Results at SamplingParams::min_output_rate.
+  Duration MinOutputInterval() const { return min_output_interval_; }
+
+ private:
+  explicit CompiledStrokeModelParams(const StrokeModelParams& params);
+
+  StrokeModelParams params_;
+  Duration min_output_interval_;
+  // A freshly-reset predictor, which is copied by StrokeModeler::Reset(), or
+  // null if prediction is disabled.
+  std::unique_ptr<const InputPredictor> predictor_prototype_;
+
+  friend class StrokeModeler;
+};
+
 // This class models a stroke from a raw input stream. The modeling is performed
 // in several stages, which are delegated to component classes:
 // - Wobble Smoothing: Dampens high-frequency noise from quantization error.
@@ -54,6 +246,11 @@ class StrokeModeler {
   // invalid.
   absl::Status Reset(const StrokeModelParams& stroke_model_params);
 
+  // Like the above, but uses parameters that have already been validated, so
+  // this can't fail, and avoids re-deriving state from them. `params` must not
+  // be null.
+  void Reset(std::shared_ptr<const CompiledStrokeModelParams> params);
+
   // Clears any in-progress stroke, keeping the same model parameters.
   // Returns an error if the model has not yet been initialized via
   // Reset(StrokeModelParams).
@@ -76,9 +273,63 @@ class StrokeModeler {
   //
   // If this does not return an error, results will contain at least one Result,
   // and potentially more than one if the inputs are slower than the minimum
-  // output rate.
+  // output rate, unless the input is skipped as described in
+  // InputCoalescingParams.
   absl::Status Update(const Input& input, std::vector<Result>& results);
 
+  // Like the above, but does at most `budget` worth of modeling, deferring the
+  // rest until later calls to Update() or Drain(). This bounds the latency of
+  // each call, e.g. when a long gap between inputs calls for many upsampled
+  // Results, without dropping any input. Concatenating the Results from a
+  // sequence of budgeted calls, followed by Drain(), gives exactly the Results
+  // that unbudgeted calls would have.
+  //
+  // Since the budget already bounds the work done by each call,
+  // `SamplingParams::max_outputs_per_call` doesn't apply to inputs that are
+  // deferred or modeled by a budgeted call, so the gap between two inputs may
+  // call for more Results than that. Only absurdly long gaps, e.g. from a
+  // clock jump, are rejected.
+  //
+  // The input is checked against the most recent input accepted by Update(),
+  // as above, whether or not that has been modeled yet; if it's rejected, no
+  // work is done. If deferred work fails, e.g. because the input is
+  // non-finite, the error is returned from the call that modeled it, and that
+  // input is discarded, as unbudgeted Update() would have rejected it;
+  // `results` may contain Results from earlier inputs in that case.
+  //
+  // This may append no Results if the budget is spent on deferred work that
+  // doesn't produce any.
+  absl::Status Update(const Input& input, std::vector<Result>& results,
+                      const UpdateBudget& budget);
+
+  // Like the above, but takes a batch of raw samples from a digitizer, e.g.
+  // straight from the driver's buffer, and converts them to Inputs with
+  // `transform`. The samples are converted in chunks, and then modeled in
+  // order, exactly as if each Input had been passed to Update().
+  //
+  // Returns an error if `transform` is invalid, in which case nothing is
+  // modeled, or the error for the first sample that's rejected. In the latter
+  // case, the Results of the samples before it are kept, and the samples
+  // after it aren't modeled.
+  absl::Status Update(absl::Span<const DigitizerSample> samples,
+                      const DigitizerTransform& transform,
+                      std::vector<Result>& results);
+
+  // Models deferred work from budgeted calls to Update(), within `budget`,
+  // appending the Results. With the default budget, this finishes all of the
+  // deferred work. Returns an error if the budget is invalid, or if deferred
+  // work fails as described above.
+  absl::Status Drain(std::vector<Result>& results,
+                     const UpdateBudget& budget = UpdateBudget());
+
+  // Returns true if budgeted calls to Update() have deferred work that hasn't
+  // yet been done. Predictions are made from the modeled state, so they don't
+  // account for deferred inputs.
+  bool HasPendingWork() const {
+    return pending_segment_.has_value() ||
+           (stroke_state_ != nullptr && !stroke_state_->pending_inputs.empty());
+  }
+
   // Models the given input prediction without changing the internal model
   // state, and then clears and fills the results parameter with the new
   // predicted Results. Any previously generated prediction Results are no
@@ -92,7 +343,56 @@ class StrokeModeler {
   // confidence.
   absl::Status Predict(std::vector<Result>& results) const;
 
-  // Saves the current modeler state.
+  // Like the above, but overrides the extent and resolution of the prediction
+  // for this call only. The predicted Results end no later than `horizon`
+  // after the most recent modeled Result, and are spaced approximately
+  // `sample_spacing` apart, instead of at SamplingParams::min_output_rate. This
+  // allows the caller to predict exactly as far ahead as needed, e.g. for the
+  // next frame, without generating more Results than will be drawn.
+  //
+  // For the Kalman predictor, the horizon takes the place of
+  // KalmanPredictorParams::prediction_interval, and the prediction is still
+  // limited by its confidence. For the stroke end predictor, the prediction is
+  // truncated at the horizon.
+  //
+  // In addition to the errors above, returns an error if `horizon` is negative
+  // or `sample_spacing` is not greater than zero.
+  absl::Status Predict(Duration horizon, Duration sample_spacing,
+                       std::vector<Result>& results) const;
+
+  // Returns the predicted Result at the given time, e.g. for rendering a
+  // cursor at the next display timestamp. This evaluates the prediction
+  // directly at that time, instead of constructing and modeling all of it.
+  //
+  // The time is clamped to the range of the prediction that Predict() would
+  // return. If it's at or before the most recent modeled Result, or if the
+  // predictor does not yet have enough data to make a prediction, this models
+  // the most recent state of the pen tip instead. The loop contraction
+  // mitigation is applied as for the first Result of Predict().
+  //
+  // Returns the same errors as Predict().
+  absl::StatusOr<Result> PredictAt(Time time) const;
+
+  // Like the Predict() overloads above, but use the caller-owned `scratch`
+  // instead of this modeler's own buffers. Unlike the above, these may be
+  // called concurrently from multiple threads, so long as each thread uses its
+  // own scratch, and the modeler isn't updated at the same time. To predict
+  // while the modeler is being updated, use MakePredictionSnapshot() instead.
+  absl::Status Predict(std::vector<Result>& results,
+                       PredictionScratch& scratch) const;
+  absl::Status Predict(Duration horizon, Duration sample_spacing,
+                       std::vector<Result>& results,
+                       PredictionScratch& scratch) const;
+
+  // Returns a snapshot of the state used for prediction, from which the
+  // prediction can be constructed on another thread while this modeler
+  // continues to be updated.
+  //
+  // Returns the same errors as Predict().
+  absl::StatusOr<std::shared_ptr<const PredictionSnapshot>>
+  MakePredictionSnapshot() const;
+
+  // Saves the current modeler state, including any deferred work.
   //
   // Subsequent updates can be undone by calling Restore(), until a call to
   // Reset() clears the stroke or a call to Save() sets a new saved state.
@@ -105,36 +405,179 @@ class StrokeModeler {
   // for this stroke.
   void Restore();
 
+  // Models `inputs` as if they followed the inputs passed to Update() so far,
+  // appending the Results, without changing the state of this modeler. This is
+  // equivalent to calling Save(), Update() for each input, and Restore(), but
+  // is cheaper: the inputs are modeled on a scratch modeler that's kept
+  // between calls, to which only the current state of the stroke is copied,
+  // and which doesn't construct a predictor, since Update() doesn't depend on
+  // it. The Results include any deferred work, as Update() would.
+  //
+  // Returns an error if the model has not yet been initialized, if there is
+  // no stroke in progress, if `inputs` contains a down event, or if one of
+  // `inputs` is rejected as by Update(), in which case the Results of the
+  // preceding inputs have been appended. Like Predict(), this is not safe to
+  // call concurrently from multiple threads.
+  absl::Status ModelHypothetical(absl::Span<const Input> inputs,
+                                 std::vector<Result>& results) const;
+
+  // Releases the memory used to model strokes, e.g. the sub-modelers' input
+  // windows, the predictor, the saved state and the scratch buffers, so that a
+  // modeler that's expected to be idle for a while holds little more than its
+  // own footprint and a reference to its parameters. The memory is reallocated
+  // by the next stroke, which is modeled exactly as it would have been without
+  // the call. The predictor is kept if it carries state between strokes, i.e.
+  // if KalmanPredictorParams::carry_over_error_covariance is set.
+  //
+  // This discards the state saved by Save(). Returns an error if a stroke is
+  // in progress, or if there is deferred work.
+  absl::Status Compact();
+
+  // Starts recording the latency of each call to Update(), Drain(), Predict(),
+  // PredictAt(), Save() and Restore(), as measured on a monotonic clock, into
+  // histograms, which are kept across calls to Reset(). The histograms are
+  // allocated here, so recording never allocates, and costs a couple of clock
+  // reads per call. Does nothing if they're already enabled.
+  void EnableLatencyHistograms();
+
+  // Returns the latency histograms, or null if they haven't been enabled.
+  // Merge them across modelers with StrokeModelerLatencyHistograms::Merge().
+  const StrokeModelerLatencyHistograms* LatencyHistograms() const {
+    return latency_histograms_.get();
+  }
+
+  // Clears the latency histograms, e.g. after reporting them, if they've been
+  // enabled.
+  void ResetLatencyHistograms() {
+    if (latency_histograms_ != nullptr) latency_histograms_->Reset();
+  }
+
  private:
   void ResetInternal();
 
   absl::Status ProcessDownEvent(const Input& input,
                                 std::vector<Result>& results);
-  absl::Status ProcessMoveEvent(const Input& input,
-                                std::vector<Result>& results);
-  absl::Status ProcessUpEvent(const Input& input, std::vector<Result>& results);
+  // These return an error if modeling the input would take more than
+  // `max_steps` Results; see StartInput().
+  absl::Status ProcessMoveEvent(const Input& input, int max_steps);
+  absl::Status ProcessUpEvent(const Input& input, int max_steps);
+
+  // Returns the most recent input of the stroke in progress, which must exist,
+  // whether or not it was skipped.
+  const Input& MostRecentInput() const {
+    return last_skipped_input_.has_value() ? *last_skipped_input_
+                                           : last_input_->input;
+  }
+
+  // Checks that `input` can follow the pending inputs.
+  absl::Status ValidatePendingInput(const Input& input) const;
+  // Starts modeling `input`, leaving the rest in pending_segment_. Returns an
+  // error if the segment would take more than `max_steps` Results.
+  absl::Status StartInput(const Input& input, std::vector<Result>& results,
+                          int max_steps);
+
+  class WorkBudget;
+
+  // Models pending work until it's done or `budget` is spent.
+  absl::Status ProcessPendingWork(std::vector<Result>& results,
+                                  WorkBudget& budget);
+  // Models the next part of pending_segment_, clearing it once it's done.
+  void ContinuePendingSegment(std::vector<Result>& results,
+                              WorkBudget& budget);
+
+  // Checks the preconditions shared by the Predict() overloads.
+  absl::Status ValidatePredictionState() const;
 
+  // Convert between the time base of the inputs and Results, and the one used
+  // by the sub-modelers.
+  Time ToStrokeTime(Time time) const { return Time(0) + (time - time_origin_); }
+  Time FromStrokeTime(Time time) const {
+    return time_origin_ + (time - Time(0));
+  }
+
+  // Null if prediction is disabled, or until the first stroke after
+  // initialization or Compact().
   std::unique_ptr<InputPredictor> predictor_;
 
-  std::optional<StrokeModelParams> stroke_model_params_;
+  std::shared_ptr<const CompiledStrokeModelParams> compiled_params_;
+  // Points to compiled_params_->Params(), or null if the modeler has not yet
+  // been initialized.
+  const StrokeModelParams* stroke_model_params_ = nullptr;
 
-  WobbleSmoother wobble_smoother_;
-  PositionModeler position_modeler_;
-  StylusStateModeler stylus_state_modeler_;
-  LoopContractionMitigationModeler loop_contraction_mitigation_modeler_;
+  // The sub-modelers, and the rest of the state that's only needed while a
+  // stroke is being modeled. Most of these hold std::deques, which allocate
+  // even when empty, so this is kept on the heap: it's allocated by the first
+  // stroke, and released by Compact().
+  struct StrokeState {
+    WobbleSmoother wobble_smoother;
+    PositionModeler position_modeler;
+    StylusStateModeler stylus_state_modeler;
+    LoopContractionMitigationModeler loop_contraction_mitigation_modeler;
+
+    // The tip states of the end of the stroke, once modeled for
+    // pending_segment_.
+    std::vector<TipState> end_of_stroke_states;
+    // Inputs that have been accepted, but not yet started.
+    std::deque<Input> pending_inputs;
+
+    std::vector<TipState> saved_end_of_stroke_states;
+    std::deque<Input> saved_pending_inputs;
+  };
+  std::unique_ptr<StrokeState> stroke_state_;
+
+  // These buffers are used as optimization to avoid re-allocating the vectors
+  // in Update(), and in the Predict() overloads that don't take a
+  // PredictionScratch, but don't hold state between calls, so can be mutable.
+  mutable PredictionScratch scratch_;
+  // The modeler on which ModelHypothetical() models its inputs. Null until
+  // the first call, and after Compact().
+  mutable std::unique_ptr<StrokeModeler> hypothetical_modeler_;
 
-  // This buffer is used as optimization to avoid re-allocating the vector in
-  // the predictor but doesn't hold state between calls, so can be mutable.
-  mutable std::vector<TipState> tip_state_buffer_;
+  // The time of the down event of the stroke in progress, if
+  // SamplingParams::use_stroke_relative_time is set, or zero otherwise. The
+  // sub-modelers, predictor and pending segment measure time relative to this,
+  // while the inputs and Results use the caller's time base.
+  Time time_origin_{0};
 
+  // The input is in the caller's time base.
   struct InputAndCorrectedPosition {
     Input input;
     Vec2 corrected_position{0};
   };
   std::optional<InputAndCorrectedPosition> last_input_;
+  // The most recent input of the stroke in progress, if it was skipped as
+  // described in InputCoalescingParams. Later inputs are checked against this
+  // instead of `last_input_`, which remains the most recent modeled input.
+  std::optional<Input> last_skipped_input_;
+
+  // The part of an input's modeling that is left to do: the upsampled steps
+  // along the segment from the previous input, and, for an up event, the end
+  // of the stroke. The sub-modelers have already been updated with the input.
+  struct PendingSegment {
+    Vec2 start_position{0};
+    Time start_time{0};
+    Vec2 end_position{0};
+    Time end_time{0};
+    int n_steps = 0;
+    int next_step = 1;
+    // The time used to compute the stroke normal of the next tip state.
+    Time prev_time{0};
+    bool is_up_event = false;
+    bool modeled_end_of_stroke = false;
+    int next_end_of_stroke_state = 0;
+  };
+  std::optional<PendingSegment> pending_segment_;
+
+  // Null unless EnableLatencyHistograms() has been called. This is recorded
+  // into by const methods, which is safe because the histograms are
+  // thread-safe.
+  std::unique_ptr<StrokeModelerLatencyHistograms> latency_histograms_;
 
   std::unique_ptr<InputPredictor> saved_predictor_;
   std::optional<InputAndCorrectedPosition> saved_last_input_;
+  std::optional<Input> saved_last_skipped_input_;
+  std::optional<PendingSegment> saved_pending_segment_;
+  Time saved_time_origin_{0};
   bool save_active_ = false;
 };
 
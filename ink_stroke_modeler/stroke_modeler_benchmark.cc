@@ -0,0 +1,225 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the per-input cost of StrokeModeler on synthetic strokes of
+// various shapes, as drawn on clean and on noisy digitizers, with each type of
+// predictor, for the cost of a stroke at various input rates, with and without
+// an InputResampler, and for the cost of modeling hypothetical inputs.
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/input_resampler.h"
+#include "ink_stroke_modeler/internal/benchmark_perf_counters.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+// The third argument selects the predictor: 0 for Kalman, 1 for stroke end,
+// and 2 for disabled.
+StrokeModelParams MakeParams(const benchmark::State &state) {
+  StrokeModelParams params = RecommendedStrokeModelParams();
+  switch (state.range(2)) {
+    case 0:
+      break;
+    case 1:
+      params.prediction_params = StrokeEndPredictorParams();
+      break;
+    default:
+      params.prediction_params = DisabledPredictorParams();
+      break;
+  }
+  return params;
+}
+
+// The first argument is the SyntheticStrokeShape. If the second argument is
+// non-zero, the stroke has the timestamp jitter, coalesced inputs and noise of
+// a typical digitizer.
+std::vector<Input> MakeStroke(const benchmark::State &state) {
+  SyntheticStrokeParams params{
+      .shape = static_cast<SyntheticStrokeShape>(state.range(0)),
+      .duration = Duration(2),
+      .input_rate = 240,
+      .pressure_profile = SyntheticPressureProfile::kTaper,
+      .tilt_profile = SyntheticTiltProfile::kVarying};
+  if (state.range(1) != 0) {
+    params.timestamp_jitter = .2;
+    params.coalesce_probability = .05;
+    params.position_noise = .002;
+    params.quantization = .001;
+  }
+  return GenerateSyntheticStroke(params);
+}
+
+void ApplyStrokeArgs(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"shape", "noisy", "predictor"})
+      ->ArgsProduct({{static_cast<int>(SyntheticStrokeShape::kLine),
+                      static_cast<int>(SyntheticStrokeShape::kSpiral),
+                      static_cast<int>(SyntheticStrokeShape::kLissajous),
+                      static_cast<int>(SyntheticStrokeShape::kSignature)},
+                     {0, 1},
+                     {0, 1, 2}});
+}
+
+// Models a whole stroke, without calling Predict(). Hardware counters, where
+// available, are reported per input and per Result.
+void BM_Update(benchmark::State &state) {
+  const StrokeModelParams params = MakeParams(state);
+  const std::vector<Input> inputs = MakeStroke(state);
+  BenchmarkPerfCounters perf_counters(state);
+  StrokeModeler modeler;
+  std::vector<Result> results;
+  int64_t n_results = 0;
+  for (auto _ : state) {
+    if (!modeler.Reset(params).ok()) state.SkipWithError("Reset failed");
+    perf_counters.Start();
+    for (const Input &input : inputs) {
+      results.clear();
+      benchmark::DoNotOptimize(modeler.Update(input, results));
+      n_results += results.size();
+    }
+    perf_counters.Stop();
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  perf_counters.Report(state.iterations() * inputs.size(), n_results);
+}
+BENCHMARK(BM_Update)->Apply(ApplyStrokeArgs);
+
+// Models a whole stroke, predicting after each input as a renderer would. The
+// predicted Results are counted along with the modeled ones.
+void BM_UpdateAndPredict(benchmark::State &state) {
+  const StrokeModelParams params = MakeParams(state);
+  const std::vector<Input> inputs = MakeStroke(state);
+  BenchmarkPerfCounters perf_counters(state);
+  StrokeModeler modeler;
+  std::vector<Result> results;
+  std::vector<Result> prediction;
+  int64_t n_results = 0;
+  for (auto _ : state) {
+    if (!modeler.Reset(params).ok()) state.SkipWithError("Reset failed");
+    perf_counters.Start();
+    for (const Input &input : inputs) {
+      results.clear();
+      benchmark::DoNotOptimize(modeler.Update(input, results));
+      n_results += results.size();
+      if (input.event_type != Input::EventType::kUp) {
+        benchmark::DoNotOptimize(modeler.Predict(prediction));
+        n_results += prediction.size();
+      }
+    }
+    perf_counters.Stop();
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  perf_counters.Report(state.iterations() * inputs.size(), n_results);
+}
+BENCHMARK(BM_UpdateAndPredict)->Apply(ApplyStrokeArgs);
+
+// Models a one-second stroke, predicting after each modeled input. The first
+// argument is the rate of the raw input. If the second argument is non-zero,
+// the raw input is first resampled to 120 Hz, so the cost should be roughly
+// independent of the raw input rate.
+void BM_UpdateAndPredictAtInputRate(benchmark::State &state) {
+  const StrokeModelParams params = RecommendedStrokeModelParams();
+  const std::vector<Input> raw_inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .duration = Duration(1),
+       .input_rate = static_cast<double>(state.range(0)),
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+  const bool resample = state.range(1) != 0;
+  StrokeModeler modeler;
+  InputResampler resampler;
+  if (!resampler.Reset({.target_rate = 120}).ok()) {
+    state.SkipWithError("Invalid resampler params");
+    return;
+  }
+  std::vector<Input> inputs;
+  std::vector<Result> results;
+  std::vector<Result> prediction;
+  for (auto _ : state) {
+    if (!modeler.Reset(params).ok()) state.SkipWithError("Reset failed");
+    resampler.Reset();
+    for (const Input &raw_input : raw_inputs) {
+      inputs.clear();
+      if (resample) {
+        benchmark::DoNotOptimize(resampler.Update(raw_input, inputs));
+      } else {
+        inputs.push_back(raw_input);
+      }
+      for (const Input &input : inputs) {
+        results.clear();
+        benchmark::DoNotOptimize(modeler.Update(input, results));
+        if (input.event_type != Input::EventType::kUp) {
+          benchmark::DoNotOptimize(modeler.Predict(prediction));
+        }
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * raw_inputs.size());
+}
+BENCHMARK(BM_UpdateAndPredictAtInputRate)
+    ->ArgNames({"input_rate", "resample"})
+    ->ArgsProduct({{120, 240, 480, 1000}, {0, 1}});
+
+// Models a whole stroke, and after each input, models the next few inputs
+// hypothetically, as for inputs predicted by the OS. If the fourth argument is
+// non-zero, this uses ModelHypothetical(), and otherwise Save(), Update() and
+// Restore().
+void BM_UpdateAndModelHypothetical(benchmark::State &state) {
+  constexpr int kHypotheticalInputs = 3;
+  const StrokeModelParams params = MakeParams(state);
+  const std::vector<Input> inputs = MakeStroke(state);
+  const bool use_model_hypothetical = state.range(3) != 0;
+  StrokeModeler modeler;
+  std::vector<Result> results;
+  for (auto _ : state) {
+    if (!modeler.Reset(params).ok()) state.SkipWithError("Reset failed");
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      results.clear();
+      benchmark::DoNotOptimize(modeler.Update(inputs[i], results));
+      if (inputs[i].event_type == Input::EventType::kUp) continue;
+      absl::Span<const Input> hypothetical =
+          absl::MakeConstSpan(inputs).subspan(i + 1, kHypotheticalInputs);
+      results.clear();
+      if (use_model_hypothetical) {
+        benchmark::DoNotOptimize(
+            modeler.ModelHypothetical(hypothetical, results));
+      } else {
+        modeler.Save();
+        for (const Input &input : hypothetical) {
+          benchmark::DoNotOptimize(modeler.Update(input, results));
+        }
+        modeler.Restore();
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_UpdateAndModelHypothetical)
+    ->ArgNames({"shape", "noisy", "predictor", "model_hypothetical"})
+    ->ArgsProduct({{static_cast<int>(SyntheticStrokeShape::kSignature)},
+                   {0},
+                   {0, 2},
+                   {0, 1}});
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
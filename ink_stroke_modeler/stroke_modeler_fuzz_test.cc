@@ -1,7 +1,10 @@
+#include <cstdint>
 #include <variant>
 #include <vector>
 
 #include "fuzztest/fuzztest.h"
+#include "gtest/gtest.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/stroke_modeler.h"
 #include "ink_stroke_modeler/types.h"
@@ -44,12 +47,15 @@ fuzztest::Domain<StrokeModelParams> ArbitraryStrokeModelParams() {
           fuzztest::Arbitrary<float>(), fuzztest::Arbitrary<float>()),
       fuzztest::StructOf<PositionModelerParams>(
           fuzztest::Arbitrary<float>(), fuzztest::Arbitrary<float>(),
-          ArbitraryLoopContractionMitigationParameters()),
+          ArbitraryLoopContractionMitigationParameters(),
+          fuzztest::ElementOf<PositionModelerParams::Integrator>(
+              {PositionModelerParams::Integrator::kSemiImplicitEuler,
+               PositionModelerParams::Integrator::kExact})),
       fuzztest::StructOf<SamplingParams>(
           fuzztest::Arbitrary<double>(), fuzztest::Arbitrary<float>(),
           fuzztest::Arbitrary<int>(),
           /*max_outputs_per_call*/ fuzztest::InRange(1000, 100000),
-          fuzztest::Arbitrary<double>()),
+          fuzztest::Arbitrary<double>(), fuzztest::Arbitrary<bool>()),
       ArbitraryStylusStateModelerParams(),
       fuzztest::VariantOf(
           fuzztest::Arbitrary<StrokeEndPredictorParams>(),
@@ -58,9 +64,14 @@ fuzztest::Domain<StrokeModelParams> ArbitraryStrokeModelParams() {
               fuzztest::Arbitrary<int>(), fuzztest::Arbitrary<int>(),
               fuzztest::Arbitrary<float>(), fuzztest::Arbitrary<float>(),
               fuzztest::Arbitrary<float>(), ArbitraryDuration(),
-              fuzztest::Arbitrary<KalmanPredictorParams::ConfidenceParams>()),
+              fuzztest::Arbitrary<KalmanPredictorParams::ConfidenceParams>(),
+              fuzztest::Arbitrary<bool>()),
           fuzztest::Arbitrary<DisabledPredictorParams>()),
-      fuzztest::Arbitrary<ExperimentalParams>());
+      fuzztest::Arbitrary<ExperimentalParams>(),
+      fuzztest::StructOf<InputCoalescingParams>(
+          fuzztest::Arbitrary<bool>(), fuzztest::Arbitrary<float>(),
+          fuzztest::Arbitrary<float>(), fuzztest::Arbitrary<float>(),
+          fuzztest::Arbitrary<float>(), ArbitraryDuration()));
 }
 
 fuzztest::Domain<Input> ArbitraryInput() {
@@ -95,5 +106,57 @@ FUZZ_TEST(StrokeModelerFuzzTest, StrokeModelerDoesNotCrash)
         fuzztest::VariantOf(ArbitraryStrokeModelParams(), ArbitraryInput(),
                             fuzztest::Arbitrary<PredictionCommand>())));
 
+// Generated strokes that look like real handwriting, which are drawn with
+// bounded sizes and speeds.
+fuzztest::Domain<SyntheticStrokeParams> ArbitrarySyntheticStrokeParams() {
+  return fuzztest::StructOf<SyntheticStrokeParams>(
+      fuzztest::ElementOf<SyntheticStrokeShape>(
+          {SyntheticStrokeShape::kLine, SyntheticStrokeShape::kSpiral,
+           SyntheticStrokeShape::kLissajous, SyntheticStrokeShape::kSignature}),
+      /*size*/ fuzztest::InRange(.1f, 50.f),
+      /*origin*/
+      fuzztest::StructOf<Vec2>(fuzztest::InRange(-1000.f, 1000.f),
+                               fuzztest::InRange(-1000.f, 1000.f)),
+      /*start_time*/
+      fuzztest::ConstructorOf<Time>(fuzztest::InRange(0., 10000.)),
+      /*duration*/
+      fuzztest::ConstructorOf<Duration>(fuzztest::InRange(.01, 5.)),
+      /*input_rate*/ fuzztest::InRange(30., 1000.),
+      /*timestamp_jitter*/ fuzztest::InRange(0., 1.),
+      /*coalesce_probability*/ fuzztest::InRange(0., .9),
+      /*position_noise*/ fuzztest::InRange(0.f, .1f),
+      /*quantization*/ fuzztest::InRange(0.f, .01f),
+      fuzztest::ElementOf<SyntheticPressureProfile>(
+          {SyntheticPressureProfile::kNone, SyntheticPressureProfile::kConstant,
+           SyntheticPressureProfile::kTaper,
+           SyntheticPressureProfile::kSpeedDependent}),
+      fuzztest::ElementOf<SyntheticTiltProfile>(
+          {SyntheticTiltProfile::kNone, SyntheticTiltProfile::kConstant,
+           SyntheticTiltProfile::kVarying}),
+      fuzztest::Arbitrary<uint32_t>());
+}
+
+// Unlike arbitrary inputs, realistic strokes modeled with the recommended
+// params should never be rejected.
+void SyntheticStrokeIsModeled(const SyntheticStrokeParams& stroke_params,
+                              bool use_exact_integrator) {
+  StrokeModelParams params = RecommendedStrokeModelParams();
+  if (use_exact_integrator) {
+    params.position_modeler_params.integrator =
+        PositionModelerParams::Integrator::kExact;
+  }
+  StrokeModeler stroke_modeler;
+  ASSERT_TRUE(stroke_modeler.Reset(params).ok());
+  std::vector<Result> results;
+  for (const Input& input : GenerateSyntheticStroke(stroke_params)) {
+    ASSERT_TRUE(stroke_modeler.Update(input, results).ok());
+    ASSERT_TRUE(stroke_modeler.Predict(results).ok() ||
+                input.event_type == Input::EventType::kUp);
+  }
+}
+FUZZ_TEST(StrokeModelerFuzzTest, SyntheticStrokeIsModeled)
+    .WithDomains(ArbitrarySyntheticStrokeParams(),
+                 fuzztest::Arbitrary<bool>());
+
 }  // namespace stroke_model
 }  // namespace ink
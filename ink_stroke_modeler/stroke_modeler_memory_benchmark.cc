@@ -0,0 +1,171 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the memory held by many StrokeModelers, as for a server that keeps
+// one for each remote participant's pointer. The global operator new and
+// delete are replaced in this binary, so that the bytes allocated on the heap
+// can be counted.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/statusor.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+std::atomic<int64_t> live_heap_bytes{0};
+
+// Each allocation is prefixed with its size, so that it can be subtracted when
+// it's freed, whether or not sized deallocation is used.
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+void *CountedAllocate(size_t size) {
+  void *block = std::malloc(size + kHeaderSize);
+  if (block == nullptr) throw std::bad_alloc();
+  *static_cast<size_t *>(block) = size;
+  live_heap_bytes.fetch_add(size, std::memory_order_relaxed);
+  return static_cast<char *>(block) + kHeaderSize;
+}
+
+void CountedFree(void *ptr) {
+  if (ptr == nullptr) return;
+  void *block = static_cast<char *>(ptr) - kHeaderSize;
+  live_heap_bytes.fetch_sub(*static_cast<size_t *>(block),
+                            std::memory_order_relaxed);
+  std::free(block);
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
+
+void *operator new(size_t size) {
+  return ink::stroke_model::CountedAllocate(size);
+}
+void *operator new[](size_t size) {
+  return ink::stroke_model::CountedAllocate(size);
+}
+void operator delete(void *ptr) noexcept {
+  ink::stroke_model::CountedFree(ptr);
+}
+void operator delete[](void *ptr) noexcept {
+  ink::stroke_model::CountedFree(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept {
+  ink::stroke_model::CountedFree(ptr);
+}
+void operator delete[](void *ptr, size_t) noexcept {
+  ink::stroke_model::CountedFree(ptr);
+}
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+const StrokeModelParams kParams = RecommendedStrokeModelParams();
+
+// The state in which the modelers are measured.
+enum class ModelerPhase {
+  // Partway through a stroke.
+  kActive,
+  // After a stroke has ended.
+  kIdle,
+  // After a stroke has ended, and StrokeModeler::Compact() has been called.
+  kCompact,
+};
+
+// Models a stroke, predicting after each input, on each of a number of
+// modelers sharing the same parameters, and reports the memory that they hold
+// afterwards, including the modelers themselves, as "bytes_per_modeler". The
+// first argument is the ModelerPhase, and the second the number of modelers.
+void BM_BytesPerModeler(benchmark::State &state) {
+  const auto phase = static_cast<ModelerPhase>(state.range(0));
+  const int n_modelers = state.range(1);
+  absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>> params =
+      CompiledStrokeModelParams::Create(kParams);
+  if (!params.ok()) {
+    state.SkipWithError("Invalid params");
+    return;
+  }
+  const std::vector<Input> inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .duration = Duration(1),
+       .input_rate = 240,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+  const int n_inputs =
+      phase == ModelerPhase::kActive ? inputs.size() / 2 : inputs.size();
+
+  // Grow the output buffers ahead of time, so that they aren't counted.
+  std::vector<Result> results;
+  std::vector<Result> prediction;
+  {
+    StrokeModeler modeler;
+    modeler.Reset(*params);
+    for (const Input &input : inputs) {
+      if (!modeler.Update(input, results).ok()) state.SkipWithError("Update");
+      if (input.event_type != Input::EventType::kUp) {
+        if (!modeler.Predict(prediction).ok()) state.SkipWithError("Predict");
+      }
+    }
+  }
+
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const int64_t bytes_before = live_heap_bytes.load();
+    std::vector<StrokeModeler> modelers(n_modelers);
+    for (StrokeModeler &modeler : modelers) {
+      modeler.Reset(*params);
+      for (int i = 0; i < n_inputs; ++i) {
+        results.clear();
+        benchmark::DoNotOptimize(modeler.Update(inputs[i], results));
+        if (inputs[i].event_type != Input::EventType::kUp) {
+          benchmark::DoNotOptimize(modeler.Predict(prediction));
+        }
+      }
+      if (phase == ModelerPhase::kCompact) {
+        benchmark::DoNotOptimize(modeler.Compact());
+      }
+    }
+    bytes = live_heap_bytes.load() - bytes_before;
+
+    state.PauseTiming();
+    modelers.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * n_modelers);
+  state.counters["bytes_per_modeler"] = static_cast<double>(bytes) / n_modelers;
+}
+BENCHMARK(BM_BytesPerModeler)
+    ->ArgNames({"phase", "modelers"})
+    ->ArgsProduct({{static_cast<int>(ModelerPhase::kActive),
+                    static_cast<int>(ModelerPhase::kIdle),
+                    static_cast<int>(ModelerPhase::kCompact)},
+                   {100}});
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,195 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_modeler_pipeline.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ink_stroke_modeler/internal/spsc_ring_buffer.h"
+#include "ink_stroke_modeler/internal/validation.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+// Increments `signal` and wakes the thread waiting on it, if any.
+void Signal(std::atomic<uint32_t> &signal) {
+  signal.fetch_add(1, std::memory_order_release);
+  signal.notify_one();
+}
+
+}  // namespace
+
+void StrokeModelerPipeline::LatencyAccumulator::Add(
+    std::chrono::steady_clock::duration latency) {
+  int64_t nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+  total_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+  // There's only one writer, so we don't need a compare-and-swap loop.
+  if (nanoseconds > max_nanoseconds.load(std::memory_order_relaxed)) {
+    max_nanoseconds.store(nanoseconds, std::memory_order_relaxed);
+  }
+}
+
+StrokeModelerPipeline::~StrokeModelerPipeline() { Stop(); }
+
+absl::Status StrokeModelerPipeline::Start(
+    const StrokeModelParams &stroke_model_params,
+    const StrokeModelerPipelineParams &pipeline_params) {
+  Stop();
+
+  if (absl::Status status = ValidateGreaterThanZero(
+          pipeline_params.input_capacity,
+          "StrokeModelerPipelineParams::input_capacity");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = ValidateGreaterThanZero(
+          pipeline_params.output_capacity,
+          "StrokeModelerPipelineParams::output_capacity");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = modeler_.Reset(stroke_model_params);
+      !status.ok()) {
+    return status;
+  }
+
+  params_ = pipeline_params;
+  inputs_ = std::make_unique<SpscRingBuffer<QueuedInput>>(
+      pipeline_params.input_capacity);
+  outputs_ = std::make_unique<SpscRingBuffer<ResultBatch>>(
+      pipeline_params.output_capacity);
+
+  inputs_pushed_ = 0;
+  inputs_rejected_ = 0;
+  batches_popped_ = 0;
+  output_stalls_ = 0;
+  for (LatencyAccumulator *latency :
+       {&input_queue_latency_, &end_to_end_latency_}) {
+    latency->total_nanoseconds = 0;
+    latency->max_nanoseconds = 0;
+  }
+
+  stopping_ = false;
+  modeling_thread_ = std::thread(&StrokeModelerPipeline::RunModelingLoop, this);
+  return absl::OkStatus();
+}
+
+void StrokeModelerPipeline::Stop() {
+  if (!modeling_thread_.joinable()) return;
+
+  stopping_ = true;
+  Signal(input_signal_);
+  Signal(output_signal_);
+  modeling_thread_.join();
+
+  inputs_.reset();
+  outputs_.reset();
+}
+
+bool StrokeModelerPipeline::TryPushInput(const Input &input) {
+  if (inputs_ == nullptr) return false;
+
+  if (!inputs_->TryPush(
+          {.input = input, .push_time = std::chrono::steady_clock::now()})) {
+    inputs_rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  inputs_pushed_.fetch_add(1, std::memory_order_relaxed);
+  Signal(input_signal_);
+  return true;
+}
+
+bool StrokeModelerPipeline::TryPopResults(ResultBatch &batch) {
+  if (outputs_ == nullptr || !outputs_->TryPop(batch)) return false;
+
+  Signal(output_signal_);
+  batches_popped_.fetch_add(1, std::memory_order_relaxed);
+  end_to_end_latency_.Add(std::chrono::steady_clock::now() -
+                          batch.input_push_time);
+  return true;
+}
+
+StrokeModelerPipelineStats StrokeModelerPipeline::Stats() const {
+  return {
+      .inputs_pushed = inputs_pushed_.load(std::memory_order_relaxed),
+      .inputs_rejected = inputs_rejected_.load(std::memory_order_relaxed),
+      .batches_popped = batches_popped_.load(std::memory_order_relaxed),
+      .output_stalls = output_stalls_.load(std::memory_order_relaxed),
+      .total_input_queue_latency = absl::Nanoseconds(
+          input_queue_latency_.total_nanoseconds.load(
+              std::memory_order_relaxed)),
+      .max_input_queue_latency = absl::Nanoseconds(
+          input_queue_latency_.max_nanoseconds.load(std::memory_order_relaxed)),
+      .total_end_to_end_latency = absl::Nanoseconds(
+          end_to_end_latency_.total_nanoseconds.load(
+              std::memory_order_relaxed)),
+      .max_end_to_end_latency = absl::Nanoseconds(
+          end_to_end_latency_.max_nanoseconds.load(std::memory_order_relaxed)),
+  };
+}
+
+void StrokeModelerPipeline::RunModelingLoop() {
+  QueuedInput queued;
+  while (true) {
+    // We read the signal before checking the queue, so that if an input is
+    // pushed after the check, the signal will have changed and the wait below
+    // will return immediately.
+    uint32_t signal = input_signal_.load(std::memory_order_acquire);
+    if (stopping_) return;
+    if (!inputs_->TryPop(queued)) {
+      input_signal_.wait(signal, std::memory_order_acquire);
+      continue;
+    }
+    input_queue_latency_.Add(std::chrono::steady_clock::now() -
+                             queued.push_time);
+
+    batch_.input = queued.input;
+    batch_.input_push_time = queued.push_time;
+    batch_.results.clear();
+    batch_.prediction.clear();
+    batch_.status = modeler_.Update(queued.input, batch_.results);
+    if (batch_.status.ok() && params_.predict && inputs_->Empty()) {
+      // This fails if prediction is disabled or the stroke has ended, in which
+      // case there's simply no prediction.
+      if (!modeler_.Predict(batch_.prediction).ok()) batch_.prediction.clear();
+    }
+
+    if (!PublishBatch()) return;
+  }
+}
+
+bool StrokeModelerPipeline::PublishBatch() {
+  if (outputs_->TryPush(batch_)) return true;
+
+  output_stalls_.fetch_add(1, std::memory_order_relaxed);
+  while (true) {
+    uint32_t signal = output_signal_.load(std::memory_order_acquire);
+    if (stopping_) return false;
+    if (outputs_->TryPush(batch_)) return true;
+    output_signal_.wait(signal, std::memory_order_acquire);
+  }
+}
+
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_STROKE_MODELER_PIPELINE_H_
+#define INK_STROKE_MODELER_STROKE_MODELER_PIPELINE_H_
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ink_stroke_modeler/internal/spsc_ring_buffer.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+struct StrokeModelerPipelineParams {
+  // The maximum number of inputs that may be waiting to be modeled. Once this
+  // many are waiting, TryPushInput() fails until the modeling thread catches
+  // up.
+  int input_capacity = 256;
+
+  // The maximum number of ResultBatches that may be waiting to be popped. Once
+  // this many are waiting, the modeling thread stops modeling until the
+  // consumer catches up, which in turn fills up the input queue.
+  int output_capacity = 64;
+
+  // If true, each ResultBatch also contains the prediction as of its input.
+  // The prediction is skipped if more inputs are already waiting to be
+  // modeled, since it would be superseded before it could be drawn.
+  bool predict = true;
+};
+
+// The output of the pipeline for a single input.
+struct ResultBatch {
+  // The input that produced this batch.
+  Input input;
+
+  // The status returned by StrokeModeler::Update() for the input. If this is
+  // not OK, `results` and `prediction` are empty.
+  absl::Status status;
+
+  // The Results appended by StrokeModeler::Update() for the input.
+  std::vector<Result> results;
+
+  // The Results of StrokeModeler::Predict() after the input, if prediction is
+  // enabled and available; see StrokeModelerPipelineParams::predict.
+  std::vector<Result> prediction;
+
+  // When the input was pushed into the pipeline.
+  std::chrono::steady_clock::time_point input_push_time;
+};
+
+// Counters and latencies for a StrokeModelerPipeline, accumulated since it was
+// started.
+struct StrokeModelerPipelineStats {
+  // The number of inputs accepted by, and rejected by, TryPushInput().
+  int64_t inputs_pushed = 0;
+  int64_t inputs_rejected = 0;
+
+  // The number of ResultBatches popped by TryPopResults().
+  int64_t batches_popped = 0;
+
+  // The number of times the modeling thread had to wait for the consumer
+  // because the output queue was full.
+  int64_t output_stalls = 0;
+
+  // The time from an input being pushed to the modeling thread starting to
+  // model it.
+  absl::Duration total_input_queue_latency = absl::ZeroDuration();
+  absl::Duration max_input_queue_latency = absl::ZeroDuration();
+
+  // The time from an input being pushed to its ResultBatch being popped.
+  absl::Duration total_end_to_end_latency = absl::ZeroDuration();
+  absl::Duration max_end_to_end_latency = absl::ZeroDuration();
+};
+
+// This class runs a StrokeModeler on a dedicated modeling thread, connected to
+// an input thread and a consumer (e.g. render) thread by bounded, lock-free
+// single-producer/single-consumer queues:
+//
+//   input --TryPushInput()--> modeling thread --TryPopResults()--> consumer
+//
+// TryPushInput() must only ever be called from one thread at a time, as must
+// TryPopResults(); the two may be different threads. Neither blocks: when the
+// queues are full or empty respectively, they return false, and the caller
+// decides whether to retry, drop, or do something else. The modeling thread
+// sleeps while there is no input. Start() and Stop() must not be called
+// concurrently with any other method.
+//
+// Example usage:
+//   StrokeModelerPipeline pipeline;
+//   pipeline.Start(model_params, StrokeModelerPipelineParams());
+//
+//   // Input thread:
+//   if (!pipeline.TryPushInput(input)) { /* Backpressure. */ }
+//
+//   // Render thread:
+//   ResultBatch batch;
+//   while (pipeline.TryPopResults(batch)) { /* Draw batch. */ }
+class StrokeModelerPipeline {
+ public:
+  StrokeModelerPipeline() = default;
+  ~StrokeModelerPipeline();
+
+  StrokeModelerPipeline(const StrokeModelerPipeline&) = delete;
+  StrokeModelerPipeline& operator=(const StrokeModelerPipeline&) = delete;
+
+  // Stops the pipeline if it's running, discarding any queued inputs and
+  // results, then starts it with the given parameters. Returns an error if
+  // either set of parameters is invalid, in which case the pipeline is left
+  // stopped.
+  absl::Status Start(const StrokeModelParams& stroke_model_params,
+                     const StrokeModelerPipelineParams& pipeline_params);
+
+  // Stops the modeling thread, after it finishes modeling the input it's
+  // currently working on, if any. Queued inputs and unread results are
+  // discarded. Does nothing if the pipeline is not running.
+  void Stop();
+
+  // Queues the input for modeling. Returns false if the pipeline isn't running
+  // or the input queue is full.
+  bool TryPushInput(const Input& input);
+
+  // Swaps the oldest unread ResultBatch into `batch`, and returns true, or
+  // returns false if there is none. The previous contents of `batch` are
+  // recycled, so reusing the same ResultBatch for each call avoids
+  // allocations.
+  bool TryPopResults(ResultBatch& batch);
+
+  // Returns the statistics accumulated since the pipeline was last started.
+  // This may be called from any thread.
+  StrokeModelerPipelineStats Stats() const;
+
+ private:
+  struct QueuedInput {
+    Input input;
+    std::chrono::steady_clock::time_point push_time;
+  };
+
+  // Lock-free accumulators for a latency statistic, updated by one thread and
+  // read by any.
+  struct LatencyAccumulator {
+    std::atomic<int64_t> total_nanoseconds = 0;
+    std::atomic<int64_t> max_nanoseconds = 0;
+
+    void Add(std::chrono::steady_clock::duration latency);
+  };
+
+  void RunModelingLoop();
+
+  // Pushes `batch_` to the output queue, waiting for space if necessary.
+  // Returns false if the pipeline was stopped while waiting.
+  bool PublishBatch();
+
+  StrokeModelerPipelineParams params_;
+  StrokeModeler modeler_;
+
+  std::unique_ptr<SpscRingBuffer<QueuedInput>> inputs_;
+  std::unique_ptr<SpscRingBuffer<ResultBatch>> outputs_;
+
+  // These are incremented after each push to, and pop from, the queues,
+  // respectively, so that the other side can wait on them.
+  std::atomic<uint32_t> input_signal_ = 0;
+  std::atomic<uint32_t> output_signal_ = 0;
+
+  std::atomic<bool> stopping_ = false;
+  std::thread modeling_thread_;
+
+  // The batch being built by the modeling thread.
+  ResultBatch batch_;
+
+  std::atomic<int64_t> inputs_pushed_ = 0;
+  std::atomic<int64_t> inputs_rejected_ = 0;
+  std::atomic<int64_t> batches_popped_ = 0;
+  std::atomic<int64_t> output_stalls_ = 0;
+  LatencyAccumulator input_queue_latency_;
+  LatencyAccumulator end_to_end_latency_;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_STROKE_MODELER_PIPELINE_H_
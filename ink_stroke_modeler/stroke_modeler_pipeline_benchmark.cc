@@ -0,0 +1,133 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the queueing latency of StrokeModelerPipeline, compared to
+// calling StrokeModeler directly on a single thread.
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/time/time.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/stroke_modeler_pipeline.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+constexpr int kInputsPerStroke = 500;
+
+const StrokeModelParams kParams = RecommendedStrokeModelParams();
+
+// A signature-like stroke, with inputs at 240Hz.
+std::vector<Input> MakeStroke() {
+  return GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .size = 20,
+       .duration = Duration((kInputsPerStroke - 1) / 240.),
+       .input_rate = 240,
+       .pressure_profile = SyntheticPressureProfile::kSpeedDependent});
+}
+
+// Models each input and predicts on the calling thread, as a baseline for the
+// per-input cost of modeling without any queueing.
+void BM_DirectUpdateAndPredict(benchmark::State &state) {
+  const std::vector<Input> inputs = MakeStroke();
+  StrokeModeler modeler;
+  std::vector<Result> results;
+  std::vector<Result> prediction;
+  for (auto _ : state) {
+    if (!modeler.Reset(kParams).ok()) state.SkipWithError("Reset failed");
+    for (const Input &input : inputs) {
+      results.clear();
+      benchmark::DoNotOptimize(modeler.Update(input, results));
+      if (input.event_type != Input::EventType::kUp) {
+        benchmark::DoNotOptimize(modeler.Predict(prediction));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_DirectUpdateAndPredict);
+
+// Pushes a stroke through the pipeline from the benchmark thread, with a
+// consumer thread popping the results, and reports the mean and max queueing
+// latencies. The argument is the interval between inputs in microseconds; an
+// interval of zero pushes inputs as fast as the pipeline accepts them, which
+// measures the latency when the modeling thread is saturated.
+void BM_PipelineQueueingLatency(benchmark::State &state) {
+  const std::vector<Input> inputs = MakeStroke();
+  const auto input_interval = std::chrono::microseconds(state.range(0));
+
+  StrokeModelerPipeline pipeline;
+  if (!pipeline.Start(kParams, StrokeModelerPipelineParams()).ok()) {
+    state.SkipWithError("Start failed");
+    return;
+  }
+  std::atomic<int64_t> n_to_pop = 0;
+  std::atomic<bool> done = false;
+  std::thread consumer([&pipeline, &n_to_pop, &done]() {
+    ResultBatch batch;
+    while (!done.load(std::memory_order_relaxed)) {
+      if (pipeline.TryPopResults(batch)) {
+        n_to_pop.fetch_sub(1, std::memory_order_relaxed);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (auto _ : state) {
+    auto next_push_time = std::chrono::steady_clock::now();
+    for (const Input &input : inputs) {
+      while (std::chrono::steady_clock::now() < next_push_time) {
+      }
+      while (!pipeline.TryPushInput(input)) std::this_thread::yield();
+      n_to_pop.fetch_add(1, std::memory_order_relaxed);
+      next_push_time += input_interval;
+    }
+    // Wait for the stroke to drain, so that strokes don't overlap.
+    while (n_to_pop.load(std::memory_order_relaxed) > 0) {
+      std::this_thread::yield();
+    }
+  }
+  done = true;
+  consumer.join();
+
+  StrokeModelerPipelineStats stats = pipeline.Stats();
+  const double n_batches = stats.batches_popped;
+  state.SetItemsProcessed(stats.batches_popped);
+  state.counters["mean_input_queue_us"] =
+      absl::ToDoubleMicroseconds(stats.total_input_queue_latency) / n_batches;
+  state.counters["max_input_queue_us"] =
+      absl::ToDoubleMicroseconds(stats.max_input_queue_latency);
+  state.counters["mean_end_to_end_us"] =
+      absl::ToDoubleMicroseconds(stats.total_end_to_end_latency) / n_batches;
+  state.counters["max_end_to_end_us"] =
+      absl::ToDoubleMicroseconds(stats.max_end_to_end_latency);
+  state.counters["rejected_inputs"] = stats.inputs_rejected;
+  state.counters["output_stalls"] = stats.output_stalls;
+}
+BENCHMARK(BM_PipelineQueueingLatency)->Arg(0)->Arg(50)->Arg(200)->UseRealTime();
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
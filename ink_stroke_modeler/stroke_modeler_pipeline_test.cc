@@ -0,0 +1,211 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_modeler_pipeline.h"
+
+#include <cmath>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+const StrokeModelParams kDefaultParams{
+    .wobble_smoother_params{
+        .timeout = Duration(.04), .speed_floor = 1.31, .speed_ceiling = 1.44},
+    .position_modeler_params{.spring_mass_constant = 11.f / 32400,
+                             .drag_constant = 72.f},
+    .sampling_params{.min_output_rate = 180,
+                     .end_of_stroke_stopping_distance = .001,
+                     .end_of_stroke_max_iterations = 20},
+    .stylus_state_modeler_params{.max_input_samples = 20},
+    .prediction_params = StrokeEndPredictorParams()};
+
+std::vector<Input> MakeStroke(int n_inputs) {
+  std::vector<Input> inputs;
+  for (int i = 0; i < n_inputs; ++i) {
+    Input::EventType event_type = Input::EventType::kMove;
+    if (i == 0) {
+      event_type = Input::EventType::kDown;
+    } else if (i == n_inputs - 1) {
+      event_type = Input::EventType::kUp;
+    }
+    inputs.push_back({.event_type = event_type,
+                      .position = {std::cos(i * .1f), std::sin(i * .1f)},
+                      .time = Time(i * .005)});
+  }
+  return inputs;
+}
+
+TEST(StrokeModelerPipelineTest, StartRejectsInvalidParams) {
+  StrokeModelerPipeline pipeline;
+  EXPECT_EQ(pipeline.Start(StrokeModelParams(), StrokeModelerPipelineParams())
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(pipeline.Start(kDefaultParams, {.input_capacity = 0}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(pipeline.Start(kDefaultParams, {.output_capacity = -1}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_FALSE(pipeline.TryPushInput(MakeStroke(1)[0]));
+}
+
+TEST(StrokeModelerPipelineTest, NotRunningUntilStarted) {
+  StrokeModelerPipeline pipeline;
+  EXPECT_FALSE(pipeline.TryPushInput(MakeStroke(1)[0]));
+  ResultBatch batch;
+  EXPECT_FALSE(pipeline.TryPopResults(batch));
+  pipeline.Stop();
+
+  ASSERT_TRUE(pipeline.Start(kDefaultParams, {}).ok());
+  pipeline.Stop();
+  EXPECT_FALSE(pipeline.TryPushInput(MakeStroke(1)[0]));
+}
+
+// Pushes a stroke from one thread while popping from another, and checks that
+// the results are the same as modeling the stroke directly.
+TEST(StrokeModelerPipelineTest, MatchesDirectModeling) {
+  const std::vector<Input> inputs = MakeStroke(100);
+
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<std::vector<Result>> expected_results;
+  for (const Input &input : inputs) {
+    std::vector<Result> results;
+    ASSERT_TRUE(modeler.Update(input, results).ok());
+    expected_results.push_back(results);
+  }
+
+  StrokeModelerPipeline pipeline;
+  // Use small queues, so that both sides have to wait for the other.
+  ASSERT_TRUE(pipeline
+                  .Start(kDefaultParams,
+                         {.input_capacity = 4, .output_capacity = 2})
+                  .ok());
+  std::thread input_thread([&pipeline, &inputs]() {
+    for (const Input &input : inputs) {
+      while (!pipeline.TryPushInput(input)) std::this_thread::yield();
+    }
+  });
+
+  ResultBatch batch;
+  int n_popped = 0;
+  while (n_popped < static_cast<int>(inputs.size())) {
+    if (!pipeline.TryPopResults(batch)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_TRUE(batch.status.ok());
+    EXPECT_EQ(batch.input, inputs[n_popped]);
+    EXPECT_EQ(batch.results, expected_results[n_popped]);
+    ++n_popped;
+  }
+  input_thread.join();
+  // The last input ends the stroke, so there's no prediction for it.
+  EXPECT_THAT(batch.prediction, IsEmpty());
+
+  StrokeModelerPipelineStats stats = pipeline.Stats();
+  EXPECT_EQ(stats.inputs_pushed, inputs.size());
+  EXPECT_EQ(stats.batches_popped, inputs.size());
+  EXPECT_GE(stats.max_end_to_end_latency, stats.max_input_queue_latency);
+  EXPECT_GE(stats.total_end_to_end_latency, stats.total_input_queue_latency);
+  EXPECT_GT(stats.total_end_to_end_latency, absl::ZeroDuration());
+}
+
+TEST(StrokeModelerPipelineTest, PredictsWhenNoInputIsWaiting) {
+  const std::vector<Input> inputs = MakeStroke(10);
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  StrokeModelerPipeline pipeline;
+  ASSERT_TRUE(pipeline.Start(kDefaultParams, {}).ok());
+
+  // Wait for each batch before pushing the next input, so that the input queue
+  // is always empty once the input has been modeled.
+  ResultBatch batch;
+  std::vector<Result> results;
+  std::vector<Result> expected_prediction;
+  for (int i = 0; i + 1 < static_cast<int>(inputs.size()); ++i) {
+    ASSERT_TRUE(modeler.Update(inputs[i], results).ok());
+    ASSERT_TRUE(modeler.Predict(expected_prediction).ok());
+    ASSERT_TRUE(pipeline.TryPushInput(inputs[i]));
+    while (!pipeline.TryPopResults(batch)) std::this_thread::yield();
+    EXPECT_EQ(batch.prediction, expected_prediction);
+  }
+  EXPECT_THAT(batch.prediction, Not(IsEmpty()));
+
+  StrokeModelerPipeline no_prediction_pipeline;
+  ASSERT_TRUE(
+      no_prediction_pipeline.Start(kDefaultParams, {.predict = false}).ok());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(no_prediction_pipeline.TryPushInput(inputs[i]));
+    while (!no_prediction_pipeline.TryPopResults(batch)) {
+      std::this_thread::yield();
+    }
+    EXPECT_THAT(batch.prediction, IsEmpty());
+  }
+}
+
+TEST(StrokeModelerPipelineTest, ReportsBackpressureAndErrors) {
+  StrokeModelerPipeline pipeline;
+  ASSERT_TRUE(pipeline
+                  .Start(kDefaultParams,
+                         {.input_capacity = 2, .output_capacity = 1})
+                  .ok());
+
+  // Nothing is popped, so the modeling thread stalls on the second batch, and
+  // the input queue fills up behind it.
+  const std::vector<Input> inputs = MakeStroke(10);
+  int n_pushed = 0;
+  for (const Input &input : inputs) {
+    if (pipeline.TryPushInput(input)) ++n_pushed;
+  }
+  EXPECT_GE(n_pushed, 2);
+  EXPECT_LT(n_pushed, inputs.size());
+  StrokeModelerPipelineStats stats = pipeline.Stats();
+  EXPECT_EQ(stats.inputs_pushed, n_pushed);
+  EXPECT_EQ(stats.inputs_rejected, inputs.size() - n_pushed);
+  while (pipeline.Stats().output_stalls == 0) std::this_thread::yield();
+
+  ResultBatch batch;
+  for (int i = 0; i < n_pushed; ++i) {
+    while (!pipeline.TryPopResults(batch)) std::this_thread::yield();
+    EXPECT_TRUE(batch.status.ok());
+    EXPECT_THAT(batch.results, Not(IsEmpty()));
+  }
+
+  // Errors from the modeler are passed through, e.g. for an input that goes
+  // backwards in time, or a move event after the up event.
+  ASSERT_TRUE(pipeline.TryPushInput({.event_type = Input::EventType::kMove,
+                                     .position = {5, 5},
+                                     .time = Time(-1)}));
+  while (!pipeline.TryPopResults(batch)) std::this_thread::yield();
+  EXPECT_FALSE(batch.status.ok());
+  EXPECT_THAT(batch.results, IsEmpty());
+  EXPECT_THAT(batch.prediction, IsEmpty());
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
@@ -14,12 +14,24 @@
 
 #include "ink_stroke_modeler/stroke_modeler.h"
 
+#include <atomic>
 #include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
 #include "ink_stroke_modeler/internal/type_matchers.h"
 #include "ink_stroke_modeler/params.h"
 #include "ink_stroke_modeler/types.h"
@@ -75,6 +87,263 @@ TEST(StrokeModelerTest, NoPredictionWithDisabledPredictor) {
             absl::StatusCode::kFailedPrecondition);
 }
 
+TEST(StrokeModelerTest, PredictWithHorizonAndSampleSpacing) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Result> results;
+  EXPECT_EQ(modeler.Predict(Duration(.02), Duration(.01), results).code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {3, 4},
+                           .time = Time(0)},
+                          results)
+                  .ok());
+  results.clear();
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {3.5, 4.2},
+                           .time = Time(.02)},
+                          results)
+                  .ok());
+  ASSERT_THAT(results, Not(IsEmpty()));
+  const Time last_time = results.back().time;
+
+  EXPECT_EQ(modeler.Predict(Duration(-.01), Duration(.01), results).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results, IsEmpty());
+  EXPECT_EQ(modeler.Predict(Duration(.02), Duration(0), results).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results, IsEmpty());
+
+  std::vector<Result> full_prediction;
+  ASSERT_TRUE(modeler.Predict(full_prediction).ok());
+  ASSERT_TRUE(modeler.Predict(Duration(.02), Duration(.01), results).ok());
+  ASSERT_THAT(results, Not(IsEmpty()));
+  EXPECT_LT(results.size(), full_prediction.size());
+  EXPECT_LE(results.back().time, last_time + Duration(.02));
+  Time previous_time = last_time;
+  for (const Result &result : results) {
+    EXPECT_GT(result.time, previous_time);
+    previous_time = result.time;
+  }
+
+  ASSERT_TRUE(modeler.Predict(Duration(0), Duration(.01), results).ok());
+  EXPECT_THAT(results, IsEmpty());
+}
+
+TEST(StrokeModelerTest, PredictAt) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  EXPECT_EQ(modeler.PredictAt(Time(.03)).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {3, 4},
+                           .time = Time(0),
+                           .pressure = .2,
+                           .tilt = .3,
+                           .orientation = .4},
+                          results)
+                  .ok());
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {3.5, 4.2},
+                           .time = Time(.02),
+                           .pressure = .4,
+                           .tilt = .5,
+                           .orientation = .6},
+                          results)
+                  .ok());
+
+  std::vector<Result> prediction;
+  ASSERT_TRUE(modeler.Predict(prediction).ok());
+  ASSERT_THAT(prediction, Not(IsEmpty()));
+  for (const Result &predicted : prediction) {
+    absl::StatusOr<Result> result = modeler.PredictAt(predicted.time);
+    ASSERT_TRUE(result.ok());
+    EXPECT_THAT(*result, ResultNear(predicted, kTol, kAccelTol));
+  }
+
+  absl::StatusOr<Result> result = modeler.PredictAt(Time(1));
+  ASSERT_TRUE(result.ok());
+  EXPECT_THAT(*result, ResultNear(prediction.back(), kTol, kAccelTol));
+}
+
+TEST(StrokeModelerTest, PredictWithCallerOwnedScratch) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  PredictionScratch scratch;
+  std::vector<Result> results;
+  EXPECT_EQ(modeler.Predict(results, scratch).code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {3, 4},
+                           .time = Time(0)},
+                          results)
+                  .ok());
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {3.5, 4.2},
+                           .time = Time(.02)},
+                          results)
+                  .ok());
+
+  std::vector<Result> expected;
+  ASSERT_TRUE(modeler.Predict(expected).ok());
+  ASSERT_TRUE(modeler.Predict(results, scratch).ok());
+  EXPECT_EQ(results, expected);
+
+  ASSERT_TRUE(modeler.Predict(Duration(.02), Duration(.01), expected).ok());
+  ASSERT_TRUE(
+      modeler.Predict(Duration(.02), Duration(.01), results, scratch).ok());
+  EXPECT_EQ(results, expected);
+}
+
+TEST(StrokeModelerTest, MakePredictionSnapshotErrors) {
+  StrokeModeler modeler;
+  EXPECT_EQ(modeler.MakePredictionSnapshot().status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  StrokeModelParams params = kDefaultParams;
+  params.prediction_params = DisabledPredictorParams{};
+  ASSERT_TRUE(modeler.Reset(params).ok());
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {3, 4},
+                           .time = Time(0)},
+                          results)
+                  .ok());
+  EXPECT_EQ(modeler.MakePredictionSnapshot().status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  EXPECT_EQ(modeler.MakePredictionSnapshot().status().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(StrokeModelerTest, PredictionSnapshotIsUnaffectedByLaterUpdates) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {3, 4},
+                           .time = Time(0),
+                           .pressure = .2,
+                           .tilt = .3,
+                           .orientation = .4},
+                          results)
+                  .ok());
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {3.5, 4.2},
+                           .time = Time(.02),
+                           .pressure = .4,
+                           .tilt = .5,
+                           .orientation = .6},
+                          results)
+                  .ok());
+
+  std::vector<Result> expected;
+  ASSERT_TRUE(modeler.Predict(expected).ok());
+  ASSERT_THAT(expected, Not(IsEmpty()));
+  std::vector<Result> expected_with_horizon;
+  ASSERT_TRUE(
+      modeler.Predict(Duration(.02), Duration(.01), expected_with_horizon)
+          .ok());
+  absl::StatusOr<Result> expected_at = modeler.PredictAt(Time(.03));
+  ASSERT_TRUE(expected_at.ok());
+
+  absl::StatusOr<std::shared_ptr<const PredictionSnapshot>> snapshot =
+      modeler.MakePredictionSnapshot();
+  ASSERT_TRUE(snapshot.ok());
+  EXPECT_EQ((*snapshot)->LastInputTime(), Time(.02));
+
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {4, 3},
+                           .time = Time(.04),
+                           .pressure = .6,
+                           .tilt = .7,
+                           .orientation = .8},
+                          results)
+                  .ok());
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kUp,
+                           .position = {4.5, 2},
+                           .time = Time(.06)},
+                          results)
+                  .ok());
+
+  PredictionScratch scratch;
+  (*snapshot)->Predict(results, scratch);
+  EXPECT_EQ(results, expected);
+  ASSERT_TRUE((*snapshot)
+                  ->Predict(Duration(.02), Duration(.01), results, scratch)
+                  .ok());
+  EXPECT_EQ(results, expected_with_horizon);
+  EXPECT_EQ((*snapshot)->PredictAt(Time(.03)), *expected_at);
+
+  EXPECT_EQ(
+      (*snapshot)->Predict(Duration(.02), Duration(0), results, scratch).code(),
+      absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results, IsEmpty());
+}
+
+// Updates the modeler on one thread while predicting from the published
+// snapshots on another. This is mainly useful when run under a thread
+// sanitizer.
+TEST(StrokeModelerTest, PredictFromPublishedSnapshotWhileUpdating) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  PredictionSnapshotPublisher publisher;
+  EXPECT_EQ(publisher.Latest(), nullptr);
+
+  constexpr int kNumInputs = 200;
+  std::atomic<bool> done = false;
+  std::thread render_thread([&publisher, &done]() {
+    PredictionScratch scratch;
+    std::vector<Result> prediction;
+    Time last_input_time{0};
+    while (!done.load()) {
+      std::shared_ptr<const PredictionSnapshot> snapshot = publisher.Latest();
+      if (snapshot == nullptr) continue;
+      // Snapshots are published in order, so the input time never decreases.
+      EXPECT_GE(snapshot->LastInputTime(), last_input_time);
+      last_input_time = snapshot->LastInputTime();
+      snapshot->Predict(prediction, scratch);
+    }
+  });
+
+  std::vector<Result> results;
+  for (int i = 0; i < kNumInputs; ++i) {
+    Input input{.event_type = i == 0 ? Input::EventType::kDown
+                                     : Input::EventType::kMove,
+                .position = {std::cos(i * .1f), std::sin(i * .1f)},
+                .time = Time(i * .005)};
+    ASSERT_TRUE(modeler.Update(input, results).ok());
+    absl::StatusOr<std::shared_ptr<const PredictionSnapshot>> snapshot =
+        modeler.MakePredictionSnapshot();
+    ASSERT_TRUE(snapshot.ok());
+    publisher.Publish(*std::move(snapshot));
+  }
+  done = true;
+  render_thread.join();
+
+  std::shared_ptr<const PredictionSnapshot> latest = publisher.Latest();
+  ASSERT_NE(latest, nullptr);
+  EXPECT_EQ(latest->LastInputTime(), Time((kNumInputs - 1) * .005));
+  publisher.Publish(nullptr);
+  EXPECT_EQ(publisher.Latest(), nullptr);
+}
+
 TEST(StrokeModelerTest, InputRateSlowerThanMinOutputRate) {
   const Duration kDeltaTime{1. / 30};
 
@@ -2668,6 +2937,274 @@ TEST(StrokeModelerTest, ResetKeepsParamsAndResetsStroke) {
   ASSERT_TRUE(modeler.Update(pointer_down, results).ok());
 }
 
+TEST(StrokeModelerTest, CompiledParamsRejectInvalidParams) {
+  EXPECT_EQ(
+      CompiledStrokeModelParams::Create(StrokeModelParams()).status().code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+TEST(StrokeModelerTest, ModelersSharingCompiledParamsMatchReset) {
+  absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>> params =
+      CompiledStrokeModelParams::Create(kDefaultParams);
+  ASSERT_TRUE(params.ok());
+  EXPECT_EQ((*params)->MinOutputInterval(),
+            Duration(1. / kDefaultParams.sampling_params.min_output_rate));
+
+  StrokeModeler expected_modeler;
+  ASSERT_TRUE(expected_modeler.Reset(kDefaultParams).ok());
+  StrokeModeler modeler1;
+  StrokeModeler modeler2;
+  modeler1.Reset(*params);
+  modeler2.Reset(*params);
+
+  std::vector<Result> expected;
+  std::vector<Result> results1;
+  std::vector<Result> results2;
+  for (int i = 0; i < 20; ++i) {
+    Input input{.event_type = i == 0    ? Input::EventType::kDown
+                              : i == 19 ? Input::EventType::kUp
+                                        : Input::EventType::kMove,
+                .position = {std::cos(i * .3f), std::sin(i * .3f)},
+                .time = Time(i * .01)};
+    ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+    ASSERT_TRUE(modeler1.Update(input, results1).ok());
+    ASSERT_TRUE(modeler2.Update(input, results2).ok());
+    EXPECT_EQ(results1, expected);
+    EXPECT_EQ(results2, expected);
+    // Each modeler has its own copy of the predictor, so the first modeler's
+    // inputs don't affect the second modeler's prediction.
+    if (i < 19) {
+      std::vector<Result> expected_prediction;
+      std::vector<Result> prediction;
+      ASSERT_TRUE(expected_modeler.Predict(expected_prediction).ok());
+      ASSERT_TRUE(modeler2.Predict(prediction).ok());
+      EXPECT_EQ(prediction, expected_prediction);
+    }
+  }
+
+  // Reset() without parameters keeps the compiled parameters.
+  ASSERT_TRUE(modeler1.Reset().ok());
+  results1.clear();
+  ASSERT_TRUE(modeler1
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {1, 0},
+                           .time = Time(0)},
+                          results1)
+                  .ok());
+  EXPECT_EQ(results1.front(), expected.front());
+}
+
+TEST(StrokeModelerTest, ExactIntegratorDoesNotDependOnOutputRate) {
+  StrokeModelParams sparse_params = kDefaultParams;
+  sparse_params.position_modeler_params.integrator =
+      PositionModelerParams::Integrator::kExact;
+  sparse_params.sampling_params.min_output_rate = 60;
+  StrokeModelParams dense_params = sparse_params;
+  dense_params.sampling_params.min_output_rate = 600;
+  StrokeModeler sparse_modeler;
+  StrokeModeler dense_modeler;
+  ASSERT_TRUE(sparse_modeler.Reset(sparse_params).ok());
+  ASSERT_TRUE(dense_modeler.Reset(dense_params).ok());
+
+  std::vector<Result> sparse_results;
+  std::vector<Result> dense_results;
+  for (int i = 0; i < 19; ++i) {
+    Input input{.event_type = i == 0 ? Input::EventType::kDown
+                                     : Input::EventType::kMove,
+                .position = {std::cos(i * .3f), std::sin(i * .3f)},
+                .time = Time(i * .01)};
+    sparse_results.clear();
+    dense_results.clear();
+    ASSERT_TRUE(sparse_modeler.Update(input, sparse_results).ok());
+    ASSERT_TRUE(dense_modeler.Update(input, dense_results).ok());
+    ASSERT_FALSE(sparse_results.empty());
+    if (i > 0) {
+      EXPECT_GT(dense_results.size(), sparse_results.size());
+    }
+    EXPECT_THAT(sparse_results.back().position,
+                Vec2Near(dense_results.back().position, kTol));
+    EXPECT_THAT(sparse_results.back().velocity,
+                Vec2Near(dense_results.back().velocity, kAccelTol));
+  }
+}
+
+// A stroke with a long pause in the middle, so that the input after the pause
+// is upsampled to many Results.
+std::vector<Input> MakeStrokeWithPause() {
+  std::vector<Input> inputs;
+  for (int i = 0; i < 10; ++i) {
+    double time = i < 5 ? i * .01 : .5 + i * .01;
+    inputs.push_back({.event_type = i == 0   ? Input::EventType::kDown
+                                    : i == 9 ? Input::EventType::kUp
+                                             : Input::EventType::kMove,
+                      .position = {std::cos(i * .3f), std::sin(i * .3f)},
+                      .time = Time(time),
+                      .pressure = .1f * i});
+  }
+  return inputs;
+}
+
+TEST(StrokeModelerTest, BudgetedUpdateMatchesUnbudgeted) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Result> expected;
+  for (const Input &input : MakeStrokeWithPause()) {
+    ASSERT_TRUE(modeler.Update(input, expected).ok());
+  }
+
+  constexpr int kMaxResults = 7;
+  std::vector<Result> results;
+  for (const Input &input : MakeStrokeWithPause()) {
+    std::vector<Result> call_results;
+    ASSERT_TRUE(
+        modeler.Update(input, call_results, {.max_results = kMaxResults})
+            .ok());
+    EXPECT_LE(call_results.size(), kMaxResults);
+    results.insert(results.end(), call_results.begin(), call_results.end());
+  }
+  EXPECT_TRUE(modeler.HasPendingWork());
+  // The work left over is drained a little at a time.
+  while (modeler.HasPendingWork()) {
+    std::vector<Result> call_results;
+    ASSERT_TRUE(modeler.Drain(call_results, {.max_results = kMaxResults}).ok());
+    EXPECT_THAT(call_results, Not(IsEmpty()));
+    EXPECT_LE(call_results.size(), kMaxResults);
+    results.insert(results.end(), call_results.begin(), call_results.end());
+  }
+  EXPECT_EQ(results, expected);
+
+  // The stroke has ended, so the modeler is ready for the next one.
+  EXPECT_EQ(modeler.Predict(results).code(),
+            absl::StatusCode::kFailedPrecondition);
+  results.clear();
+  EXPECT_TRUE(modeler.Update(MakeStrokeWithPause().front(), results).ok());
+}
+
+TEST(StrokeModelerTest, DrainWithTimeBudgetMakesProgress) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Result> expected;
+  for (const Input &input : MakeStrokeWithPause()) {
+    ASSERT_TRUE(modeler.Update(input, expected).ok());
+  }
+
+  std::vector<Result> results;
+  for (const Input &input : MakeStrokeWithPause()) {
+    ASSERT_TRUE(
+        modeler.Update(input, results, {.max_time = absl::Nanoseconds(1)})
+            .ok());
+  }
+  int n_calls = 0;
+  while (modeler.HasPendingWork()) {
+    ASSERT_TRUE(
+        modeler.Drain(results, {.max_time = absl::Nanoseconds(1)}).ok());
+    ASSERT_LT(++n_calls, 1000);
+  }
+  EXPECT_EQ(results, expected);
+}
+
+TEST(StrokeModelerTest, BudgetedUpdateValidatesAgainstPendingInputs) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Input> inputs = MakeStrokeWithPause();
+  std::vector<Result> results;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(modeler.Update(inputs[i], results, {.max_results = 1}).ok());
+  }
+  ASSERT_TRUE(modeler.HasPendingWork());
+
+  results.clear();
+  EXPECT_EQ(modeler.Update(inputs[5], results, {.max_results = 1}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(modeler.Update(inputs[4], results, {.max_results = 1}).code(),
+            absl::StatusCode::kInvalidArgument);
+  Input down_during_stroke = inputs[6];
+  down_during_stroke.event_type = Input::EventType::kDown;
+  EXPECT_EQ(
+      modeler.Update(down_during_stroke, results, {.max_results = 1}).code(),
+      absl::StatusCode::kFailedPrecondition);
+  EXPECT_THAT(results, IsEmpty());
+
+  ASSERT_TRUE(modeler.Update(inputs[9], results, {.max_results = 1}).ok());
+  Input move_after_up = inputs[9];
+  move_after_up.event_type = Input::EventType::kMove;
+  move_after_up.time += Duration(1);
+  EXPECT_EQ(modeler.Update(move_after_up, results, {.max_results = 1}).code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  EXPECT_EQ(modeler.Update(inputs[0], results, {.max_results = 0}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(modeler.Drain(results, {.max_time = absl::ZeroDuration()}).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(StrokeModelerTest, BudgetedUpdateModelsGapsBeyondMaxOutputsPerCall) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Result> expected;
+  for (const Input &input : MakeStrokeWithPause()) {
+    ASSERT_TRUE(modeler.Update(input, expected).ok());
+  }
+
+  // The pause calls for more Results than this, so unbudgeted calls reject
+  // the input after it.
+  StrokeModelParams params = kDefaultParams;
+  params.sampling_params.max_outputs_per_call = 50;
+  ASSERT_TRUE(modeler.Reset(params).ok());
+  std::vector<Input> inputs = MakeStrokeWithPause();
+  std::vector<Result> results;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(modeler.Update(inputs[i], results).ok());
+  }
+  EXPECT_EQ(modeler.Update(inputs[5], results).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // Budgeted calls model it a little at a time, and Drain() finishes it.
+  constexpr int kMaxResults = 7;
+  ASSERT_TRUE(modeler.Reset(params).ok());
+  results.clear();
+  for (const Input &input : inputs) {
+    std::vector<Result> call_results;
+    ASSERT_TRUE(
+        modeler.Update(input, call_results, {.max_results = kMaxResults})
+            .ok());
+    EXPECT_LE(call_results.size(), kMaxResults);
+    results.insert(results.end(), call_results.begin(), call_results.end());
+  }
+  ASSERT_TRUE(modeler.HasPendingWork());
+  ASSERT_TRUE(modeler.Drain(results).ok());
+  EXPECT_FALSE(modeler.HasPendingWork());
+  ASSERT_EQ(results.size(), expected.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_THAT(results[i], ResultNear(expected[i], kTol, kAccelTol));
+  }
+}
+
+TEST(StrokeModelerTest, BudgetedUpdateReportsDeferredErrors) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Input> inputs = MakeStrokeWithPause();
+  std::vector<Result> results;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(modeler.Update(inputs[i], results, {.max_results = 1}).ok());
+  }
+  // An input after an absurdly long gap, as from a clock jump, would need too
+  // many Results even for budgeted calls, but it isn't modeled until the
+  // pending work ahead of it is done.
+  ASSERT_TRUE(modeler.HasPendingWork());
+  Input input_after_gap = inputs[5];
+  input_after_gap.time = inputs[4].time + Duration(1e5);
+  ASSERT_TRUE(
+      modeler.Update(input_after_gap, results, {.max_results = 1}).ok());
+  EXPECT_EQ(modeler.Drain(results).code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_FALSE(modeler.HasPendingWork());
+
+  // The stroke continues without it.
+  Input next_input = inputs[6];
+  next_input.time = inputs[4].time + Duration(.01);
+  EXPECT_TRUE(modeler.Update(next_input, results, {.max_results = 1}).ok());
+}
+
 TEST(StrokeModelerTest, SaveAndRestore) {
   StrokeModeler modeler;
   ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
@@ -2966,6 +3503,564 @@ TEST(StrokeModelerTest, UpdateUpdateIdenticalToUpdatePredictUpdate) {
   EXPECT_EQ(results_with_predict, results_without_predict);
 }
 
+TEST(StrokeModelerTest, SyntheticStrokesModelWithoutErrors) {
+  StrokeModelParams params = kDefaultParams;
+  params.prediction_params = KalmanPredictorParams{
+      .process_noise = .00026458,
+      .measurement_noise = .026458,
+      .min_catchup_velocity = .01,
+      .prediction_interval = Duration(1. / 60),
+      .confidence_params{.max_estimation_distance = .04,
+                         .min_travel_speed = 3,
+                         .max_travel_speed = 15,
+                         .max_linear_deviation = .2}};
+  StrokeModeler modeler;
+  for (SyntheticStrokeShape shape :
+       {SyntheticStrokeShape::kLine, SyntheticStrokeShape::kSpiral,
+        SyntheticStrokeShape::kLissajous, SyntheticStrokeShape::kSignature}) {
+    ASSERT_TRUE(modeler.Reset(params).ok());
+    // A noisy, jittery digitizer that coalesces some of its inputs.
+    std::vector<Input> inputs = GenerateSyntheticStroke(
+        {.shape = shape,
+         .input_rate = 120,
+         .timestamp_jitter = .2,
+         .coalesce_probability = .1,
+         .position_noise = .002,
+         .quantization = .001,
+         .pressure_profile = SyntheticPressureProfile::kTaper,
+         .tilt_profile = SyntheticTiltProfile::kVarying,
+         .seed = static_cast<uint32_t>(shape)});
+    std::vector<Result> results;
+    std::vector<Result> prediction;
+    for (const Input &input : inputs) {
+      ASSERT_TRUE(modeler.Update(input, results).ok());
+      if (input.event_type != Input::EventType::kUp) {
+        ASSERT_TRUE(modeler.Predict(prediction).ok());
+      }
+    }
+    ASSERT_THAT(results, Not(IsEmpty()));
+    for (const Result &result : results) {
+      EXPECT_TRUE(std::isfinite(result.position.x));
+      EXPECT_TRUE(std::isfinite(result.position.y));
+    }
+    // The stroke ends near the last input.
+    EXPECT_THAT(results.back().position, Vec2Near(inputs.back().position, .1));
+  }
+}
+
+TEST(StrokeModelerTest, LatencyHistogramsAreDisabledByDefault) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  EXPECT_EQ(modeler.LatencyHistograms(), nullptr);
+  // This does nothing, but is allowed.
+  modeler.ResetLatencyHistograms();
+}
+
+TEST(StrokeModelerTest, LatencyHistogramsCountCalls) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  modeler.EnableLatencyHistograms();
+  const StrokeModelerLatencyHistograms *histograms =
+      modeler.LatencyHistograms();
+  ASSERT_NE(histograms, nullptr);
+
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {0, 0},
+                           .time = Time(0)},
+                          results)
+                  .ok());
+  modeler.Save();
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {1, 0},
+                           .time = Time(.02)},
+                          results, UpdateBudget{.max_results = 1})
+                  .ok());
+  ASSERT_TRUE(modeler.Drain(results).ok());
+  ASSERT_TRUE(modeler.Predict(results).ok());
+  ASSERT_TRUE(modeler.PredictAt(Time(.03)).ok());
+  modeler.Restore();
+  // Failed calls are counted too.
+  EXPECT_FALSE(modeler
+                   .Update({.event_type = Input::EventType::kDown,
+                            .position = {0, 0},
+                            .time = Time(0)},
+                           results)
+                   .ok());
+
+  EXPECT_EQ(histograms->update.Count(), 3);
+  EXPECT_EQ(histograms->drain.Count(), 1);
+  EXPECT_EQ(histograms->predict.Count(), 2);
+  EXPECT_EQ(histograms->save.Count(), 1);
+  EXPECT_EQ(histograms->restore.Count(), 1);
+
+  // Re-enabling doesn't clear the histograms, and neither does Reset().
+  modeler.EnableLatencyHistograms();
+  ASSERT_TRUE(modeler.Reset().ok());
+  ASSERT_EQ(modeler.LatencyHistograms(), histograms);
+  EXPECT_EQ(histograms->update.Count(), 3);
+
+  StrokeModelerLatencyHistograms merged;
+  merged.Merge(*histograms);
+  merged.Merge(*histograms);
+  EXPECT_EQ(merged.update.Count(), 6);
+  EXPECT_EQ(merged.drain.Count(), 2);
+  EXPECT_EQ(merged.predict.Count(), 4);
+  EXPECT_EQ(merged.save.Count(), 2);
+  EXPECT_EQ(merged.restore.Count(), 2);
+
+  modeler.ResetLatencyHistograms();
+  EXPECT_EQ(histograms->update.Count(), 0);
+  EXPECT_EQ(histograms->drain.Count(), 0);
+  EXPECT_EQ(histograms->predict.Count(), 0);
+  EXPECT_EQ(histograms->save.Count(), 0);
+  EXPECT_EQ(histograms->restore.Count(), 0);
+}
+
+TEST(StrokeModelerTest, CompactedModelerMatchesUncompacted) {
+  StrokeModelParams kalman_params = kDefaultParams;
+  kalman_params.prediction_params = KalmanPredictorParams{
+      .process_noise = .00026458,
+      .measurement_noise = .026458,
+      .min_catchup_velocity = .01,
+      .prediction_interval = Duration(1. / 60),
+      .confidence_params{.max_estimation_distance = .04,
+                         .min_travel_speed = 3,
+                         .max_travel_speed = 15,
+                         .max_linear_deviation = .2}};
+  StrokeModelParams warm_start_params = kalman_params;
+  std::get<KalmanPredictorParams>(warm_start_params.prediction_params)
+      .carry_over_error_covariance = true;
+
+  for (const StrokeModelParams &params :
+       {kDefaultParams, kalman_params, warm_start_params}) {
+    StrokeModeler expected_modeler;
+    StrokeModeler modeler;
+    ASSERT_TRUE(expected_modeler.Reset(params).ok());
+    ASSERT_TRUE(modeler.Reset(params).ok());
+    // Compacting a modeler that hasn't modeled anything is allowed.
+    ASSERT_TRUE(modeler.Compact().ok());
+
+    for (SyntheticStrokeShape shape :
+         {SyntheticStrokeShape::kSpiral, SyntheticStrokeShape::kSignature}) {
+      std::vector<Input> inputs = GenerateSyntheticStroke(
+          {.shape = shape,
+           .input_rate = 120,
+           .pressure_profile = SyntheticPressureProfile::kTaper,
+           .tilt_profile = SyntheticTiltProfile::kVarying});
+      std::vector<Result> expected;
+      std::vector<Result> results;
+      for (const Input &input : inputs) {
+        ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+        ASSERT_TRUE(modeler.Update(input, results).ok());
+        ASSERT_EQ(results, expected);
+        if (input.event_type != Input::EventType::kUp) {
+          std::vector<Result> expected_prediction;
+          std::vector<Result> prediction;
+          ASSERT_TRUE(expected_modeler.Predict(expected_prediction).ok());
+          ASSERT_TRUE(modeler.Predict(prediction).ok());
+          ASSERT_EQ(prediction, expected_prediction);
+        }
+      }
+      ASSERT_TRUE(modeler.Compact().ok());
+    }
+  }
+}
+
+TEST(StrokeModelerTest, CompactFailsWhileStrokeIsInProgress) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Input> inputs = MakeStrokeWithPause();
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler.Update(inputs.front(), results).ok());
+  EXPECT_EQ(modeler.Compact().code(), absl::StatusCode::kFailedPrecondition);
+
+  // The up event has been accepted, but not yet modeled.
+  for (int i = 1; i < static_cast<int>(inputs.size()); ++i) {
+    ASSERT_TRUE(modeler.Update(inputs[i], results, {.max_results = 1}).ok());
+  }
+  ASSERT_TRUE(modeler.HasPendingWork());
+  EXPECT_EQ(modeler.Compact().code(), absl::StatusCode::kFailedPrecondition);
+
+  ASSERT_TRUE(modeler.Drain(results).ok());
+  EXPECT_TRUE(modeler.Compact().ok());
+}
+
+TEST(StrokeModelerTest, CompactDiscardsSavedState) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Input> inputs = MakeStrokeWithPause();
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler.Update(inputs[0], results).ok());
+  ASSERT_TRUE(modeler.Update(inputs[1], results).ok());
+  modeler.Save();
+  for (int i = 2; i < static_cast<int>(inputs.size()); ++i) {
+    ASSERT_TRUE(modeler.Update(inputs[i], results).ok());
+  }
+  ASSERT_TRUE(modeler.Compact().ok());
+
+  // Without the call to Compact(), this would restore the stroke in progress.
+  modeler.Restore();
+  EXPECT_EQ(modeler.Predict(results).code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_EQ(modeler.Update(inputs[2], results).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(StrokeModelerTest, StrokeRelativeTimeMatchesZeroBasedStroke) {
+  StrokeModelParams params = kDefaultParams;
+  params.sampling_params.use_stroke_relative_time = true;
+  // Timestamps like these, in seconds since the Unix epoch, leave little
+  // precision for the intervals between inputs.
+  const Duration offset(1.7e9);
+  StrokeModeler expected_modeler;
+  StrokeModeler modeler;
+  ASSERT_TRUE(expected_modeler.Reset(kDefaultParams).ok());
+  ASSERT_TRUE(modeler.Reset(params).ok());
+
+  for (SyntheticStrokeShape shape :
+       {SyntheticStrokeShape::kSpiral, SyntheticStrokeShape::kSignature}) {
+    std::vector<Input> inputs = GenerateSyntheticStroke(
+        {.shape = shape,
+         .input_rate = 120,
+         .pressure_profile = SyntheticPressureProfile::kTaper});
+    std::vector<Result> expected;
+    std::vector<Result> results;
+    for (Input input : inputs) {
+      Input offset_input = input;
+      offset_input.time += offset;
+      // The offset timestamps are rounded, so compare against a zero-based
+      // stroke with the same rounding.
+      input.time = offset_input.time - offset;
+      expected.clear();
+      results.clear();
+      ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+      ASSERT_TRUE(modeler.Update(offset_input, results).ok());
+      ASSERT_EQ(results.size(), expected.size());
+      for (int i = 0; i < static_cast<int>(results.size()); ++i) {
+        expected[i].time += offset;
+        EXPECT_THAT(results[i], ResultNear(expected[i], kTol, kAccelTol));
+      }
+      if (input.event_type == Input::EventType::kUp) continue;
+
+      ASSERT_TRUE(expected_modeler.Predict(expected).ok());
+      ASSERT_TRUE(modeler.Predict(results).ok());
+      ASSERT_EQ(results.size(), expected.size());
+      for (int i = 0; i < static_cast<int>(results.size()); ++i) {
+        expected[i].time += offset;
+        EXPECT_THAT(results[i], ResultNear(expected[i], kTol, kAccelTol));
+      }
+
+      Time time = input.time + Duration(.01);
+      absl::StatusOr<Result> expected_result = expected_modeler.PredictAt(time);
+      absl::StatusOr<Result> result = modeler.PredictAt(time + offset);
+      ASSERT_TRUE(expected_result.ok());
+      ASSERT_TRUE(result.ok());
+      expected_result->time += offset;
+      EXPECT_THAT(*result, ResultNear(*expected_result, kTol, kAccelTol));
+    }
+  }
+}
+
+TEST(StrokeModelerTest, UpdateWithDigitizerSamplesMatchesInputs) {
+  const DigitizerTransform transform{
+      .position_scale = {.001, .001},
+      .position_offset = {-1, 2},
+      .timestamp_origin_ns = 1'700'000'000'000'000'000};
+  std::vector<DigitizerSample> samples;
+  std::vector<Input> inputs;
+  // More samples than are converted at a time.
+  for (int i = 0; i <= 200; ++i) {
+    DigitizerSample sample{
+        .event_type = i == 0     ? Input::EventType::kDown
+                      : i == 200 ? Input::EventType::kUp
+                                 : Input::EventType::kMove,
+        .x = 1000 + 3 * i,
+        .y = 2000 - i * i / 20,
+        .pressure = .5,
+        .timestamp_ns = transform.timestamp_origin_ns + i * 4'000'000};
+    samples.push_back(sample);
+    inputs.push_back(transform.ToInput(sample));
+  }
+
+  StrokeModeler expected_modeler;
+  StrokeModeler modeler;
+  ASSERT_TRUE(expected_modeler.Reset(kDefaultParams).ok());
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<Result> expected;
+  for (const Input &input : inputs) {
+    ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+  }
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler.Update(samples, transform, results).ok());
+  EXPECT_EQ(results, expected);
+}
+
+TEST(StrokeModelerTest, UpdateWithDigitizerSamplesStopsAtRejectedSample) {
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  std::vector<DigitizerSample> samples = {
+      {.event_type = Input::EventType::kDown, .timestamp_ns = 0},
+      {.event_type = Input::EventType::kMove,
+       .x = 1,
+       .timestamp_ns = 5'000'000},
+      // This goes backwards in time.
+      {.event_type = Input::EventType::kMove, .x = 2, .timestamp_ns = 0},
+      {.event_type = Input::EventType::kMove,
+       .x = 3,
+       .timestamp_ns = 9'000'000},
+  };
+  std::vector<Result> results;
+  const DigitizerTransform invalid_transform{
+      .position_scale = {std::numeric_limits<float>::quiet_NaN(), 1}};
+  EXPECT_EQ(modeler.Update(samples, invalid_transform, results).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results, IsEmpty());
+
+  EXPECT_EQ(modeler.Update(samples, DigitizerTransform(), results).code(),
+            absl::StatusCode::kInvalidArgument);
+  ASSERT_THAT(results, Not(IsEmpty()));
+  EXPECT_THAT(results.back().time, TimeNear(Time(.005), 1e-6));
+
+  // The samples after the rejected one weren't modeled.
+  results.clear();
+  ASSERT_TRUE(modeler
+                  .Update(absl::MakeConstSpan(samples).subspan(3),
+                          DigitizerTransform(), results)
+                  .ok());
+  ASSERT_THAT(results, Not(IsEmpty()));
+  EXPECT_THAT(results.back().time, TimeNear(Time(.009), 1e-6));
+}
+
+TEST(StrokeModelerTest, InputCoalescingSkipsRedundantInputs) {
+  StrokeModelParams params = kDefaultParams;
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .position_tolerance = .01,
+                                    .pressure_tolerance = .05,
+                                    .max_skipped_duration = Duration(.01)};
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(params).ok());
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {1, 1},
+                           .time = Time(0),
+                           .pressure = .5},
+                          results)
+                  .ok());
+
+  // This is within the tolerances of the down event, so it's skipped.
+  results.clear();
+  const Input skipped{.event_type = Input::EventType::kMove,
+                      .position = {1.005, 1},
+                      .time = Time(.004),
+                      .pressure = .52};
+  ASSERT_TRUE(modeler.Update(skipped, results).ok());
+  EXPECT_THAT(results, IsEmpty());
+
+  // Later inputs are checked against the skipped input.
+  EXPECT_EQ(modeler.Update(skipped, results).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(modeler
+                .Update({.event_type = Input::EventType::kMove,
+                         .position = {1, 1},
+                         .time = Time(.002),
+                         .pressure = .5},
+                        results)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // The pressure has changed by more than the tolerance.
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {1, 1},
+                           .time = Time(.006),
+                           .pressure = .6},
+                          results)
+                  .ok());
+  EXPECT_THAT(results, Not(IsEmpty()));
+
+  // This is within the tolerances, but too long after the last modeled input.
+  results.clear();
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {1, 1},
+                           .time = Time(.02),
+                           .pressure = .6},
+                          results)
+                  .ok());
+  EXPECT_THAT(results, Not(IsEmpty()));
+
+  // Up events are never skipped.
+  results.clear();
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kUp,
+                           .position = {1, 1},
+                           .time = Time(.021),
+                           .pressure = .6},
+                          results)
+                  .ok());
+  EXPECT_THAT(results, Not(IsEmpty()));
+}
+
+TEST(StrokeModelerTest, InputCoalescingSkipsNothingWithZeroTolerances) {
+  StrokeModelParams params = kDefaultParams;
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .max_skipped_duration = Duration(1)};
+  StrokeModeler expected_modeler;
+  StrokeModeler modeler;
+  ASSERT_TRUE(expected_modeler.Reset(kDefaultParams).ok());
+  ASSERT_TRUE(modeler.Reset(params).ok());
+  std::vector<Input> inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .input_rate = 240,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+  std::vector<Result> expected;
+  std::vector<Result> results;
+  for (const Input &input : inputs) {
+    ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+    ASSERT_TRUE(modeler.Update(input, results).ok());
+  }
+  EXPECT_EQ(results, expected);
+}
+
+TEST(StrokeModelerTest, InputCoalescingWithBudgetMatchesUnbudgeted) {
+  StrokeModelParams params = kDefaultParams;
+  params.input_coalescing_params = {.is_enabled = true,
+                                    .position_tolerance = .05,
+                                    .pressure_tolerance = .05,
+                                    .tilt_tolerance = .05,
+                                    .orientation_tolerance = .05,
+                                    .max_skipped_duration = Duration(.02)};
+  StrokeModeler expected_modeler;
+  StrokeModeler modeler;
+  ASSERT_TRUE(expected_modeler.Reset(params).ok());
+  ASSERT_TRUE(modeler.Reset(params).ok());
+  std::vector<Input> inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSpiral,
+       .input_rate = 1000,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+  std::vector<Result> expected;
+  std::vector<Result> results;
+  int n_skipped = 0;
+  for (const Input &input : inputs) {
+    size_t n_results = expected.size();
+    ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+    if (expected.size() == n_results) ++n_skipped;
+    ASSERT_TRUE(modeler.Update(input, results, {.max_results = 1}).ok());
+  }
+  ASSERT_TRUE(modeler.Drain(results).ok());
+  EXPECT_GT(n_skipped, 0);
+  EXPECT_EQ(results, expected);
+}
+
+// Models each step of `inputs` on `modeler` with ModelHypothetical(), and on
+// `expected_modeler` with Save(), Update() and Restore(), and checks that the
+// Results, and those of the real updates and predictions, are the same.
+void ExpectHypotheticalMatchesSaveAndRestore(
+    const std::vector<Input> &inputs, const UpdateBudget &budget,
+    StrokeModeler &modeler, StrokeModeler &expected_modeler) {
+  constexpr int kHypotheticalInputs = 4;
+  std::vector<Result> expected;
+  std::vector<Result> results;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    results.clear();
+    expected.clear();
+    ASSERT_TRUE(modeler.Update(inputs[i], results, budget).ok());
+    ASSERT_TRUE(expected_modeler.Update(inputs[i], expected, budget).ok());
+    EXPECT_EQ(results, expected);
+    if (inputs[i].event_type == Input::EventType::kUp) continue;
+
+    absl::Span<const Input> hypothetical =
+        absl::MakeConstSpan(inputs).subspan(i + 1, kHypotheticalInputs);
+    results.clear();
+    expected.clear();
+    ASSERT_TRUE(modeler.ModelHypothetical(hypothetical, results).ok());
+    expected_modeler.Save();
+    ASSERT_TRUE(expected_modeler.Drain(expected).ok());
+    for (const Input &input : hypothetical) {
+      ASSERT_TRUE(expected_modeler.Update(input, expected).ok());
+    }
+    expected_modeler.Restore();
+    EXPECT_EQ(results, expected);
+
+    results.clear();
+    expected.clear();
+    ASSERT_TRUE(modeler.Predict(results).ok());
+    ASSERT_TRUE(expected_modeler.Predict(expected).ok());
+    EXPECT_EQ(results, expected);
+  }
+}
+
+TEST(StrokeModelerTest, ModelHypotheticalMatchesSaveAndRestore) {
+  StrokeModeler modeler;
+  StrokeModeler expected_modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  ASSERT_TRUE(expected_modeler.Reset(kDefaultParams).ok());
+  std::vector<Input> inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSpiral,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+  // The state saved by Save() isn't affected by ModelHypothetical().
+  modeler.Save();
+  ExpectHypotheticalMatchesSaveAndRestore(inputs, UpdateBudget(), modeler,
+                                          expected_modeler);
+  // Restoring brings back the state from before the stroke.
+  modeler.Restore();
+  std::vector<Result> results;
+  EXPECT_EQ(modeler.ModelHypothetical({}, results).code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_TRUE(modeler.Update(inputs[0], results).ok());
+}
+
+TEST(StrokeModelerTest, ModelHypotheticalIncludesPendingWork) {
+  StrokeModeler modeler;
+  StrokeModeler expected_modeler;
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  ASSERT_TRUE(expected_modeler.Reset(kDefaultParams).ok());
+  std::vector<Input> inputs =
+      GenerateSyntheticStroke({.shape = SyntheticStrokeShape::kLissajous});
+  ExpectHypotheticalMatchesSaveAndRestore(inputs, {.max_results = 1}, modeler,
+                                          expected_modeler);
+}
+
+TEST(StrokeModelerTest, ModelHypotheticalErrors) {
+  StrokeModeler modeler;
+  std::vector<Result> results;
+  const Input down{.event_type = Input::EventType::kDown,
+                   .position = {0, 0},
+                   .time = Time(0)};
+  const Input move{.event_type = Input::EventType::kMove,
+                   .position = {1, 0},
+                   .time = Time(.01)};
+  EXPECT_EQ(modeler.ModelHypothetical({move}, results).code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  ASSERT_TRUE(modeler.Reset(kDefaultParams).ok());
+  EXPECT_EQ(modeler.ModelHypothetical({move}, results).code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  ASSERT_TRUE(modeler.Update(down, results).ok());
+  results.clear();
+  EXPECT_EQ(modeler.ModelHypothetical({move, down}, results).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results, IsEmpty());
+  // Inputs are validated as by Update(), and the Results before the rejected
+  // input are kept.
+  EXPECT_EQ(modeler.ModelHypothetical({move, move}, results).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results, Not(IsEmpty()));
+
+  // None of this changed the modeler's state.
+  results.clear();
+  EXPECT_TRUE(modeler.Update(move, results).ok());
+  EXPECT_THAT(results, Not(IsEmpty()));
+}
+
 }  // namespace
 }  // namespace stroke_model
 }  // namespace ink
@@ -0,0 +1,135 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_modeling_client.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/internal/stroke_modeling_protocol.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/types.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace ink {
+namespace stroke_model {
+
+absl::StatusOr<std::unique_ptr<StrokeModelingClient>>
+StrokeModelingClient::Connect(absl::string_view socket_path) {
+  if (absl::Status status = ValidateSocketPath(socket_path); !status.ok()) {
+    return status;
+  }
+
+#ifdef __linux__
+  auto client = absl::WrapUnique(new StrokeModelingClient());
+  client->socket_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (client->socket_fd_ < 0) {
+    return absl::ErrnoToStatus(errno, "socket failed");
+  }
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+  if (connect(client->socket_fd_, reinterpret_cast<const sockaddr *>(&address),
+              sizeof(address)) != 0) {
+    return absl::ErrnoToStatus(
+        errno, absl::StrCat("connect to ", socket_path, " failed"));
+  }
+
+  HelloMessage hello;
+  absl::StatusOr<int> ring_fd =
+      ReceiveMessage(client->socket_fd_, &hello, sizeof(hello));
+  if (!ring_fd.ok()) return ring_fd.status();
+  if (*ring_fd == -1) {
+    return absl::InternalError("The server didn't send the ring");
+  }
+  struct stat ring_stat;
+  if (fstat(*ring_fd, &ring_stat) != 0) {
+    absl::Status status = absl::ErrnoToStatus(errno, "fstat failed");
+    close(*ring_fd);
+    return status;
+  }
+  if (hello.magic != kStrokeModelingProtocolMagic ||
+      hello.protocol_version != kStrokeModelingProtocolVersion) {
+    close(*ring_fd);
+    return absl::FailedPreconditionError(absl::Substitute(
+        "The server uses an incompatible protocol. Magic: $0, version: $1",
+        hello.magic, hello.protocol_version));
+  }
+  // The server can't make the ring any smaller after sending it, but check
+  // anyway, since mapping past its end would make reads from it crash.
+  if (ring_stat.st_size < 0 ||
+      static_cast<uint64_t>(ring_stat.st_size) < hello.ring_bytes) {
+    close(*ring_fd);
+    return absl::InternalError(
+        absl::Substitute("The ring has $0 bytes, but the server claimed $1",
+                         ring_stat.st_size, hello.ring_bytes));
+  }
+  void *ring_memory =
+      mmap(nullptr, hello.ring_bytes, PROT_READ, MAP_SHARED, *ring_fd, 0);
+  int ring_errno = errno;
+  // Only the mapping is needed once it has been created.
+  close(*ring_fd);
+  if (ring_memory == MAP_FAILED) {
+    return absl::ErrnoToStatus(ring_errno, "mmap failed");
+  }
+  client->ring_memory_ = ring_memory;
+  client->ring_bytes_ = hello.ring_bytes;
+
+  absl::StatusOr<ResultBroadcastReader> reader = ResultBroadcastReader::Attach(
+      absl::MakeConstSpan(static_cast<const std::byte *>(ring_memory),
+                          client->ring_bytes_));
+  if (!reader.ok()) return reader.status();
+  client->reader_ = *std::move(reader);
+  return client;
+#else
+  return absl::UnavailableError(
+      "The stroke modeling server is only supported on Linux");
+#endif  // __linux__
+}
+
+StrokeModelingClient::~StrokeModelingClient() {
+#ifdef __linux__
+  if (ring_memory_ != nullptr) {
+    munmap(const_cast<void *>(ring_memory_), ring_bytes_);
+  }
+  if (socket_fd_ >= 0) close(socket_fd_);
+#endif  // __linux__
+}
+
+absl::Status StrokeModelingClient::SendInput(const Input &input) {
+  InputMessage message = ToInputMessage(input);
+  return SendMessage(socket_fd_, &message, sizeof(message));
+}
+
+}  // namespace stroke_model
+}  // namespace ink
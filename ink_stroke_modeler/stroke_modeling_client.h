@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_STROKE_MODELING_CLIENT_H_
+#define INK_STROKE_MODELER_STROKE_MODELING_CLIENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// A connection to a StrokeModelingServer. Inputs are sent to the server over
+// the socket, and the Results are read directly from the server's
+// ResultBroadcastRing, which the client maps read-only. Results are tagged
+// with the index of the stroke they belong to, counting the strokes that the
+// server has modeled since it was created, not just those sent by this client.
+//
+// This is only supported on Linux. A client must not be used from multiple
+// threads concurrently.
+//
+// Example usage:
+//   auto client = StrokeModelingClient::Connect("/run/user/1000/ink_strokes");
+//   (*client)->SendInput(input);
+//   ...
+//   std::vector<BroadcastResult> results;
+//   (*client)->ReadResults(results);
+class StrokeModelingClient {
+ public:
+  // Connects to the server listening at `socket_path`. Returns an error if
+  // there is no such server, or if it uses an incompatible protocol, and an
+  // UnavailableError on platforms other than Linux.
+  static absl::StatusOr<std::unique_ptr<StrokeModelingClient>> Connect(
+      absl::string_view socket_path);
+
+  StrokeModelingClient(const StrokeModelingClient &) = delete;
+  StrokeModelingClient &operator=(const StrokeModelingClient &) = delete;
+  ~StrokeModelingClient();
+
+  // Sends an input to the server to be modeled. The server only models the
+  // inputs of one client at a time, as described in StrokeModelingServer, so
+  // clients that just read Results shouldn't send any. This returns once the
+  // input has been sent, not once it has been modeled, and so doesn't report
+  // whether the server accepted the input. Returns an error if the connection
+  // has been closed.
+  absl::Status SendInput(const Input &input);
+
+  // Appends the Results that the server has published since the last call to
+  // `results`, as described in ResultBroadcastReader::Read(). The first call
+  // returns the oldest Results still in the ring, which may include Results
+  // from before this client connected.
+  void ReadResults(std::vector<BroadcastResult> &results) {
+    reader_->Read(results);
+  }
+
+  // Returns the total number of Results that this client skipped because the
+  // server overwrote them before they could be read.
+  int64_t NumDropped() const { return reader_->NumDropped(); }
+
+ private:
+  StrokeModelingClient() = default;
+
+  int socket_fd_ = -1;
+  // The server's ring, mapped read-only.
+  const void *ring_memory_ = nullptr;
+  size_t ring_bytes_ = 0;
+  std::optional<ResultBroadcastReader> reader_;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_STROKE_MODELING_CLIENT_H_
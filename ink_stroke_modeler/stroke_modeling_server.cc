@@ -0,0 +1,265 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_modeling_server.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "ink_stroke_modeler/internal/stroke_modeling_protocol.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace ink {
+namespace stroke_model {
+
+StrokeModelingServer::StrokeModelingServer(
+    std::shared_ptr<const CompiledStrokeModelParams> params)
+    : params_(std::move(params)) {
+  modeler_.Reset(params_);
+}
+
+absl::StatusOr<std::unique_ptr<StrokeModelingServer>>
+StrokeModelingServer::Create(const StrokeModelParams &model_params,
+                             const StrokeModelingServerParams &server_params) {
+  if (absl::Status status = ValidateSocketPath(server_params.socket_path);
+      !status.ok()) {
+    return status;
+  }
+  absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>> params =
+      CompiledStrokeModelParams::Create(model_params);
+  if (!params.ok()) return params.status();
+
+#ifdef __linux__
+  auto server = absl::WrapUnique(new StrokeModelingServer(*std::move(params)));
+
+  // The ring is created in an anonymous memory file, which is mapped here for
+  // writing, and passed to clients through a read-only file descriptor.
+  server->ring_bytes_ =
+      ResultBroadcastWriter::RequiredBytes(server_params.ring_capacity);
+  int ring_fd = memfd_create("ink_result_broadcast_ring", MFD_CLOEXEC);
+  if (ring_fd < 0) return absl::ErrnoToStatus(errno, "memfd_create failed");
+  if (ftruncate(ring_fd, server->ring_bytes_) != 0) {
+    absl::Status status = absl::ErrnoToStatus(errno, "ftruncate failed");
+    close(ring_fd);
+    return status;
+  }
+  void *ring_memory = mmap(nullptr, server->ring_bytes_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, ring_fd, 0);
+  server->ring_fd_ = open(absl::StrCat("/proc/self/fd/", ring_fd).c_str(),
+                          O_RDONLY | O_CLOEXEC);
+  int ring_errno = errno;
+  close(ring_fd);
+  if (ring_memory == MAP_FAILED) {
+    return absl::ErrnoToStatus(ring_errno, "mmap failed");
+  }
+  server->ring_memory_ = ring_memory;
+  if (server->ring_fd_ < 0) {
+    return absl::ErrnoToStatus(ring_errno, "Reopening the ring failed");
+  }
+  absl::StatusOr<ResultBroadcastWriter> writer = ResultBroadcastWriter::Create(
+      absl::MakeSpan(static_cast<std::byte *>(ring_memory),
+                     server->ring_bytes_),
+      server_params.ring_capacity);
+  if (!writer.ok()) return writer.status();
+  server->writer_ = std::make_unique<ResultBroadcastWriter>(*std::move(writer));
+
+  server->shutdown_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (server->shutdown_fd_ < 0) {
+    return absl::ErrnoToStatus(errno, "eventfd failed");
+  }
+
+  server->listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (server->listen_fd_ < 0) {
+    return absl::ErrnoToStatus(errno, "socket failed");
+  }
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::copy(server_params.socket_path.begin(), server_params.socket_path.end(),
+            address.sun_path);
+  if (bind(server->listen_fd_, reinterpret_cast<const sockaddr *>(&address),
+           sizeof(address)) != 0) {
+    return absl::ErrnoToStatus(
+        errno, absl::StrCat("bind to ", server_params.socket_path, " failed"));
+  }
+  server->socket_path_ = server_params.socket_path;
+  if (listen(server->listen_fd_, SOMAXCONN) != 0) {
+    return absl::ErrnoToStatus(errno, "listen failed");
+  }
+  return server;
+#else
+  return absl::UnavailableError(
+      "The stroke modeling server is only supported on Linux");
+#endif  // __linux__
+}
+
+StrokeModelingServer::~StrokeModelingServer() {
+#ifdef __linux__
+  for (int client_fd : client_fds_) close(client_fd);
+  if (listen_fd_ >= 0) close(listen_fd_);
+  if (!socket_path_.empty()) unlink(socket_path_.c_str());
+  if (shutdown_fd_ >= 0) close(shutdown_fd_);
+  // Clients keep their own mappings of the ring, so they can finish reading it.
+  if (ring_memory_ != nullptr) munmap(ring_memory_, ring_bytes_);
+  if (ring_fd_ >= 0) close(ring_fd_);
+#endif  // __linux__
+}
+
+absl::Status StrokeModelingServer::Run() {
+#ifdef __linux__
+  std::vector<pollfd> poll_fds;
+  while (true) {
+    poll_fds.clear();
+    poll_fds.push_back({.fd = shutdown_fd_, .events = POLLIN, .revents = 0});
+    poll_fds.push_back({.fd = listen_fd_, .events = POLLIN, .revents = 0});
+    for (int client_fd : client_fds_) {
+      poll_fds.push_back({.fd = client_fd, .events = POLLIN, .revents = 0});
+    }
+    if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      return absl::ErrnoToStatus(errno, "poll failed");
+    }
+
+    if (poll_fds[0].revents != 0) {
+      // Reset the eventfd, so that the next call to Run() runs until the next
+      // Shutdown().
+      uint64_t count;
+      if (read(shutdown_fd_, &count, sizeof(count)) < 0) {
+        // There's nothing to reset.
+      }
+      return absl::OkStatus();
+    }
+    if (poll_fds[1].revents != 0) AcceptClient();
+    for (size_t i = 2; i < poll_fds.size(); ++i) {
+      if (poll_fds[i].revents == 0) continue;
+      if (!HandleClientMessage(poll_fds[i].fd).ok()) {
+        CloseClient(poll_fds[i].fd);
+      }
+    }
+  }
+#else
+  return absl::UnavailableError(
+      "The stroke modeling server is only supported on Linux");
+#endif  // __linux__
+}
+
+void StrokeModelingServer::Shutdown() {
+#ifdef __linux__
+  uint64_t one = 1;
+  if (write(shutdown_fd_, &one, sizeof(one)) < 0) {
+    // The eventfd is already signaled.
+  }
+#endif  // __linux__
+}
+
+void StrokeModelingServer::AcceptClient() {
+#ifdef __linux__
+  int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+  // The client may have given up on connecting in the meantime.
+  if (client_fd < 0) return;
+  HelloMessage hello{.magic = kStrokeModelingProtocolMagic,
+                     .protocol_version = kStrokeModelingProtocolVersion,
+                     .ring_bytes = ring_bytes_};
+  if (!SendMessage(client_fd, &hello, sizeof(hello), ring_fd_).ok()) {
+    close(client_fd);
+    return;
+  }
+  client_fds_.push_back(client_fd);
+#endif  // __linux__
+}
+
+void StrokeModelingServer::CloseClient(int client_fd) {
+#ifdef __linux__
+  close(client_fd);
+#endif  // __linux__
+  client_fds_.erase(
+      std::find(client_fds_.begin(), client_fds_.end(), client_fd));
+  if (client_fd == producer_fd_) {
+    producer_fd_ = -1;
+    // The next producer's inputs mustn't continue this producer's stroke.
+    modeler_.Reset().IgnoreError();
+  }
+}
+
+absl::Status StrokeModelingServer::HandleClientMessage(int client_fd) {
+  InputMessage message;
+  absl::StatusOr<int> received_fd =
+      ReceiveMessage(client_fd, &message, sizeof(message));
+  if (!received_fd.ok()) {
+    if (received_fd.status().code() != absl::StatusCode::kInvalidArgument) {
+      return received_fd.status();
+    }
+    // The message was malformed, but the connection is still usable.
+    n_rejected_inputs_.fetch_add(1, std::memory_order_relaxed);
+    return absl::OkStatus();
+  }
+#ifdef __linux__
+  // Clients have no reason to send file descriptors.
+  if (*received_fd != -1) close(*received_fd);
+#endif  // __linux__
+
+  absl::StatusOr<Input> input = FromInputMessage(message);
+  if (!input.ok()) {
+    n_rejected_inputs_.fetch_add(1, std::memory_order_relaxed);
+    return absl::OkStatus();
+  }
+  if (producer_fd_ == -1) producer_fd_ = client_fd;
+  if (client_fd != producer_fd_) {
+    n_rejected_inputs_.fetch_add(1, std::memory_order_relaxed);
+    return absl::OkStatus();
+  }
+  ModelInput(*input);
+  return absl::OkStatus();
+}
+
+void StrokeModelingServer::ModelInput(const Input &input) {
+  const bool is_down = input.event_type == Input::EventType::kDown;
+  // Each stroke starts from a freshly reset modeler, even if the previous
+  // stroke never ended.
+  if (is_down) modeler_.Reset().IgnoreError();
+  results_.clear();
+  if (!modeler_.Update(input, results_).ok()) {
+    n_rejected_inputs_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (is_down) writer_->StartStroke();
+  writer_->Publish(results_);
+  n_modeled_inputs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace stroke_model
+}  // namespace ink
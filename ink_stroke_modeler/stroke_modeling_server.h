@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_STROKE_MODELING_SERVER_H_
+#define INK_STROKE_MODELER_STROKE_MODELING_SERVER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+struct StrokeModelingServerParams {
+  // The path of the Unix domain socket to listen on. There must not already be
+  // a file at this path; the server removes the socket when it's destroyed.
+  std::string socket_path;
+
+  // The number of Results held by the shared ResultBroadcastRing. A client
+  // that falls further behind than this drops Results, as described in
+  // ResultBroadcastReader::Read().
+  int ring_capacity = 4096;
+};
+
+// An out-of-process StrokeModeler, for when several processes consume the same
+// pen stream, so that they don't each need to run their own modeler. Clients
+// connect with StrokeModelingClient over a Unix domain socket. One client, the
+// producer, e.g. the one that owns the digitizer, sends inputs, and the server
+// models them and publishes the Results to a ResultBroadcastRing in shared
+// memory, which every client maps, and reads without any further involvement
+// of the server. Each stroke is modeled from a freshly reset StrokeModeler: a
+// down event discards any stroke in progress.
+//
+// The first client to send an input becomes the producer, and remains so until
+// it disconnects, which also discards any stroke in progress. Inputs from the
+// other clients are rejected, so that they can't interleave with or reset the
+// producer's strokes. Inputs are not acknowledged: an input that is rejected,
+// whether for this reason or because StrokeModeler::Update() rejects it, is
+// counted by NumRejectedInputs(), and otherwise ignored.
+//
+// This is only supported on Linux.
+//
+// Example usage:
+//   auto server = StrokeModelingServer::Create(
+//       model_params, {.socket_path = "/run/user/1000/ink_strokes"});
+//   std::thread server_thread([&server]() { (*server)->Run(); });
+//   ...
+//   (*server)->Shutdown();
+//   server_thread.join();
+class StrokeModelingServer {
+ public:
+  // Validates the params, creates the shared memory for the ring, and starts
+  // listening on the socket. Returns an UnavailableError on platforms other
+  // than Linux.
+  static absl::StatusOr<std::unique_ptr<StrokeModelingServer>> Create(
+      const StrokeModelParams &model_params,
+      const StrokeModelingServerParams &server_params);
+
+  StrokeModelingServer(const StrokeModelingServer &) = delete;
+  StrokeModelingServer &operator=(const StrokeModelingServer &) = delete;
+  ~StrokeModelingServer();
+
+  // Accepts clients and models their inputs until Shutdown() is called, and
+  // then returns OK. Returns an error if waiting for clients fails. Errors on
+  // a single client's connection just close it. Must not be called
+  // concurrently with itself.
+  absl::Status Run();
+
+  // Makes Run() return, or makes the next call to Run() return immediately if
+  // it isn't running. May be called from any thread.
+  void Shutdown();
+
+  // The number of inputs modeled, and the number rejected, either because the
+  // modeler rejected them, because they were malformed, or because they came
+  // from a client other than the producer. May be called from any thread.
+  int64_t NumModeledInputs() const {
+    return n_modeled_inputs_.load(std::memory_order_relaxed);
+  }
+  int64_t NumRejectedInputs() const {
+    return n_rejected_inputs_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  explicit StrokeModelingServer(
+      std::shared_ptr<const CompiledStrokeModelParams> params);
+
+  // Accepts a pending connection, and sends the client the ring.
+  void AcceptClient();
+  // Closes the connection to the client, discarding the stroke in progress if
+  // the client is the producer.
+  void CloseClient(int client_fd);
+  // Receives and models an input from the client. Returns an error if the
+  // connection should be closed.
+  absl::Status HandleClientMessage(int client_fd);
+  void ModelInput(const Input &input);
+
+  std::shared_ptr<const CompiledStrokeModelParams> params_;
+  StrokeModeler modeler_;
+  std::vector<Result> results_;
+
+  // Empty until the socket has been bound.
+  std::string socket_path_;
+  int listen_fd_ = -1;
+  // An eventfd, signaled by Shutdown().
+  int shutdown_fd_ = -1;
+  std::vector<int> client_fds_;
+  // The client whose inputs are modeled, or -1 if no client has sent an input
+  // since the last producer disconnected.
+  int producer_fd_ = -1;
+
+  // The shared memory holding the ring, opened read-only, so that clients
+  // that it's passed to can't write to it.
+  int ring_fd_ = -1;
+  void *ring_memory_ = nullptr;
+  size_t ring_bytes_ = 0;
+  std::unique_ptr<ResultBroadcastWriter> writer_;
+
+  std::atomic<int64_t> n_modeled_inputs_ = 0;
+  std::atomic<int64_t> n_rejected_inputs_ = 0;
+};
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_STROKE_MODELING_SERVER_H_
@@ -0,0 +1,178 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A loopback benchmark for StrokeModelingServer: the server runs on its own
+// thread, and clients in the same process send it strokes over the socket and
+// read the Results back from the shared ring, as separate processes would.
+// This measures the overhead of modeling out of process, which can be compared
+// against the cost of modeling the same strokes in process from
+// stroke_modeler_benchmark.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/stroke_modeling_client.h"
+#include "ink_stroke_modeler/stroke_modeling_server.h"
+#include "ink_stroke_modeler/types.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+std::string SocketPath() {
+#ifdef __linux__
+  return absl::StrCat("/tmp/ink_stroke_modeling_server_benchmark_", getpid());
+#else
+  return "";
+#endif  // __linux__
+}
+
+// Reads from the client until it has read or dropped `n_results` more Results.
+void AwaitResults(StrokeModelingClient &client, size_t n_results,
+                  std::vector<BroadcastResult> &results) {
+  const int64_t n_dropped_before = client.NumDropped();
+  size_t n_read = 0;
+  while (n_read + static_cast<size_t>(client.NumDropped() - n_dropped_before) <
+         n_results) {
+    results.clear();
+    client.ReadResults(results);
+    n_read += results.size();
+  }
+}
+
+// Sends a whole stroke from one client, and waits for it to read back all of
+// the Results, while the argument number of other clients poll the ring.
+// Inputs are sent as fast as possible, so this measures throughput rather than
+// the latency of a single input.
+void BM_ServerLoopbackStroke(benchmark::State &state) {
+  const int n_observers = state.range(0);
+  const StrokeModelParams params = RecommendedStrokeModelParams();
+  const std::vector<Input> inputs = GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .duration = Duration(1),
+       .input_rate = 240,
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .tilt_profile = SyntheticTiltProfile::kVarying});
+
+  // The number of Results that the server publishes for each stroke.
+  size_t n_results = 0;
+  {
+    StrokeModeler modeler;
+    if (!modeler.Reset(params).ok()) {
+      state.SkipWithError("Reset failed");
+      return;
+    }
+    std::vector<Result> results;
+    for (const Input &input : inputs) {
+      if (!modeler.Update(input, results).ok()) {
+        state.SkipWithError("Update failed");
+        return;
+      }
+    }
+    n_results = results.size();
+  }
+
+  absl::StatusOr<std::unique_ptr<StrokeModelingServer>> server =
+      StrokeModelingServer::Create(params, {.socket_path = SocketPath()});
+  if (!server.ok()) {
+    state.SkipWithError(server.status().ToString().c_str());
+    return;
+  }
+  std::thread server_thread([&server]() { (*server)->Run().IgnoreError(); });
+
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> sender =
+      StrokeModelingClient::Connect(SocketPath());
+  std::vector<std::unique_ptr<StrokeModelingClient>> observers;
+  for (int i = 0; sender.ok() && i < n_observers; ++i) {
+    absl::StatusOr<std::unique_ptr<StrokeModelingClient>> observer =
+        StrokeModelingClient::Connect(SocketPath());
+    if (!observer.ok()) {
+      sender = observer.status();
+      break;
+    }
+    observers.push_back(*std::move(observer));
+  }
+  if (!sender.ok()) {
+    state.SkipWithError(sender.status().ToString().c_str());
+    (*server)->Shutdown();
+    server_thread.join();
+    return;
+  }
+
+  // The observers poll for Results until the benchmark is done.
+  std::atomic<bool> done = false;
+  std::vector<std::thread> observer_threads;
+  for (std::unique_ptr<StrokeModelingClient> &observer : observers) {
+    observer_threads.emplace_back([&observer, &done]() {
+      std::vector<BroadcastResult> results;
+      while (!done.load(std::memory_order_relaxed)) {
+        results.clear();
+        observer->ReadResults(results);
+        benchmark::DoNotOptimize(results.data());
+      }
+    });
+  }
+
+  std::vector<BroadcastResult> results;
+  for (auto _ : state) {
+    bool sent = true;
+    for (const Input &input : inputs) {
+      if (!(*sender)->SendInput(input).ok()) {
+        sent = false;
+        break;
+      }
+    }
+    if (!sent) {
+      state.SkipWithError("SendInput failed");
+      break;
+    }
+    AwaitResults(**sender, n_results, results);
+  }
+
+  done.store(true, std::memory_order_relaxed);
+  for (std::thread &observer_thread : observer_threads) observer_thread.join();
+  (*server)->Shutdown();
+  server_thread.join();
+
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  state.counters["dropped"] = (*sender)->NumDropped();
+}
+BENCHMARK(BM_ServerLoopbackStroke)
+    ->ArgName("observers")
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(4)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
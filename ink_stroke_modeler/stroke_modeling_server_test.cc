@@ -0,0 +1,322 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_modeling_server.h"
+
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/internal/type_matchers.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/result_broadcast_ring.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/stroke_modeling_client.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+constexpr float kTol = 1e-6;
+
+std::string SocketPath() {
+  return absl::StrCat(
+      ::testing::TempDir(), "ink_",
+      ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+// Runs a server on a separate thread for the lifetime of the fixture.
+class StrokeModelingServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    absl::StatusOr<std::unique_ptr<StrokeModelingServer>> server =
+        StrokeModelingServer::Create(RecommendedStrokeModelParams(),
+                                     {.socket_path = socket_path_});
+    if (server.status().code() == absl::StatusCode::kUnavailable) {
+      GTEST_SKIP() << server.status();
+    }
+    ASSERT_TRUE(server.ok()) << server.status();
+    server_ = *std::move(server);
+    server_thread_ = std::thread([this]() { run_status_ = server_->Run(); });
+  }
+
+  void TearDown() override {
+    if (server_ == nullptr) return;
+    server_->Shutdown();
+    server_thread_.join();
+    EXPECT_TRUE(run_status_.ok()) << run_status_;
+  }
+
+  // Reads from the client until there are at least `n_results`, or a timeout
+  // expires.
+  std::vector<BroadcastResult> ReadResults(StrokeModelingClient &client,
+                                           size_t n_results) {
+    std::vector<BroadcastResult> results;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (results.size() < n_results &&
+           std::chrono::steady_clock::now() < deadline) {
+      client.ReadResults(results);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return results;
+  }
+
+  // Waits for the server to have handled `n_inputs` inputs, modeled or not.
+  void WaitForInputs(int64_t n_inputs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (server_->NumModeledInputs() + server_->NumRejectedInputs() <
+               n_inputs &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  std::string socket_path_ = SocketPath();
+  std::unique_ptr<StrokeModelingServer> server_;
+  std::thread server_thread_;
+  absl::Status run_status_;
+};
+
+std::vector<Input> MakeStroke(int seed) {
+  return GenerateSyntheticStroke(
+      {.shape = SyntheticStrokeShape::kSignature,
+       .duration = Duration(.25),
+       .pressure_profile = SyntheticPressureProfile::kTaper,
+       .seed = static_cast<uint32_t>(seed)});
+}
+
+std::vector<Result> ModelLocally(const std::vector<Input> &inputs) {
+  StrokeModeler modeler;
+  EXPECT_TRUE(modeler.Reset(RecommendedStrokeModelParams()).ok());
+  std::vector<Result> results;
+  for (const Input &input : inputs) {
+    EXPECT_TRUE(modeler.Update(input, results).ok());
+  }
+  return results;
+}
+
+TEST(StrokeModelingServerCreateTest, RejectsBadParams) {
+  EXPECT_EQ(StrokeModelingServer::Create(RecommendedStrokeModelParams(),
+                                         {.socket_path = ""})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(StrokeModelingServer::Create(RecommendedStrokeModelParams(),
+                                         {.socket_path = std::string(200, 'a')})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  StrokeModelParams bad_params = RecommendedStrokeModelParams();
+  bad_params.wobble_smoother_params.timeout = Duration(-1);
+  EXPECT_EQ(
+      StrokeModelingServer::Create(bad_params, {.socket_path = SocketPath()})
+          .status()
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+TEST(StrokeModelingClientTest, ConnectFailsWithoutServer) {
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> client =
+      StrokeModelingClient::Connect(SocketPath());
+  EXPECT_FALSE(client.ok());
+}
+
+TEST_F(StrokeModelingServerTest, ModelsLikeALocalModeler) {
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> sender =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(sender.ok()) << sender.status();
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> observer =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(observer.ok()) << observer.status();
+
+  const std::vector<Input> inputs = MakeStroke(1);
+  for (const Input &input : inputs) {
+    ASSERT_TRUE((*sender)->SendInput(input).ok());
+  }
+  const std::vector<Result> expected = ModelLocally(inputs);
+  ASSERT_THAT(expected, Not(IsEmpty()));
+
+  // Both clients see the same Results, though only one of them sent inputs.
+  for (StrokeModelingClient *client : {sender->get(), observer->get()}) {
+    std::vector<BroadcastResult> results =
+        ReadResults(*client, expected.size());
+    ASSERT_THAT(results, SizeIs(expected.size()));
+    for (size_t i = 0; i < results.size(); ++i) {
+      EXPECT_EQ(results[i].stroke_index, 1);
+      EXPECT_THAT(results[i].result, ResultNear(expected[i], kTol, kTol));
+    }
+    EXPECT_EQ(client->NumDropped(), 0);
+  }
+  EXPECT_EQ(server_->NumModeledInputs(), static_cast<int64_t>(inputs.size()));
+  EXPECT_EQ(server_->NumRejectedInputs(), 0);
+}
+
+TEST_F(StrokeModelingServerTest, DownEventStartsANewStroke) {
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> client =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(client.ok()) << client.status();
+
+  // The first stroke never ends, so the second one's down event discards it.
+  std::vector<Input> first_stroke = MakeStroke(1);
+  first_stroke.pop_back();
+  const std::vector<Input> second_stroke = MakeStroke(2);
+  for (const Input &input : first_stroke) {
+    ASSERT_TRUE((*client)->SendInput(input).ok());
+  }
+  for (const Input &input : second_stroke) {
+    ASSERT_TRUE((*client)->SendInput(input).ok());
+  }
+
+  const std::vector<Result> expected_first = ModelLocally(first_stroke);
+  const std::vector<Result> expected_second = ModelLocally(second_stroke);
+  std::vector<BroadcastResult> results = ReadResults(
+      **client, expected_first.size() + expected_second.size());
+  ASSERT_THAT(results, SizeIs(expected_first.size() + expected_second.size()));
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (i < expected_first.size()) {
+      EXPECT_EQ(results[i].stroke_index, 1);
+      EXPECT_THAT(results[i].result,
+                  ResultNear(expected_first[i], kTol, kTol));
+    } else {
+      EXPECT_EQ(results[i].stroke_index, 2);
+      EXPECT_THAT(results[i].result,
+                  ResultNear(expected_second[i - expected_first.size()], kTol,
+                             kTol));
+    }
+  }
+}
+
+TEST_F(StrokeModelingServerTest, CountsRejectedInputs) {
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> client =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(client.ok()) << client.status();
+
+  // A move event without a preceding down event.
+  ASSERT_TRUE(
+      (*client)
+          ->SendInput({.event_type = Input::EventType::kMove, .time = Time(0)})
+          .ok());
+  ASSERT_TRUE(
+      (*client)
+          ->SendInput({.event_type = Input::EventType::kDown, .time = Time(0)})
+          .ok());
+  // An input that goes back in time.
+  ASSERT_TRUE(
+      (*client)
+          ->SendInput({.event_type = Input::EventType::kMove, .time = Time(-1)})
+          .ok());
+  WaitForInputs(3);
+  EXPECT_EQ(server_->NumModeledInputs(), 1);
+  EXPECT_EQ(server_->NumRejectedInputs(), 2);
+
+  // The connection is still usable.
+  ASSERT_TRUE(
+      (*client)
+          ->SendInput({.event_type = Input::EventType::kUp, .time = Time(1)})
+          .ok());
+  WaitForInputs(4);
+  EXPECT_EQ(server_->NumModeledInputs(), 2);
+}
+
+TEST_F(StrokeModelingServerTest, RejectsInputsFromOtherClients) {
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> producer =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(producer.ok()) << producer.status();
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> other =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(other.ok()) << other.status();
+
+  const std::vector<Input> inputs = MakeStroke(1);
+  ASSERT_TRUE((*producer)->SendInput(inputs[0]).ok());
+  WaitForInputs(1);
+  // This would start a new stroke if it came from the producer.
+  ASSERT_TRUE((*other)->SendInput(MakeStroke(2)[0]).ok());
+  WaitForInputs(2);
+  for (size_t i = 1; i < inputs.size(); ++i) {
+    ASSERT_TRUE((*producer)->SendInput(inputs[i]).ok());
+  }
+
+  const std::vector<Result> expected = ModelLocally(inputs);
+  std::vector<BroadcastResult> results = ReadResults(**other, expected.size());
+  ASSERT_THAT(results, SizeIs(expected.size()));
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].stroke_index, 1);
+    EXPECT_THAT(results[i].result, ResultNear(expected[i], kTol, kTol));
+  }
+  EXPECT_EQ(server_->NumModeledInputs(), static_cast<int64_t>(inputs.size()));
+  EXPECT_EQ(server_->NumRejectedInputs(), 1);
+}
+
+TEST_F(StrokeModelingServerTest, ServesClientsAfterOthersDisconnect) {
+  // The first producer disconnects in the middle of a stroke.
+  std::vector<Input> first_stroke = MakeStroke(1);
+  first_stroke.pop_back();
+  {
+    absl::StatusOr<std::unique_ptr<StrokeModelingClient>> client =
+        StrokeModelingClient::Connect(socket_path_);
+    ASSERT_TRUE(client.ok()) << client.status();
+    for (const Input &input : first_stroke) {
+      ASSERT_TRUE((*client)->SendInput(input).ok());
+    }
+    WaitForInputs(first_stroke.size());
+  }
+
+  // The next client to send inputs becomes the producer, and its inputs don't
+  // continue the first producer's stroke.
+  absl::StatusOr<std::unique_ptr<StrokeModelingClient>> client =
+      StrokeModelingClient::Connect(socket_path_);
+  ASSERT_TRUE(client.ok()) << client.status();
+  const std::vector<Input> second_stroke = MakeStroke(3);
+  ASSERT_TRUE(
+      (*client)
+          ->SendInput({.event_type = Input::EventType::kMove, .time = Time(9)})
+          .ok());
+  for (const Input &input : second_stroke) {
+    ASSERT_TRUE((*client)->SendInput(input).ok());
+  }
+
+  const size_t n_expected_first = ModelLocally(first_stroke).size();
+  const std::vector<Result> expected_second = ModelLocally(second_stroke);
+  std::vector<BroadcastResult> results =
+      ReadResults(**client, n_expected_first + expected_second.size());
+  ASSERT_THAT(results, SizeIs(n_expected_first + expected_second.size()));
+  for (size_t i = n_expected_first; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].stroke_index, 2);
+    EXPECT_THAT(results[i].result,
+                ResultNear(expected_second[i - n_expected_first], kTol, kTol));
+  }
+  EXPECT_EQ(server_->NumModeledInputs(),
+            static_cast<int64_t>(first_stroke.size() + second_stroke.size()));
+  EXPECT_EQ(server_->NumRejectedInputs(), 1);
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
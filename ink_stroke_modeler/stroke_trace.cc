@@ -0,0 +1,198 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+std::atomic<TraceRecorder *> global_recorder = nullptr;
+
+absl::string_view PhaseCode(TraceEvent::Phase phase) {
+  switch (phase) {
+    case TraceEvent::Phase::kComplete:
+      return "X";
+    case TraceEvent::Phase::kInstant:
+      return "i";
+    case TraceEvent::Phase::kCounter:
+      return "C";
+  }
+  return "i";
+}
+
+// Appends `value` as a JSON string, escaping the characters that need it.
+void AppendJsonString(absl::string_view value, std::string &json) {
+  json.push_back('"');
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      json.push_back('\\');
+      json.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&json, "\\u%04x", c);
+    } else {
+      json.push_back(c);
+    }
+  }
+  json.push_back('"');
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(int capacity) : ring_(std::max(1, capacity)) {}
+
+void TraceRecorder::Record(const TraceEvent &event) {
+  absl::MutexLock lock(&mutex_);
+  ring_[next_] = event;
+  next_ = (next_ + 1) % ring_.size();
+  if (size_ < static_cast<int>(ring_.size())) {
+    ++size_;
+  } else {
+    ++n_dropped_;
+  }
+}
+
+std::vector<TraceEvent> TraceRecorder::Events() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<TraceEvent> events;
+  events.reserve(size_);
+  int first = (next_ - size_ + ring_.size()) % ring_.size();
+  for (int i = 0; i < size_; ++i) {
+    events.push_back(ring_[(first + i) % ring_.size()]);
+  }
+  return events;
+}
+
+int64_t TraceRecorder::DroppedEventCount() const {
+  absl::MutexLock lock(&mutex_);
+  return n_dropped_;
+}
+
+void TraceRecorder::Clear() {
+  absl::MutexLock lock(&mutex_);
+  next_ = 0;
+  size_ = 0;
+  n_dropped_ = 0;
+}
+
+std::string TraceRecorder::ToChromeTraceJson() const {
+  std::vector<TraceEvent> events = Events();
+  // Chrome expects timestamps in microseconds. They're made relative to the
+  // first event, so that they fit in a double without losing precision.
+  const int64_t origin_ns = events.empty() ? 0 : events.front().timestamp_ns;
+  std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent &event = events[i];
+    if (i > 0) json.push_back(',');
+    json.append("\n{\"name\":");
+    AppendJsonString(event.name, json);
+    absl::StrAppend(&json, ",\"cat\":\"ink_stroke_modeler\",\"ph\":\"",
+                    PhaseCode(event.phase), "\",\"pid\":1,\"tid\":",
+                    event.thread_id);
+    absl::StrAppendFormat(&json, ",\"ts\":%.3f",
+                          (event.timestamp_ns - origin_ns) * 1e-3);
+    switch (event.phase) {
+      case TraceEvent::Phase::kComplete:
+        absl::StrAppendFormat(&json, ",\"dur\":%.3f", event.duration_ns * 1e-3);
+        break;
+      case TraceEvent::Phase::kInstant:
+        // Scope the instant event to its thread.
+        json.append(",\"s\":\"t\"");
+        break;
+      case TraceEvent::Phase::kCounter:
+        break;
+    }
+    if (event.value.has_value()) {
+      absl::StrAppendFormat(&json, ",\"args\":{\"value\":%.17g}",
+                            *event.value);
+    }
+    json.push_back('}');
+  }
+  json.append("\n]}\n");
+  return json;
+}
+
+absl::Status TraceRecorder::WriteChromeTraceJson(absl::string_view path) const {
+  std::ofstream file{std::string(path)};
+  if (!file) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Could not open trace file for writing: ", path));
+  }
+  file << ToChromeTraceJson();
+  file.close();
+  if (!file) {
+    return absl::InternalError(
+        absl::StrCat("Could not write trace file: ", path));
+  }
+  return absl::OkStatus();
+}
+
+void SetTraceRecorder(TraceRecorder *recorder) {
+  global_recorder.store(recorder, std::memory_order_release);
+}
+
+TraceRecorder *GetTraceRecorder() {
+  return global_recorder.load(std::memory_order_acquire);
+}
+
+namespace stroke_trace_internal {
+
+int64_t NowNanos() { return absl::GetCurrentTimeNanos(); }
+
+int CurrentThreadId() {
+  static std::atomic<int> next_thread_id = 1;
+  thread_local int thread_id = next_thread_id.fetch_add(1);
+  return thread_id;
+}
+
+void RecordEvent(const char *name, TraceEvent::Phase phase,
+                 std::optional<double> value) {
+  TraceRecorder *recorder = GetTraceRecorder();
+  if (recorder == nullptr) return;
+  recorder->Record({.name = name,
+                    .phase = phase,
+                    .timestamp_ns = NowNanos(),
+                    .duration_ns = 0,
+                    .thread_id = CurrentThreadId(),
+                    .value = value});
+}
+
+TraceScope::~TraceScope() {
+  if (recorder_ == nullptr) return;
+  recorder_->Record({.name = name_,
+                     .phase = TraceEvent::Phase::kComplete,
+                     .timestamp_ns = start_ns_,
+                     .duration_ns = NowNanos() - start_ns_,
+                     .thread_id = CurrentThreadId(),
+                     .value = std::nullopt});
+}
+
+}  // namespace stroke_trace_internal
+}  // namespace stroke_model
+}  // namespace ink
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_STROKE_TRACE_H_
+#define INK_STROKE_MODELER_STROKE_TRACE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+namespace stroke_model {
+
+// A single event on a stroke processing timeline, in the sense of the Chrome
+// trace event format.
+struct TraceEvent {
+  enum class Phase {
+    // A span of time, e.g. a stage of StrokeModeler::Update().
+    kComplete,
+    // A point in time, e.g. the arrival of an Input.
+    kInstant,
+    // A sampled value, e.g. the number of tip states modeled.
+    kCounter,
+  };
+
+  // The name must be a string literal, or otherwise outlive the recorder.
+  const char *name = "";
+  Phase phase = Phase::kInstant;
+  // Wall-clock times, in nanoseconds since the Unix epoch. The duration is
+  // only meaningful for kComplete events.
+  int64_t timestamp_ns = 0;
+  int64_t duration_ns = 0;
+  // A small integer identifying the thread that recorded the event.
+  int thread_id = 0;
+  // The value of a kCounter event, or an optional argument of another event,
+  // e.g. the Input::time of an Input's arrival.
+  std::optional<double> value;
+};
+
+// Records TraceEvents into a fixed-capacity ring in memory, overwriting the
+// oldest events once it is full, and dumps them in the Chrome trace event JSON
+// format, which can be viewed in chrome://tracing or https://ui.perfetto.dev.
+//
+// StrokeModeler records into the recorder passed to SetTraceRecorder(), but
+// only if the library was built with INK_STROKE_MODELER_ENABLE_TRACING defined
+// (--define=ink_stroke_modeler_tracing=true with Bazel, or
+// -DINK_STROKE_MODELER_ENABLE_TRACING=ON with CMake). Otherwise, the tracing
+// macros below compile to nothing.
+//
+// This class is thread-safe.
+class TraceRecorder {
+ public:
+  explicit TraceRecorder(int capacity = 1 << 16);
+
+  void Record(const TraceEvent &event) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the recorded events, oldest first.
+  std::vector<TraceEvent> Events() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of events overwritten since the last Clear().
+  int64_t DroppedEventCount() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void Clear() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the recorded events as a Chrome trace event JSON object.
+  std::string ToChromeTraceJson() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Writes ToChromeTraceJson() to the file at `path`.
+  absl::Status WriteChromeTraceJson(absl::string_view path) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::vector<TraceEvent> ring_ ABSL_GUARDED_BY(mutex_);
+  // The index in ring_ at which the next event will be recorded.
+  int next_ ABSL_GUARDED_BY(mutex_) = 0;
+  int size_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t n_dropped_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Sets the recorder that StrokeModeler records its timeline into, or nullptr
+// to stop recording. The recorder is shared by all threads, and must outlive
+// its use.
+void SetTraceRecorder(TraceRecorder *recorder);
+TraceRecorder *GetTraceRecorder();
+
+namespace stroke_trace_internal {
+
+// Returns the current wall-clock time, in nanoseconds since the Unix epoch.
+int64_t NowNanos();
+
+// Returns a small integer identifying the calling thread.
+int CurrentThreadId();
+
+void RecordEvent(const char *name, TraceEvent::Phase phase,
+                 std::optional<double> value);
+
+// Records a kComplete event spanning its lifetime, if a recorder was set when
+// it was constructed.
+class TraceScope {
+ public:
+  explicit TraceScope(const char *name)
+      : name_(name),
+        recorder_(GetTraceRecorder()),
+        start_ns_(recorder_ != nullptr ? NowNanos() : 0) {}
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+ private:
+  const char *name_;
+  TraceRecorder *recorder_;
+  int64_t start_ns_;
+};
+
+}  // namespace stroke_trace_internal
+}  // namespace stroke_model
+}  // namespace ink
+
+#define INK_STROKE_TRACE_CONCAT_INNER(a, b) a##b
+#define INK_STROKE_TRACE_CONCAT(a, b) INK_STROKE_TRACE_CONCAT_INNER(a, b)
+
+#ifdef INK_STROKE_MODELER_ENABLE_TRACING
+
+// Records the time from here to the end of the enclosing scope.
+#define INK_STROKE_TRACE_SCOPE(name)                         \
+  ::ink::stroke_model::stroke_trace_internal::TraceScope     \
+  INK_STROKE_TRACE_CONCAT(ink_stroke_trace_scope_, __LINE__)(name)
+
+// Records a point in time, with a value as its argument.
+#define INK_STROKE_TRACE_INSTANT(name, value)                 \
+  ::ink::stroke_model::stroke_trace_internal::RecordEvent(    \
+      name, ::ink::stroke_model::TraceEvent::Phase::kInstant, \
+      static_cast<double>(value))
+
+// Records the value of a counter.
+#define INK_STROKE_TRACE_COUNTER(name, value)                 \
+  ::ink::stroke_model::stroke_trace_internal::RecordEvent(    \
+      name, ::ink::stroke_model::TraceEvent::Phase::kCounter, \
+      static_cast<double>(value))
+
+#else
+
+#define INK_STROKE_TRACE_SCOPE(name)
+#define INK_STROKE_TRACE_INSTANT(name, value) \
+  do {                                        \
+  } while (false)
+#define INK_STROKE_TRACE_COUNTER(name, value) \
+  do {                                        \
+  } while (false)
+
+#endif  // INK_STROKE_MODELER_ENABLE_TRACING
+
+#endif  // INK_STROKE_MODELER_STROKE_TRACE_H_
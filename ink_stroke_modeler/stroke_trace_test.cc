@@ -0,0 +1,217 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/stroke_trace.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+using ::testing::StrEq;
+
+TraceEvent MakeEvent(const char *name, int64_t timestamp_ns) {
+  return {.name = name, .timestamp_ns = timestamp_ns};
+}
+
+TEST(TraceRecorderTest, EventsAreReturnedOldestFirst) {
+  TraceRecorder recorder(4);
+  recorder.Record(MakeEvent("a", 1));
+  recorder.Record(MakeEvent("b", 2));
+  recorder.Record(MakeEvent("c", 3));
+
+  EXPECT_THAT(recorder.Events(),
+              ElementsAre(Field(&TraceEvent::name, StrEq("a")),
+                          Field(&TraceEvent::name, StrEq("b")),
+                          Field(&TraceEvent::name, StrEq("c"))));
+  EXPECT_EQ(recorder.DroppedEventCount(), 0);
+}
+
+TEST(TraceRecorderTest, FullRingOverwritesOldestEvents) {
+  TraceRecorder recorder(2);
+  recorder.Record(MakeEvent("a", 1));
+  recorder.Record(MakeEvent("b", 2));
+  recorder.Record(MakeEvent("c", 3));
+  recorder.Record(MakeEvent("d", 4));
+  recorder.Record(MakeEvent("e", 5));
+
+  EXPECT_THAT(recorder.Events(),
+              ElementsAre(Field(&TraceEvent::name, StrEq("d")),
+                          Field(&TraceEvent::name, StrEq("e"))));
+  EXPECT_EQ(recorder.DroppedEventCount(), 3);
+}
+
+TEST(TraceRecorderTest, ClearDiscardsEvents) {
+  TraceRecorder recorder(2);
+  recorder.Record(MakeEvent("a", 1));
+  recorder.Record(MakeEvent("b", 2));
+  recorder.Record(MakeEvent("c", 3));
+  recorder.Clear();
+
+  EXPECT_THAT(recorder.Events(), IsEmpty());
+  EXPECT_EQ(recorder.DroppedEventCount(), 0);
+
+  recorder.Record(MakeEvent("d", 4));
+  EXPECT_THAT(recorder.Events(),
+              ElementsAre(Field(&TraceEvent::name, StrEq("d"))));
+}
+
+TEST(TraceRecorderTest, ChromeTraceJson) {
+  TraceRecorder recorder;
+  recorder.Record({.name = "Update",
+                   .phase = TraceEvent::Phase::kComplete,
+                   .timestamp_ns = 10'000,
+                   .duration_ns = 2'500,
+                   .thread_id = 3});
+  recorder.Record({.name = "InputMove",
+                   .phase = TraceEvent::Phase::kInstant,
+                   .timestamp_ns = 11'000,
+                   .thread_id = 3,
+                   .value = .5});
+  recorder.Record({.name = "tip_states",
+                   .phase = TraceEvent::Phase::kCounter,
+                   .timestamp_ns = 12'000,
+                   .thread_id = 3,
+                   .value = 7});
+
+  EXPECT_EQ(recorder.ToChromeTraceJson(),
+            R"({"displayTimeUnit":"ns","traceEvents":[
+{"name":"Update","cat":"ink_stroke_modeler","ph":"X","pid":1,"tid":3,)"
+            R"("ts":0.000,"dur":2.500},
+{"name":"InputMove","cat":"ink_stroke_modeler","ph":"i","pid":1,"tid":3,)"
+            R"("ts":1.000,"s":"t","args":{"value":0.5}},
+{"name":"tip_states","cat":"ink_stroke_modeler","ph":"C","pid":1,"tid":3,)"
+            R"("ts":2.000,"args":{"value":7}}
+]}
+)");
+}
+
+TEST(TraceRecorderTest, ChromeTraceJsonEscapesNames) {
+  TraceRecorder recorder;
+  recorder.Record(MakeEvent("a \"quoted\\name\"\n", 0));
+
+  EXPECT_THAT(recorder.ToChromeTraceJson(),
+              HasSubstr(R"("name":"a \"quoted\\name\"\u000a")"));
+}
+
+TEST(TraceRecorderTest, ChromeTraceJsonWithNoEvents) {
+  TraceRecorder recorder;
+  EXPECT_EQ(recorder.ToChromeTraceJson(),
+            "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n");
+}
+
+TEST(TraceRecorderTest, WriteChromeTraceJson) {
+  TraceRecorder recorder;
+  recorder.Record(MakeEvent("a", 0));
+  EXPECT_TRUE(
+      recorder
+          .WriteChromeTraceJson(testing::TempDir() + "/stroke_trace.json")
+          .ok());
+}
+
+TEST(TraceRecorderTest, WriteChromeTraceJsonToBadPath) {
+  TraceRecorder recorder;
+  EXPECT_EQ(
+      recorder
+          .WriteChromeTraceJson(testing::TempDir() + "/no/such/dir/trace.json")
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+TEST(TraceRecorderTest, SetTraceRecorder) {
+  TraceRecorder recorder;
+  SetTraceRecorder(&recorder);
+  EXPECT_EQ(GetTraceRecorder(), &recorder);
+  SetTraceRecorder(nullptr);
+  EXPECT_EQ(GetTraceRecorder(), nullptr);
+}
+
+TEST(StrokeTraceTest, StrokeModelerTimeline) {
+  const StrokeModelParams params{
+      .wobble_smoother_params{
+          .timeout = Duration(.04), .speed_floor = 1.31, .speed_ceiling = 1.44},
+      .position_modeler_params{.spring_mass_constant = 11.f / 32400,
+                               .drag_constant = 72.f},
+      .sampling_params{.min_output_rate = 180,
+                       .end_of_stroke_stopping_distance = .001,
+                       .end_of_stroke_max_iterations = 20},
+      .stylus_state_modeler_params{.max_input_samples = 20},
+      .prediction_params = StrokeEndPredictorParams()};
+  StrokeModeler modeler;
+  ASSERT_TRUE(modeler.Reset(params).ok());
+
+  TraceRecorder recorder;
+  SetTraceRecorder(&recorder);
+  std::vector<Result> results;
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kDown,
+                           .position = {0, 0},
+                           .time = Time(0)},
+                          results)
+                  .ok());
+  ASSERT_TRUE(modeler
+                  .Update({.event_type = Input::EventType::kMove,
+                           .position = {1, 0},
+                           .time = Time(.02)},
+                          results)
+                  .ok());
+  ASSERT_TRUE(modeler.Predict(results).ok());
+  SetTraceRecorder(nullptr);
+
+#ifdef INK_STROKE_MODELER_ENABLE_TRACING
+  const std::vector<TraceEvent> events = recorder.Events();
+  EXPECT_THAT(events,
+              Contains(AllOf(Field(&TraceEvent::name, StrEq("InputDown")),
+                             Field(&TraceEvent::value, Optional(0)))));
+  EXPECT_THAT(events,
+              Contains(AllOf(Field(&TraceEvent::name, StrEq("InputMove")),
+                             Field(&TraceEvent::value, Optional(.02)))));
+  for (const char *name :
+       {"StrokeModeler::Update", "StrokeModeler::ProcessMoveEvent",
+        "WobbleSmoother::Update", "StrokeModeler::Predict"}) {
+    EXPECT_THAT(events, Contains(AllOf(
+                            Field(&TraceEvent::name, StrEq(name)),
+                            Field(&TraceEvent::phase,
+                                  TraceEvent::Phase::kComplete))));
+  }
+  EXPECT_THAT(events,
+              Contains(AllOf(Field(&TraceEvent::name, StrEq("tip_states")),
+                             Field(&TraceEvent::phase,
+                                   TraceEvent::Phase::kCounter))));
+#else
+  // Without INK_STROKE_MODELER_ENABLE_TRACING, the instrumentation is compiled
+  // out.
+  EXPECT_THAT(recorder.Events(), IsEmpty());
+#endif  // INK_STROKE_MODELER_ENABLE_TRACING
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
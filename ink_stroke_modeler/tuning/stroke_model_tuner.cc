@@ -0,0 +1,433 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/tuning/stroke_model_tuner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "ink_stroke_modeler/internal/utils.h"
+#include "ink_stroke_modeler/internal/validation.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/stroke_modeler.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+absl::StatusOr<Input::EventType> ParseEventType(absl::string_view str) {
+  if (str == "down") return Input::EventType::kDown;
+  if (str == "move") return Input::EventType::kMove;
+  if (str == "up") return Input::EventType::kUp;
+  return absl::InvalidArgumentError(
+      absl::Substitute("Unknown event type \"$0\"", str));
+}
+
+absl::StatusOr<Input> ParseInput(absl::string_view line) {
+  std::vector<absl::string_view> fields = absl::StrSplit(line, ',');
+  if (fields.size() != 4 && fields.size() != 7) {
+    return absl::InvalidArgumentError(
+        absl::Substitute("Expected 4 or 7 fields, got $0", fields.size()));
+  }
+  for (absl::string_view &field : fields) {
+    field = absl::StripAsciiWhitespace(field);
+  }
+
+  absl::StatusOr<Input::EventType> event_type = ParseEventType(fields[0]);
+  if (!event_type.ok()) return event_type.status();
+  Input input{.event_type = *event_type};
+  double time;
+  if (!absl::SimpleAtof(fields[1], &input.position.x) ||
+      !absl::SimpleAtof(fields[2], &input.position.y) ||
+      !absl::SimpleAtod(fields[3], &time)) {
+    return absl::InvalidArgumentError("Malformed position or time");
+  }
+  input.time = Time(time);
+  if (fields.size() == 7 &&
+      (!absl::SimpleAtof(fields[4], &input.pressure) ||
+       !absl::SimpleAtof(fields[5], &input.tilt) ||
+       !absl::SimpleAtof(fields[6], &input.orientation))) {
+    return absl::InvalidArgumentError(
+        "Malformed pressure, tilt, or orientation");
+  }
+  return input;
+}
+
+// Returns the modeled position at `time`, linearly interpolated between the
+// Results on either side of it. `results` must be non-empty and sorted by
+// time. Times outside of the range of `results` are clamped to it.
+Vec2 ModeledPositionAt(const std::vector<Result> &results, Time time) {
+  auto it = std::lower_bound(
+      results.begin(), results.end(), time,
+      [](const Result &result, Time t) { return result.time < t; });
+  if (it == results.begin()) return results.front().position;
+  if (it == results.end()) return results.back().position;
+  const Result &before = *(it - 1);
+  const Result &after = *it;
+  float t = Normalize01(before.time.Value(), after.time.Value(), time.Value());
+  return Interp(before.position, after.position, t);
+}
+
+// Running sums for the StrokeModelScore metrics.
+struct ScoreAccumulator {
+  double jerk_squared_sum = 0;
+  int64_t n_jerk = 0;
+  double lag_sum = 0;
+  int64_t n_lag = 0;
+  double prediction_error_sum = 0;
+  int64_t n_prediction = 0;
+
+  void AddStroke(const std::vector<Input> &inputs,
+                 const std::vector<Result> &results,
+                 const std::vector<Result> &predictions) {
+    if (results.empty()) return;
+    for (size_t i = 1; i < results.size(); ++i) {
+      double dt = (results[i].time - results[i - 1].time).Value();
+      if (dt <= 0) continue;
+      double jerk =
+          (results[i].acceleration - results[i - 1].acceleration).Magnitude() /
+          dt;
+      jerk_squared_sum += jerk * jerk;
+      ++n_jerk;
+    }
+    for (const Input &input : inputs) {
+      // The first Result is always at the down event's position.
+      if (input.event_type == Input::EventType::kDown) continue;
+      lag_sum += Distance(input.position,
+                          ModeledPositionAt(results, input.time));
+      ++n_lag;
+    }
+    for (const Result &prediction : predictions) {
+      // Predictions past the end of the stroke have nothing to compare to.
+      if (prediction.time > results.back().time) continue;
+      prediction_error_sum +=
+          Distance(prediction.position,
+                   ModeledPositionAt(results, prediction.time));
+      ++n_prediction;
+    }
+  }
+
+  StrokeModelScore Score() const {
+    return {
+        .rms_jerk = n_jerk == 0 ? 0 : std::sqrt(jerk_squared_sum / n_jerk),
+        .mean_lag = n_lag == 0 ? 0 : lag_sum / n_lag,
+        .mean_prediction_error =
+            n_prediction == 0 ? 0 : prediction_error_sum / n_prediction,
+    };
+  }
+};
+
+KalmanPredictorParams &KalmanParams(StrokeModelParams &params) {
+  return std::get<KalmanPredictorParams>(params.prediction_params);
+}
+
+// Scales one (or one group) of the tuned parameters by the given factor.
+using ScaleParamFn = void (*)(StrokeModelParams &params, double scale);
+
+// Returns the functions that scale each of the tuned parameters. Each tuned
+// parameter is scaled from its base value by `max_scale_factor` raised to the
+// power of the candidate's coordinate in [-1, 1].
+std::vector<ScaleParamFn> TunedParams(const StrokeModelParams &base) {
+  std::vector<ScaleParamFn> tuned;
+  if (base.wobble_smoother_params.is_enabled) {
+    tuned.push_back([](StrokeModelParams &params, double scale) {
+      params.wobble_smoother_params.timeout =
+          params.wobble_smoother_params.timeout * scale;
+    });
+    // The floor and ceiling are scaled together, so that the floor stays
+    // below the ceiling.
+    tuned.push_back([](StrokeModelParams &params, double scale) {
+      params.wobble_smoother_params.speed_floor *= scale;
+      params.wobble_smoother_params.speed_ceiling *= scale;
+    });
+  }
+  tuned.push_back([](StrokeModelParams &params, double scale) {
+    params.position_modeler_params.spring_mass_constant *= scale;
+  });
+  tuned.push_back([](StrokeModelParams &params, double scale) {
+    params.position_modeler_params.drag_constant *= scale;
+  });
+  if (std::holds_alternative<KalmanPredictorParams>(base.prediction_params)) {
+    tuned.push_back([](StrokeModelParams &params, double scale) {
+      KalmanParams(params).process_noise *= scale;
+    });
+    tuned.push_back([](StrokeModelParams &params, double scale) {
+      KalmanParams(params).measurement_noise *= scale;
+    });
+    tuned.push_back([](StrokeModelParams &params, double scale) {
+      KalmanParams(params).prediction_interval =
+          KalmanParams(params).prediction_interval * scale;
+    });
+  }
+  return tuned;
+}
+
+struct Candidate {
+  // The coordinates of the candidate in the search space, one per tuned
+  // parameter.
+  std::vector<double> coordinates;
+  StrokeModelParams params;
+  std::optional<StrokeModelScore> score;
+};
+
+// Returns the indices of the candidates that aren't dominated by any other.
+std::vector<int> ParetoFront(const std::vector<Candidate> &candidates) {
+  std::vector<int> front;
+  for (int i = 0; i < static_cast<int>(candidates.size()); ++i) {
+    if (!candidates[i].score.has_value()) continue;
+    bool dominated = false;
+    for (const Candidate &other : candidates) {
+      if (other.score.has_value() &&
+          Dominates(*other.score, *candidates[i].score)) {
+        dominated = true;
+        break;
+      }
+    }
+    if (!dominated) front.push_back(i);
+  }
+  return front;
+}
+
+// Scores each of the candidates in [begin, candidates.size()) on `n_threads`
+// threads. Candidates that can't model the corpus are left without a score.
+void ScoreCandidates(const StrokeCorpus &corpus, int n_threads, size_t begin,
+                     std::vector<Candidate> &candidates) {
+  std::atomic<size_t> next = begin;
+  auto score_candidates = [&corpus, &next, &candidates]() {
+    for (size_t i = next++; i < candidates.size(); i = next++) {
+      absl::StatusOr<StrokeModelScore> score =
+          ScoreStrokeModelParams(candidates[i].params, corpus);
+      if (score.ok()) candidates[i].score = *score;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n_threads; ++i) threads.emplace_back(score_candidates);
+  score_candidates();
+  for (std::thread &thread : threads) thread.join();
+}
+
+}  // namespace
+
+absl::StatusOr<StrokeCorpus> ParseStrokeCorpus(absl::string_view csv) {
+  StrokeCorpus corpus;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(csv, '\n')) {
+    ++line_number;
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') continue;
+
+    absl::StatusOr<Input> input = ParseInput(line);
+    if (!input.ok()) {
+      return absl::InvalidArgumentError(absl::Substitute(
+          "Line $0: $1", line_number, input.status().message()));
+    }
+    if (input->event_type == Input::EventType::kDown) {
+      corpus.emplace_back();
+    } else if (corpus.empty() ||
+               corpus.back().back().event_type == Input::EventType::kUp) {
+      return absl::InvalidArgumentError(absl::Substitute(
+          "Line $0: Stroke does not start with a down event", line_number));
+    }
+    corpus.back().push_back(*input);
+  }
+  return corpus;
+}
+
+bool Dominates(const StrokeModelScore &a, const StrokeModelScore &b) {
+  bool no_worse = a.rms_jerk <= b.rms_jerk && a.mean_lag <= b.mean_lag &&
+                  a.mean_prediction_error <= b.mean_prediction_error;
+  bool better = a.rms_jerk < b.rms_jerk || a.mean_lag < b.mean_lag ||
+                a.mean_prediction_error < b.mean_prediction_error;
+  return no_worse && better;
+}
+
+absl::StatusOr<StrokeModelScore> ScoreStrokeModelParams(
+    const StrokeModelParams &params, const StrokeCorpus &corpus) {
+  absl::StatusOr<std::shared_ptr<const CompiledStrokeModelParams>>
+      compiled_params = CompiledStrokeModelParams::Create(params);
+  if (!compiled_params.ok()) return compiled_params.status();
+
+  StrokeModeler modeler;
+  ScoreAccumulator accumulator;
+  std::vector<Result> results;
+  std::vector<Result> prediction;
+  std::vector<Result> predictions;
+  for (const std::vector<Input> &stroke : corpus) {
+    modeler.Reset(*compiled_params);
+    results.clear();
+    predictions.clear();
+    for (const Input &input : stroke) {
+      if (absl::Status status = modeler.Update(input, results); !status.ok()) {
+        return status;
+      }
+      // Prediction fails if it's disabled, or once the stroke has ended.
+      if (modeler.Predict(prediction).ok()) {
+        predictions.insert(predictions.end(), prediction.begin(),
+                           prediction.end());
+      }
+    }
+    accumulator.AddStroke(stroke, results, predictions);
+  }
+  return accumulator.Score();
+}
+
+absl::StatusOr<std::vector<TunedStrokeModelParams>> TuneStrokeModelParams(
+    const StrokeModelParams &base_params, const StrokeCorpus &corpus,
+    const StrokeModelTunerOptions &options) {
+  if (absl::Status status = ValidateGreaterThanZero(
+          options.n_rounds, "StrokeModelTunerOptions::n_rounds");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = ValidateGreaterThanZero(
+          options.candidates_per_round,
+          "StrokeModelTunerOptions::candidates_per_round");
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status =
+          ValidateIsFiniteNumber(options.max_scale_factor,
+                                 "StrokeModelTunerOptions::max_scale_factor");
+      !status.ok()) {
+    return status;
+  }
+  if (options.max_scale_factor < 1) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "StrokeModelTunerOptions::max_scale_factor must be at least 1. Actual "
+        "value: $0",
+        options.max_scale_factor));
+  }
+  if (absl::Status status = ValidateGreaterThanOrEqualToZero(
+          options.n_threads, "StrokeModelTunerOptions::n_threads");
+      !status.ok()) {
+    return status;
+  }
+  if (corpus.empty()) {
+    return absl::InvalidArgumentError("The corpus is empty");
+  }
+
+  absl::StatusOr<StrokeModelScore> base_score =
+      ScoreStrokeModelParams(base_params, corpus);
+  if (!base_score.ok()) return base_score.status();
+
+  // The base parameters are at the origin of the search space.
+  const std::vector<ScaleParamFn> tuned_params = TunedParams(base_params);
+  std::vector<Candidate> candidates = {
+      {.coordinates = std::vector<double>(tuned_params.size(), 0),
+       .params = base_params,
+       .score = *base_score}};
+
+  const int n_threads =
+      options.n_threads > 0
+          ? options.n_threads
+          : std::max<int>(1, std::thread::hardware_concurrency());
+  std::mt19937 rng(options.seed);
+  std::uniform_real_distribution<double> uniform(-1, 1);
+  std::vector<int> front = {0};
+  for (int round = 0; round < options.n_rounds; ++round) {
+    // The first round samples the whole search space. Each subsequent round
+    // perturbs the candidates on the front, with a step size that halves each
+    // round.
+    std::normal_distribution<double> perturbation(0, std::pow(.5, round));
+    std::uniform_int_distribution<int> front_index(0, front.size() - 1);
+    const size_t begin = candidates.size();
+    for (int i = 0; i < options.candidates_per_round; ++i) {
+      std::vector<double> coordinates(tuned_params.size());
+      const Candidate &parent = candidates[front[front_index(rng)]];
+      for (size_t j = 0; j < coordinates.size(); ++j) {
+        coordinates[j] =
+            round == 0 ? uniform(rng)
+                       : std::clamp(parent.coordinates[j] + perturbation(rng),
+                                    -1., 1.);
+      }
+      StrokeModelParams params = base_params;
+      for (size_t j = 0; j < coordinates.size(); ++j) {
+        tuned_params[j](params,
+                        std::pow(options.max_scale_factor, coordinates[j]));
+      }
+      candidates.push_back({.coordinates = std::move(coordinates),
+                            .params = params,
+                            .score = std::nullopt});
+    }
+    ScoreCandidates(corpus, n_threads, begin, candidates);
+    front = ParetoFront(candidates);
+  }
+
+  std::vector<TunedStrokeModelParams> tuned;
+  tuned.reserve(front.size());
+  for (int i : front) {
+    tuned.push_back(
+        {.params = candidates[i].params, .score = *candidates[i].score});
+  }
+  std::sort(tuned.begin(), tuned.end(),
+            [](const TunedStrokeModelParams &lhs,
+               const TunedStrokeModelParams &rhs) {
+              return lhs.score.mean_lag < rhs.score.mean_lag;
+            });
+  return tuned;
+}
+
+std::string ToFormattedString(const TunedStrokeModelParams &tuned) {
+  const StrokeModelParams &params = tuned.params;
+  std::string str = absl::StrFormat(
+      "rms_jerk=%g mean_lag=%g mean_prediction_error=%g\n",
+      tuned.score.rms_jerk, tuned.score.mean_lag,
+      tuned.score.mean_prediction_error);
+  if (params.wobble_smoother_params.is_enabled) {
+    absl::StrAppendFormat(
+        &str,
+        "  wobble_smoother_params: timeout=%g speed_floor=%g "
+        "speed_ceiling=%g\n",
+        params.wobble_smoother_params.timeout.Value(),
+        params.wobble_smoother_params.speed_floor,
+        params.wobble_smoother_params.speed_ceiling);
+  }
+  absl::StrAppendFormat(
+      &str, "  position_modeler_params: spring_mass_constant=%g "
+            "drag_constant=%g\n",
+      params.position_modeler_params.spring_mass_constant,
+      params.position_modeler_params.drag_constant);
+  if (const auto *kalman_params =
+          std::get_if<KalmanPredictorParams>(&params.prediction_params)) {
+    absl::StrAppendFormat(
+        &str,
+        "  kalman_predictor_params: process_noise=%g measurement_noise=%g "
+        "prediction_interval=%g\n",
+        kalman_params->process_noise, kalman_params->measurement_noise,
+        kalman_params->prediction_interval.Value());
+  }
+  return str;
+}
+
+}  // namespace stroke_model
+}  // namespace ink
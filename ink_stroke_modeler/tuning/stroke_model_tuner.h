@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INK_STROKE_MODELER_TUNING_STROKE_MODEL_TUNER_H_
+#define INK_STROKE_MODELER_TUNING_STROKE_MODEL_TUNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+
+// A corpus of recorded strokes, each of which is the sequence of Inputs from a
+// down event to an up event.
+using StrokeCorpus = std::vector<std::vector<Input>>;
+
+// Parses a stroke corpus from CSV, with one Input per line, in the form:
+//   event_type,x,y,time[,pressure,tilt,orientation]
+// where event_type is one of "down", "move", or "up". Blank lines, and lines
+// starting with '#', are ignored. Each down event starts a new stroke. Returns
+// an error if a line is malformed, or if a stroke doesn't start with a down
+// event.
+absl::StatusOr<StrokeCorpus> ParseStrokeCorpus(absl::string_view csv);
+
+// How well a set of parameters models a corpus. Lower is better for each of
+// the metrics, and they trade off against each other: e.g. stronger smoothing
+// reduces jerk, but increases lag.
+struct StrokeModelScore {
+  // The root-mean-square magnitude of the jerk (the rate of change of the
+  // acceleration) of the modeled Results, as a measure of how smooth they are.
+  double rms_jerk = 0;
+
+  // The mean distance between each raw input position and the modeled
+  // position at the same time, i.e. how far the model lags behind the pen.
+  double mean_lag = 0;
+
+  // The mean distance between each predicted position and the modeled
+  // position at the same time, once the inputs covering that time had been
+  // modeled. This is zero if prediction is disabled.
+  double mean_prediction_error = 0;
+};
+
+// Returns true if `a` is at least as good as `b` in every metric, and strictly
+// better in at least one.
+bool Dominates(const StrokeModelScore& a, const StrokeModelScore& b);
+
+// Models each stroke in the corpus with the given parameters, and returns the
+// score. Returns an error if the parameters are invalid, or if the modeler
+// rejects any of the inputs.
+absl::StatusOr<StrokeModelScore> ScoreStrokeModelParams(
+    const StrokeModelParams& params, const StrokeCorpus& corpus);
+
+struct StrokeModelTunerOptions {
+  // The search runs for this many rounds, each of which evaluates this many
+  // candidates. The first round samples the whole search space; each
+  // following round samples closer to the best candidates found so far.
+  int n_rounds = 4;
+  int candidates_per_round = 64;
+
+  // Each tuned parameter is searched over
+  // [base / max_scale_factor, base * max_scale_factor], on a log scale, where
+  // `base` is its value in the base parameters. Must be at least 1.
+  double max_scale_factor = 4;
+
+  // The number of threads used to evaluate candidates. If zero, one thread is
+  // used per hardware thread.
+  int n_threads = 0;
+
+  // The seed for the candidate sampler. The search is deterministic for a
+  // given seed, regardless of the number of threads.
+  uint32_t seed = 1;
+};
+
+struct TunedStrokeModelParams {
+  StrokeModelParams params;
+  StrokeModelScore score;
+};
+
+// Searches for parameters that model the corpus well, starting from
+// `base_params`, and returns the Pareto front of the candidates evaluated
+// (including the base parameters), i.e. those that aren't dominated by any
+// other candidate, sorted by increasing lag.
+//
+// The tuned parameters are the WobbleSmootherParams timeout and speed range
+// (if wobble smoothing is enabled), the PositionModelerParams spring mass and
+// drag constants, and, if `base_params` uses the Kalman predictor, its process
+// noise, measurement noise, and prediction interval. The other parameters are
+// left as they are.
+//
+// Returns an error if `base_params` or `options` are invalid, if the corpus is
+// empty, or if the base parameters can't model the corpus.
+absl::StatusOr<std::vector<TunedStrokeModelParams>> TuneStrokeModelParams(
+    const StrokeModelParams& base_params, const StrokeCorpus& corpus,
+    const StrokeModelTunerOptions& options);
+
+// Returns a human-readable description of the tuned parameters and their
+// score.
+std::string ToFormattedString(const TunedStrokeModelParams& tuned);
+
+}  // namespace stroke_model
+}  // namespace ink
+
+#endif  // INK_STROKE_MODELER_TUNING_STROKE_MODEL_TUNER_H_
@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline tool that tunes StrokeModelParams for a recorded stroke corpus, and
+// prints the Pareto-best parameter sets found.
+//
+// Usage:
+//   stroke_model_tuner <corpus.csv> [n_rounds] [candidates_per_round]
+//
+// See ParseStrokeCorpus() for the corpus format. The search starts from the
+// parameters recommended in the README, with the Kalman predictor.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/tuning/stroke_model_tuner.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace {
+
+using ::ink::stroke_model::ParseStrokeCorpus;
+using ::ink::stroke_model::RecommendedStrokeModelParams;
+using ::ink::stroke_model::StrokeCorpus;
+using ::ink::stroke_model::StrokeModelParams;
+using ::ink::stroke_model::StrokeModelTunerOptions;
+using ::ink::stroke_model::TunedStrokeModelParams;
+using ::ink::stroke_model::TuneStrokeModelParams;
+
+const StrokeModelParams kBaseParams = RecommendedStrokeModelParams();
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 4) {
+    std::cerr << "Usage: " << argv[0]
+              << " <corpus.csv> [n_rounds] [candidates_per_round]\n";
+    return 1;
+  }
+
+  StrokeModelTunerOptions options;
+  if ((argc > 2 && !absl::SimpleAtoi(argv[2], &options.n_rounds)) ||
+      (argc > 3 && !absl::SimpleAtoi(argv[3], &options.candidates_per_round))) {
+    std::cerr << "n_rounds and candidates_per_round must be integers\n";
+    return 1;
+  }
+
+  std::ifstream file(argv[1]);
+  if (!file) {
+    std::cerr << "Could not open " << argv[1] << "\n";
+    return 1;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  absl::StatusOr<StrokeCorpus> corpus = ParseStrokeCorpus(contents.str());
+  if (!corpus.ok()) {
+    std::cerr << corpus.status() << "\n";
+    return 1;
+  }
+
+  absl::StatusOr<std::vector<TunedStrokeModelParams>> tuned =
+      TuneStrokeModelParams(kBaseParams, *corpus, options);
+  if (!tuned.ok()) {
+    std::cerr << tuned.status() << "\n";
+    return 1;
+  }
+  std::cout << tuned->size() << " Pareto-best parameter sets for "
+            << corpus->size() << " strokes:\n";
+  for (const TunedStrokeModelParams &params : *tuned) {
+    std::cout << ToFormattedString(params);
+  }
+  return 0;
+}
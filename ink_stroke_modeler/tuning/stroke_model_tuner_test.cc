@@ -0,0 +1,203 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink_stroke_modeler/tuning/stroke_model_tuner.h"
+
+#include <cmath>
+#include <variant>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink_stroke_modeler/internal/synthetic_strokes.h"
+#include "ink_stroke_modeler/params.h"
+#include "ink_stroke_modeler/types.h"
+
+namespace ink {
+namespace stroke_model {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+const StrokeModelParams kBaseParams = RecommendedStrokeModelParams();
+
+// A few wavy strokes, with inputs at 120Hz.
+StrokeCorpus MakeCorpus() {
+  StrokeCorpus corpus;
+  for (int stroke = 0; stroke < 3; ++stroke) {
+    std::vector<Input> inputs;
+    constexpr int kNumInputs = 40;
+    for (int i = 0; i < kNumInputs; ++i) {
+      float t = i / 120.f;
+      inputs.push_back(
+          {.event_type = i == 0                ? Input::EventType::kDown
+                         : i == kNumInputs - 1 ? Input::EventType::kUp
+                                               : Input::EventType::kMove,
+           .position = {10 * t + stroke,
+                        std::sin((10.f + stroke) * t) + .01f * (i % 2)},
+           .time = Time(t)});
+    }
+    corpus.push_back(inputs);
+  }
+  return corpus;
+}
+
+TEST(StrokeModelTunerTest, ParseStrokeCorpus) {
+  absl::StatusOr<StrokeCorpus> corpus = ParseStrokeCorpus(R"(
+# A comment.
+down, 1, 2, 0
+move, 2, 3, .01, .5, .25, 1
+up, 3, 4, .02
+
+down, 5, 6, 1
+up, 7, 8, 1.5
+)");
+  ASSERT_TRUE(corpus.ok()) << corpus.status();
+  ASSERT_THAT(*corpus, ElementsAre(SizeIs(3), SizeIs(2)));
+  EXPECT_EQ((*corpus)[0][1], (Input{.event_type = Input::EventType::kMove,
+                                    .position = {2, 3},
+                                    .time = Time(.01),
+                                    .pressure = .5,
+                                    .tilt = .25,
+                                    .orientation = 1}));
+  EXPECT_EQ((*corpus)[1][1], (Input{.event_type = Input::EventType::kUp,
+                                    .position = {7, 8},
+                                    .time = Time(1.5)}));
+}
+
+TEST(StrokeModelTunerTest, ParseStrokeCorpusErrors) {
+  EXPECT_THAT(ParseStrokeCorpus("move, 1, 2, 0").status().message(),
+              HasSubstr("does not start with a down event"));
+  EXPECT_THAT(ParseStrokeCorpus("down, 1, 2, 0\nup, 1, 2, 1\nmove, 1, 2, 2")
+                  .status()
+                  .message(),
+              HasSubstr("Line 3"));
+  EXPECT_EQ(ParseStrokeCorpus("hover, 1, 2, 0").status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ParseStrokeCorpus("down, 1, 2").status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ParseStrokeCorpus("down, 1, x, 0").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(StrokeModelTunerTest, Dominates) {
+  StrokeModelScore score{
+      .rms_jerk = 1, .mean_lag = 1, .mean_prediction_error = 1};
+  EXPECT_FALSE(Dominates(score, score));
+  EXPECT_TRUE(Dominates(
+      {.rms_jerk = 1, .mean_lag = .5, .mean_prediction_error = 1}, score));
+  EXPECT_FALSE(Dominates(
+      {.rms_jerk = 2, .mean_lag = .5, .mean_prediction_error = 1}, score));
+}
+
+TEST(StrokeModelTunerTest, ScoreTradesSmoothnessForLag) {
+  const StrokeCorpus corpus = MakeCorpus();
+  absl::StatusOr<StrokeModelScore> base_score =
+      ScoreStrokeModelParams(kBaseParams, corpus);
+  ASSERT_TRUE(base_score.ok()) << base_score.status();
+  EXPECT_GT(base_score->rms_jerk, 0);
+  EXPECT_GT(base_score->mean_lag, 0);
+  EXPECT_GT(base_score->mean_prediction_error, 0);
+
+  // A heavier pen tip is smoother, but lags further behind.
+  StrokeModelParams heavy_params = kBaseParams;
+  heavy_params.position_modeler_params.spring_mass_constant *= 4;
+  absl::StatusOr<StrokeModelScore> heavy_score =
+      ScoreStrokeModelParams(heavy_params, corpus);
+  ASSERT_TRUE(heavy_score.ok()) << heavy_score.status();
+  EXPECT_LT(heavy_score->rms_jerk, base_score->rms_jerk);
+  EXPECT_GT(heavy_score->mean_lag, base_score->mean_lag);
+
+  StrokeModelParams no_prediction_params = kBaseParams;
+  no_prediction_params.prediction_params = DisabledPredictorParams();
+  absl::StatusOr<StrokeModelScore> no_prediction_score =
+      ScoreStrokeModelParams(no_prediction_params, corpus);
+  ASSERT_TRUE(no_prediction_score.ok()) << no_prediction_score.status();
+  EXPECT_EQ(no_prediction_score->mean_prediction_error, 0);
+
+  EXPECT_EQ(ScoreStrokeModelParams(StrokeModelParams(), corpus).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(StrokeModelTunerTest, TuneReturnsParetoFront) {
+  const StrokeCorpus corpus = MakeCorpus();
+  StrokeModelTunerOptions options{
+      .n_rounds = 2, .candidates_per_round = 12, .n_threads = 3, .seed = 7};
+  absl::StatusOr<std::vector<TunedStrokeModelParams>> tuned =
+      TuneStrokeModelParams(kBaseParams, corpus, options);
+  ASSERT_TRUE(tuned.ok()) << tuned.status();
+  ASSERT_THAT(*tuned, Not(IsEmpty()));
+
+  for (size_t i = 0; i < tuned->size(); ++i) {
+    // The scores are as reported, and none dominates another.
+    absl::StatusOr<StrokeModelScore> score =
+        ScoreStrokeModelParams((*tuned)[i].params, corpus);
+    ASSERT_TRUE(score.ok());
+    EXPECT_EQ(score->mean_lag, (*tuned)[i].score.mean_lag);
+    for (const TunedStrokeModelParams &other : *tuned) {
+      EXPECT_FALSE(Dominates(other.score, (*tuned)[i].score));
+    }
+    if (i > 0) {
+      EXPECT_LE((*tuned)[i - 1].score.mean_lag, (*tuned)[i].score.mean_lag);
+    }
+    // Untuned parameters are left as they are.
+    EXPECT_EQ((*tuned)[i].params.sampling_params.min_output_rate,
+              kBaseParams.sampling_params.min_output_rate);
+    EXPECT_TRUE(std::holds_alternative<KalmanPredictorParams>(
+        (*tuned)[i].params.prediction_params));
+  }
+
+  // The search is deterministic, regardless of the number of threads.
+  options.n_threads = 1;
+  absl::StatusOr<std::vector<TunedStrokeModelParams>> single_threaded =
+      TuneStrokeModelParams(kBaseParams, corpus, options);
+  ASSERT_TRUE(single_threaded.ok());
+  ASSERT_THAT(*single_threaded, SizeIs(tuned->size()));
+  for (size_t i = 0; i < tuned->size(); ++i) {
+    EXPECT_EQ((*single_threaded)[i].score.mean_lag,
+              (*tuned)[i].score.mean_lag);
+  }
+
+  EXPECT_THAT(ToFormattedString(tuned->front()),
+              HasSubstr("kalman_predictor_params"));
+}
+
+TEST(StrokeModelTunerTest, TuneRejectsInvalidArguments) {
+  const StrokeCorpus corpus = MakeCorpus();
+  EXPECT_EQ(TuneStrokeModelParams(kBaseParams, corpus, {.n_rounds = 0})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(
+      TuneStrokeModelParams(kBaseParams, corpus, {.max_scale_factor = .5})
+          .status()
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(TuneStrokeModelParams(kBaseParams, {}, {}).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(TuneStrokeModelParams(StrokeModelParams(), corpus, {})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace stroke_model
+}  // namespace ink
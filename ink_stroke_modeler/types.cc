@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <string>
 
 #include "absl/status/status.h"
@@ -60,6 +61,34 @@ absl::Status ValidateInput(const Input &input) {
   return absl::OkStatus();
 }
 
+Input DigitizerTransform::ToInput(const DigitizerSample &sample) const {
+  // The products are taken in double, as float can't represent every int32.
+  double x =
+      position_offset.x + static_cast<double>(position_scale.x) * sample.x;
+  double y =
+      position_offset.y + static_cast<double>(position_scale.y) * sample.y;
+  int64_t elapsed_ns = sample.timestamp_ns - timestamp_origin_ns;
+  return {.event_type = sample.event_type,
+          .position = {static_cast<float>(x), static_cast<float>(y)},
+          .time = time_offset + Duration(static_cast<double>(elapsed_ns) / 1e9),
+          .pressure = sample.pressure,
+          .tilt = sample.tilt,
+          .orientation = sample.orientation};
+}
+
+absl::Status ValidateDigitizerTransform(const DigitizerTransform &transform) {
+  RETURN_IF_ERROR(ValidateIsFiniteNumber(
+      transform.position_scale.x, "DigitizerTransform.position_scale.x"));
+  RETURN_IF_ERROR(ValidateIsFiniteNumber(
+      transform.position_scale.y, "DigitizerTransform.position_scale.y"));
+  RETURN_IF_ERROR(ValidateIsFiniteNumber(
+      transform.position_offset.x, "DigitizerTransform.position_offset.x"));
+  RETURN_IF_ERROR(ValidateIsFiniteNumber(
+      transform.position_offset.y, "DigitizerTransform.position_offset.y"));
+  return ValidateIsFiniteNumber(transform.time_offset.Value(),
+                                "DigitizerTransform.time_offset");
+}
+
 std::string ToFormattedString(Duration duration) {
   // Use StrCat instead of StrFormat to avoid trailing zeros in short decimals.
   return absl::StrCat(duration.Value());
@@ -18,6 +18,7 @@
 #define INK_STROKE_MODELER_TYPES_H_
 
 #include <cmath>
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -199,6 +200,42 @@ void AbslStringify(Sink &sink, const Input &input) {
 
 std::ostream &operator<<(std::ostream &s, const Input &input);
 
+// A raw sample from a digitizer, as delivered by its driver, with the position
+// in integer device units and the timestamp in integer nanoseconds. This is
+// converted to an Input by a DigitizerTransform.
+struct DigitizerSample {
+  Input::EventType event_type;
+  int32_t x = 0;
+  int32_t y = 0;
+
+  // As for the corresponding fields of Input.
+  float pressure = -1;
+  float tilt = -1;
+  float orientation = -1;
+
+  int64_t timestamp_ns = 0;
+};
+
+// Maps DigitizerSamples to Inputs. This is expected to stay the same for the
+// whole of a stroke, e.g. set at the down event.
+struct DigitizerTransform {
+  // The position of the Input is `position_offset + position_scale * (x, y)`,
+  // where the multiplication is component-wise.
+  Vec2 position_scale{1, 1};
+  Vec2 position_offset{0, 0};
+
+  // The time of the Input is `time_offset`, plus the time elapsed since
+  // `timestamp_origin_ns`. The elapsed time is taken in integer nanoseconds,
+  // so choosing an origin close to the samples, e.g. the timestamp of the
+  // down event, keeps full precision in the Input.
+  int64_t timestamp_origin_ns = 0;
+  Time time_offset{0};
+
+  Input ToInput(const DigitizerSample &sample) const;
+};
+
+absl::Status ValidateDigitizerTransform(const DigitizerTransform &transform);
+
 // A modeled input produced by the stroke modeler.
 struct Result {
   // The position/velocity/acceleration of the stroke tip.
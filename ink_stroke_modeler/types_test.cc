@@ -361,6 +361,52 @@ TEST(TypesTest, ValidateInputOnNonFiniteTimeIsError) {
             absl::StatusCode::kInvalidArgument);
 }
 
+TEST(TypesTest, DigitizerTransformToInput) {
+  DigitizerTransform transform{.position_scale = {.5, -.25},
+                               .position_offset = {10, 20},
+                               .timestamp_origin_ns = 1'700'000'000'000'000'000,
+                               .time_offset = Time(3)};
+  EXPECT_EQ(transform.ToInput({.event_type = Input::EventType::kMove,
+                               .x = 4,
+                               .y = -8,
+                               .pressure = .2,
+                               .tilt = .3,
+                               .orientation = .4,
+                               .timestamp_ns = 1'700'000'000'250'000'000}),
+            (Input{.event_type = Input::EventType::kMove,
+                   .position = {12, 22},
+                   .time = Time(3.25),
+                   .pressure = .2,
+                   .tilt = .3,
+                   .orientation = .4}));
+}
+
+TEST(TypesTest, DigitizerTransformToInputKeepsLargeCoordinates) {
+  // 2^24 + 1 can't be represented by a float, so scaling it in float would
+  // round it before the offset is applied.
+  DigitizerTransform transform{.position_scale = {1, 1},
+                               .position_offset = {-16'777'216, 0}};
+  EXPECT_EQ(transform.ToInput({.x = 16'777'217}).position, (Vec2{1, 0}));
+}
+
+TEST(TypesTest, ValidateDigitizerTransform) {
+  EXPECT_EQ(ValidateDigitizerTransform(DigitizerTransform()).code(),
+            absl::StatusCode::kOk);
+  EXPECT_EQ(ValidateDigitizerTransform(
+                {.position_scale = {std::numeric_limits<float>::infinity(), 1}})
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(
+      ValidateDigitizerTransform(
+          {.position_offset = {0, std::numeric_limits<float>::quiet_NaN()}})
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ValidateDigitizerTransform(
+                {.time_offset = Time(std::numeric_limits<double>::infinity())})
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST(TypesTest, InputEventTypeStream) {
   std::stringstream s;
   s << Input::EventType::kUp;